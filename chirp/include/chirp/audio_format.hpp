@@ -22,6 +22,8 @@ namespace chirp
 			using bit_count = chirp::sample_format::bit_count;
 			using byte_count = chirp::sample_format::byte_count;
 			using channel_count = chirp::sample_format::channel_count;
+			/// Integral type for 64 bit frame counts and positions
+			using frame_index = std::uint64_t;
 
 			///
 			audio_format( frequency_type frequency, sample_format const& format ) :
@@ -47,6 +49,16 @@ namespace chirp
 				return _sample_format.bits_per_sample();
 			}
 
+			/// @returns The numeric type of the samples
+			sample_type type() const {
+				return _sample_format.type();
+			}
+
+			/// @returns The number of bytes of each sample, including padding
+			byte_count bytes_per_sample() const {
+				return _sample_format.bytes_per_sample();
+			}
+
 			///
 			channel_count channels() const {
 				return _sample_format.channels();
@@ -72,6 +84,24 @@ namespace chirp
 				return _duration_per_frame;
 			}
 
+			/// Convert a number of frames to the exact time they take to
+			/// play, without overflowing for any realistic stream uptime
+			/// @param frames   The number of frames
+			/// @returns The duration, rounded down to whole nanoseconds
+			std::chrono::nanoseconds duration_of( frame_index frames ) const {
+				return std::chrono::nanoseconds(
+					static_cast<std::chrono::nanoseconds::rep>( (frames / _frequency) * std::nano::den +
+					                                            ((frames % _frequency) * std::nano::den) / _frequency ) );
+			}
+
+			/// Convert a duration to the number of frames that play within it
+			/// @param duration   The duration, which must not be negative
+			/// @returns The number of whole frames
+			frame_index frames_in( std::chrono::nanoseconds duration ) const {
+				auto count = static_cast<frame_index>( duration.count() );
+				return (count / std::nano::den) * _frequency + ((count % std::nano::den) * _frequency) / std::nano::den;
+			}
+
 			///
 			bool operator==( audio_format const& other ) const {
 				return _frequency == other._frequency &&
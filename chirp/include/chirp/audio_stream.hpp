@@ -2,7 +2,21 @@
 #define IG_CHIRP_AUDIO_STREAM_HPP
 
 #include <chirp/backend.hpp>
+#include <chirp/callback_statistics.hpp>
+#include <chirp/planar_request.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_queue.hpp>
 #include <chirp/sample_request.hpp>
+#include <chirp/stream_options.hpp>
+#include <chirp/stream_statistics.hpp>
+#include <chirp/stream_timeline.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 
 namespace chirp
 {
@@ -20,14 +34,98 @@ namespace chirp
 			/// @param ptr   Pointer to audio implementation
 			audio_stream( audio_format const& format, std::shared_ptr<backend::audio_stream> const& ptr ) :
 				_format( format ),
+				_push( std::make_shared<push_mode>() ),
 				_ptr( ptr )
 			{}
 
+			/// Start playing the audio stream, with a function object as
+			/// sample provider. The function object is stored in a
+			/// `std::function`, which may allocate memory.
 			///
-			///
-			template <class F>
+			/// Function objects that take a `planar_request` instead of a
+			/// `sample_request` fill float32 channel buffers, which chirp
+			/// converts and interleaves into the format of the stream. A
+			/// stream in push mode is stopped first.
+			/// @param func   The function object, which is called with the
+			///               play time and a `sample_request` or a
+			///               `planar_request`.
+			template <class F, class = typename std::enable_if<!std::is_base_of<sample_provider, typename std::decay<F>::type>::value>::type>
 			void play_async( F func ) {
-				_ptr->play_async( func );
+				play_function( std::move(func), is_planar_provider<F>{} );
+			}
+
+			/// Start playing the audio stream without allocating any memory.
+			/// The stream only keeps a reference to the sample provider.
+			/// A stream in push mode is stopped first.
+			/// @param provider   The sample provider, which must be kept
+			///                   alive until the stream has been stopped.
+			void play_async( sample_provider& provider ) {
+				leave_push_mode();
+				_ptr->play_async( provider );
+			}
+
+			/// Start playing the audio stream in push mode, where samples
+			/// are queued with `write()` or `try_write()` by a thread that
+			/// produces them at its own pace. Samples that aren't written
+			/// in time are played as silence. A stream that is already
+			/// playing is stopped first.
+			/// @param capacity_frames     The size of the queue, in frames
+			/// @param high_water_frames   The number of queued frames above
+			///                            which writes block or are cut
+			///                            short, or zero for the capacity.
+			/// @throws push_mode_exception if the capacity is zero, or the
+			///                             high-water mark exceeds it
+			void play_push_async( std::size_t capacity_frames, std::size_t high_water_frames = 0 ) {
+				auto queue = std::make_shared<sample_queue>( _format, capacity_frames, high_water_frames );
+				// The previous queue is kept until the stream has stopped
+				// reading from it
+				auto previous = leave_push_mode();
+				_ptr->play_async( *queue );
+				std::unique_lock<std::mutex> lock{_push->mutex};
+				_push->queue = std::move(queue);
+			}
+
+			/// Queue samples for a stream in push mode, waiting for room
+			/// below the high-water mark as needed. The write returns
+			/// early if the stream is stopped, leaves push mode or ends by
+			/// itself. Only one thread may write to a stream at a time.
+			/// @param ptr      Pointer to interleaved frames of the format
+			///                 of the stream
+			/// @param frames   The number of frames to queue
+			/// @returns The number of frames that were queued
+			/// @throws push_mode_exception if the stream isn't in push mode
+			std::size_t write( void const* ptr, std::size_t frames ) {
+				auto queue = this->queue();
+				auto const* source = static_cast<std::uint8_t const*>( ptr );
+				std::size_t written = 0;
+				while( true ) {
+					// The queue is closed when the stream leaves push mode,
+					// but a stream that ends by itself, such as a file
+					// render, doesn't know about the queue
+					written += queue->write( source + written * _format.bytes_per_frame(), frames - written, std::chrono::milliseconds{50} );
+					if( written == frames || queue->closed() || !is_playing() ) {
+						return written;
+					}
+				}
+			}
+
+			/// Queue as many samples as fit below the high-water mark for
+			/// a stream in push mode, without waiting. Only one thread may
+			/// write to a stream at a time.
+			/// @param ptr      Pointer to interleaved frames of the format
+			///                 of the stream
+			/// @param frames   The number of frames to queue
+			/// @returns The number of frames that were queued
+			/// @throws push_mode_exception if the stream isn't in push mode
+			std::size_t try_write( void const* ptr, std::size_t frames ) {
+				return queue()->try_write( ptr, frames );
+			}
+
+			/// @returns The number of frames that are queued for a stream in
+			///          push mode
+			/// @throws push_mode_exception if the stream isn't in push mode
+			std::size_t queued_frames() const {
+				return queue()->queued_frames();
 			}
 
 			/// Examin wether the audio stream is being played.
@@ -38,8 +136,13 @@ namespace chirp
 				return _ptr && _ptr->state() == backend::audio_stream_state::playing;
 			}
 
-			/// Stop audio playback
+			/// Stop audio playback. A stream in push mode leaves push mode,
+			/// and writes that wait for room return.
 			void stop() {
+				auto queue = take_queue();
+				if( queue ) {
+					queue->close();
+				}
 				_ptr->stop();
 			}
 
@@ -48,9 +151,145 @@ namespace chirp
 				return _format;
 			}
 
+			/// @returns The buffer configuration that the stream actually
+			///          uses, including the latency it achieves.
+			stream_configuration configuration() const {
+				return _ptr->configuration();
+			}
+
+			/// Retrieve the underrun counters of the stream. This is cheap
+			/// and can be called from any thread, including from within the
+			/// sample provider.
+			/// @returns The counters since the stream was created
+			stream_statistics statistics() const {
+				return _ptr->statistics();
+			}
+
+			/// Set a function to be called on the play thread each time the
+			/// device runs out of samples.
+			/// @param f   The handler, or an empty function to remove it
+			/// @throws stream_is_playing_exception if the stream is playing
+			void on_underrun( underrun_handler_func f ) {
+				if( is_playing() ) {
+					throw stream_is_playing_exception{};
+				}
+				_ptr->set_underrun_handler( std::move(f) );
+			}
+
+			/// Retrieve the timing of the sample provider, measured against
+			/// the real-time budget of each sample request. This is cheap
+			/// and can be called from any thread.
+			/// @returns The timing since the stream was created
+			callback_statistics callback_timing() const {
+				return _ptr->callback_timing();
+			}
+
+			/// Set a function to be called on the play thread each time the
+			/// sample provider uses more than a fraction of the budget of
+			/// a sample request.
+			/// @param fraction   The fraction of the budget, where 1.0 is
+			///                   the entire budget.
+			/// @param f          The handler, or an empty function to
+			///                   remove it
+			/// @throws stream_is_playing_exception if the stream is playing
+			void on_budget_exceeded( float fraction, budget_handler_func f ) {
+				if( is_playing() ) {
+					throw stream_is_playing_exception{};
+				}
+				_ptr->set_budget_handler( fraction, std::move(f) );
+			}
+
+			/// @returns The exact number of frames that have been rendered
+			///          since the stream was started. May be called from
+			///          any thread.
+			audio_format::frame_index frame_position() const {
+				return _ptr->timeline().position();
+			}
+
+			/// Retrieve the frame timeline of the stream, for starting and
+			/// stopping the sample provider and firing events at exact
+			/// frames. The timeline starts over each time the stream is
+			/// started, and keeps what has been scheduled on it.
+			/// @returns The timeline, which may be used from any thread
+			stream_timeline& timeline() const {
+				return _ptr->timeline();
+			}
+
+			/// Retrieve the output latency of the stream: the time it takes
+			/// for a frame that the sample provider renders now to reach
+			/// the device, which is how much is queued ahead of the read
+			/// cursor of the device. Latency inside the device itself, such
+			/// as in its converters, isn't included. Each sample request
+			/// also carries the time at which its first frame is played,
+			/// see `sample_request::presentation_time()`.
+			/// @returns The latency as of the last time the stream was
+			///          serviced, or zero if the stream doesn't play in
+			///          real time. May be called from any thread.
+			std::chrono::nanoseconds latency() const {
+				return _ptr->latency();
+			}
+
 		private:
+			/// Start playing with a function object that fills sample requests
+			template <class F>
+			void play_function( F func, std::false_type ) {
+				leave_push_mode();
+				_ptr->play_async( backend::audio_stream::sample_provider_func{ std::move(func) } );
+			}
+
+			/// Start playing with a function object that fills planar requests
+			template <class F>
+			void play_function( F func, std::true_type ) {
+				leave_push_mode();
+				_ptr->play_async( planar_provider_func{ std::move(func) } );
+			}
+
+			/// The queue of a stream in push mode, which is shared by the
+			/// copies of a stream. Only user threads take the mutex.
+			struct push_mode
+			{
+				/// Mutex for the queue
+				std::mutex mutex;
+				/// The queue, or null if the stream isn't in push mode
+				std::shared_ptr<sample_queue> queue;
+			};
+
+			/// @returns The queue of a stream in push mode, which a writer
+			///          keeps alive while it waits for room
+			std::shared_ptr<sample_queue> queue() const {
+				std::unique_lock<std::mutex> lock{_push->mutex};
+				if( !_push->queue ) {
+					throw push_mode_exception{};
+				}
+				return _push->queue;
+			}
+
+			/// Take the queue away from a stream in push mode
+			/// @returns The queue, or null if the stream isn't in push mode
+			std::shared_ptr<sample_queue> take_queue() {
+				std::unique_lock<std::mutex> lock{_push->mutex};
+				return std::move(_push->queue);
+			}
+
+			/// Stop a stream that plays in push mode, and close its queue
+			/// @returns The queue, which the caller must keep alive until
+			///          the stream is played again, or null if the stream
+			///          wasn't in push mode
+			std::shared_ptr<sample_queue> leave_push_mode() {
+				auto queue = take_queue();
+				if( queue ) {
+					queue->close();
+					if( is_playing() ) {
+						_ptr->stop();
+					}
+				}
+				return queue;
+			}
+
 			/// The audio format
 			audio_format _format;
+			/// Queue for push mode, which outlives the implementation
+			std::shared_ptr<push_mode> _push;
 			/// Pointer to implementation
 			std::shared_ptr<backend::audio_stream> _ptr;
 	};
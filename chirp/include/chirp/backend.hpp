@@ -2,8 +2,15 @@
 #define IG_CHIRP_BACKEND_HPP
 
 #include <chirp/audio_format.hpp>
+#include <chirp/callback_statistics.hpp>
+#include <chirp/planar_request.hpp>
+#include <chirp/sample_provider.hpp>
 #include <chirp/sample_request.hpp>
+#include <chirp/stream_options.hpp>
+#include <chirp/stream_statistics.hpp>
+#include <chirp/stream_timeline.hpp>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <functional>
@@ -42,8 +49,50 @@ namespace chirp
 				///
 				virtual void play_async( sample_provider_func ) = 0;
 
-				///
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				/// @param provider   The sample provider, which must outlive
+				///                   the playback.
+				virtual void play_async( sample_provider& provider ) = 0;
+
+				/// Start playing the audio stream asyncronously, with a
+				/// function that fills planar float32 buffers, which are
+				/// converted to the format of the stream.
+				virtual void play_async( planar_provider_func f ) = 0;
+
+				/// Stop playback. Returns once the sample provider is no
+				/// longer called. When called from the provider, it returns
+				/// at once, and the provider isn't called after it returns.
 				virtual void stop() = 0;
+
+				/// @returns The buffer configuration that the stream uses
+				virtual stream_configuration configuration() const = 0;
+
+				/// @returns The underrun counters of the stream. May be
+				///          called from any thread.
+				virtual stream_statistics statistics() const = 0;
+
+				/// Set the function that is called when an underrun is
+				/// detected. Must not be called while the stream is playing.
+				virtual void set_underrun_handler( underrun_handler_func f ) = 0;
+
+				/// @returns The timing of the sample provider. May be called
+				///          from any thread.
+				virtual callback_statistics callback_timing() const = 0;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of the budget of a request.
+				/// Must not be called while the stream is playing.
+				virtual void set_budget_handler( float fraction, budget_handler_func f ) = 0;
+
+				/// @returns The frame timeline of the stream, which may be
+				///          used from any thread.
+				virtual stream_timeline& timeline() = 0;
+
+				/// @returns The time it takes for a frame that is rendered
+				///          now to reach the device. May be called from any
+				///          thread.
+				virtual std::chrono::nanoseconds latency() const = 0;
 		};
 
 		/// Interface for output devices
@@ -62,10 +111,24 @@ namespace chirp
 				///
 				virtual std::string name() const = 0;
 
-				///
-				///
-				///
-				virtual std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format ) = 0;
+				/// Create a new audio stream instance
+				/// @param format    The format of the audio stream
+				/// @param options   Requested buffer configuration, which
+				///                  the implementation adjusts to what the
+				///                  device supports.
+				virtual std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format, stream_options const& options ) = 0;
+
+				/// Create a new audio stream instance with the default options
+				/// @param format    The format of the audio stream
+				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format ) {
+					return create_audio_stream( format, stream_options{} );
+				}
+
+				/// Check if the device can play a format natively
+				/// @param format   The format of an audio stream
+				/// @returns `true` if an audio stream of the format can be
+				///          created
+				virtual bool supports( audio_format const& format ) const = 0;
 
 				///
 				virtual bool operator==(output_device const& other) const = 0;
@@ -4,7 +4,9 @@
 #include <chirp/chirp.hpp>
 #include <chirp/backend.hpp>
 
+#include <chrono>
 #include <memory>
+#include <string>
 
 namespace chirp
 {
@@ -21,6 +23,18 @@ namespace chirp
 
 				///
 				std::unique_ptr<platform> create_platform( backend_identity request ) const;
+
+				/// Create a file render platform, that renders audio streams
+				/// into wave files as fast as possible.
+				/// @param path     The path of the wave file to render to.
+				///                 Additional audio streams render to files
+				///                 with a sequence number appended to the name.
+				/// @param length   The amount of audio each stream renders
+				///                 before it stops by itself. A zero length
+				///                 renders until the stream is stopped.
+				/// @throws unknown_backend_exception if the file render
+				///         backend is not available.
+				std::unique_ptr<platform> create_file_render_platform( std::string const& path, std::chrono::nanoseconds length = std::chrono::nanoseconds::zero() ) const;
 		};
 
 
@@ -0,0 +1,72 @@
+#ifndef IG_CHIRP_CALLBACK_STATISTICS_HPP
+#define IG_CHIRP_CALLBACK_STATISTICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace chirp
+{
+	/// Number of bins in the histogram of callback durations
+	constexpr std::size_t callback_histogram_size = 16;
+
+	/// Timing of the sample provider of an audio stream, measured against
+	/// the real-time budget of each sample request.
+	///
+	/// The budget of a sample request is the time it takes the device to
+	/// play the requested samples, see `sample_request::duration()`. The
+	/// load of a callback is the time the sample provider took, divided
+	/// by the budget. Providers that use more than a fraction of their
+	/// budget leaves little room for the rest of the system, and will
+	/// eventually cause underruns.
+	struct callback_statistics
+	{
+		/// Integral type for the counters
+		using counter_type = std::uint64_t;
+
+		/// Number of times the sample provider has been called
+		counter_type callbacks;
+		/// Exponential moving average of the load of the callbacks, where
+		/// 1.0 means that the provider uses its entire budget.
+		float load;
+		/// Highest load of a single callback
+		float peak_load;
+		/// Number of callbacks that took longer than their budget
+		counter_type over_budget;
+		/// Histogram of callback durations. Bin 0 counts callbacks shorter
+		/// than 2 microseconds, and bin `i` counts callbacks lasting
+		/// between `2^i` and `2^(i+1)` microseconds. The last bin counts
+		/// all longer callbacks as well.
+		std::array<counter_type, callback_histogram_size> histogram;
+
+		/// @param bin   Index of a histogram bin
+		/// @returns The shortest callback duration counted by the bin
+		static std::chrono::microseconds histogram_bin_start( std::size_t bin ) {
+			return std::chrono::microseconds( bin == 0 ? 0 : (1 << bin) );
+		}
+	};
+
+	/// Event describing a callback that used more than the configured
+	/// fraction of its budget.
+	struct budget_event
+	{
+		/// The time the sample provider took
+		std::chrono::nanoseconds duration;
+		/// The real-time budget of the sample request
+		std::chrono::nanoseconds budget;
+
+		/// @returns The fraction of the budget that was used
+		float load() const {
+			return budget.count() > 0 ? static_cast<float>(duration.count()) / budget.count() : 0.0f;
+		}
+	};
+
+	/// Function type for handling budget events. The handler is called on
+	/// the play thread right after the sample provider has returned, and
+	/// should return quickly.
+	using budget_handler_func = std::function<void(budget_event const&)>;
+}   // namespace chirp
+
+#endif   // IG_CHIRP_CALLBACK_STATISTICS_HPP
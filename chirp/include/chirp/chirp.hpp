@@ -14,7 +14,16 @@ namespace chirp
 	enum class backend_identity {
 		/// Use the default implementation for the current platform
 		platform_default,
-		directsound
+		/// DirectSound implementation (windows only)
+		directsound,
+		/// ALSA implementation (linux only)
+		alsa,
+		/// Headless implementation that discards all audio, but requests
+		/// samples at the same pace as a real output device would
+		null,
+		/// Offline implementation that renders audio streams into wave
+		/// files, as fast as the sample providers can produce samples
+		file_render
 	};
 
 	/// Audio platform
@@ -18,6 +18,10 @@ namespace chirp
 	/// Exception type for error conditions related to byte ordering
 	struct byte_order_exception : exception {};
 
+	/// Exception type for sample formats that are invalid, or that a
+	/// device can't play
+	struct sample_format_exception : exception {};
+
 	/// Exception type for errors emitted from the backend implementation
 	struct backend_exception : exception {};
 
@@ -0,0 +1,78 @@
+#ifndef IG_CHIRP_MIXER_HPP
+#define IG_CHIRP_MIXER_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/audio_stream.hpp>
+#include <chirp/output_device.hpp>
+#include <chirp/sample_format.hpp>
+#include <chirp/stream_options.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace chirp
+{
+	namespace backend
+	{
+		class mixer_engine;
+	}   // namespace backend
+
+	/// Software mixer, which plays many audio streams through one stream
+	/// of an output device.
+	///
+	/// Each stream of the device has a device buffer of its own, and is
+	/// serviced on its own by the play thread. Streams that are created by
+	/// a mixer instead render blocks of float samples into a scratch
+	/// buffer that all of them share, and are added up with the vector
+	/// kernels of the CPU into the samples of a single device stream. The
+	/// mix is clipped to full scale, and the device stream converts it to
+	/// the device format. Mixed streams are cheap to create, don't need
+	/// any memory of the device, and the mixer scales to hundreds of
+	/// streams.
+	///
+	/// Mixed streams are converted and resampled to the format of the
+	/// mix, so they may have any sample format and frequency, but must
+	/// have as many channels as the mix. The device stream is started
+	/// when the first mixed stream plays, and keeps playing until the
+	/// mixer and all of its streams have been destroyed.
+	class mixer
+	{
+		public:
+			/// Integral type for channel counts
+			using channel_count = sample_format::channel_count;
+
+			/// Create a mixer for an output device
+			/// @param device      The output device
+			/// @param frequency   The frequency of the mix, and of the
+			///                    device stream
+			/// @param channels    The number of channels of the mix
+			/// @param options     The buffer configuration of the device
+			///                    stream
+			mixer( output_device& device, audio_format::frequency_type frequency, channel_count channels, stream_options const& options = stream_options{} );
+
+			/// Create an audio stream that is mixed
+			/// @param format    The format of the audio stream
+			/// @param options   The stream options, of which the render
+			///                  quantum and the resampler quality are used
+			/// @throws sample_format_exception if the stream has another
+			///         number of channels than the mix
+			audio_stream create_audio_stream( audio_format const& format, stream_options const& options = stream_options{} );
+
+			/// @returns The format of the mix, which has float samples in
+			///          native byte order
+			audio_format const& format() const;
+
+			/// @returns The number of mixed streams that are playing
+			std::size_t playing_streams() const;
+
+			/// @returns The device stream that plays the mix, for its
+			///          configuration, statistics and timing
+			audio_stream const& device_stream() const;
+
+		private:
+			/// The mixer, which is shared with the mixed streams
+			std::shared_ptr<backend::mixer_engine> _engine;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_MIXER_HPP
@@ -4,7 +4,10 @@
 #include <chirp/audio_format.hpp>
 #include <chirp/audio_stream.hpp>
 #include <chirp/backend.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/stream_options.hpp>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 
 namespace chirp
@@ -38,11 +41,36 @@ namespace chirp
 				return _device_ptr->name();
 			}
 
-			///
-			///
-			///
-			audio_stream create_audio_stream( audio_format const& format ) {
-				return audio_stream{ format, _device_ptr->create_audio_stream( format ) };
+			/// Create an audio stream that plays through the device
+			/// @param format    The format of the audio stream
+			/// @param options   Requested buffer configuration, or a latency
+			///                  profile. Use `audio_stream::configuration()`
+			///                  to find out what the device settled for.
+			audio_stream create_audio_stream( audio_format const& format, stream_options const& options = stream_options{} ) {
+				return audio_stream{ format, _device_ptr->create_audio_stream( format, options ) };
+			}
+
+			/// Check if the device can play a format, such as float32
+			/// samples, without conversion.
+			/// @param format   The format of an audio stream
+			/// @returns `true` if an audio stream of the format can be
+			///          created
+			bool supports( audio_format const& format ) const {
+				return _device_ptr->supports( format );
+			}
+
+			/// Pick the first format that the device supports
+			/// @param formats   The formats, in order of preference
+			/// @returns The first supported format
+			/// @throws sample_format_exception if none of the formats are
+			///                                 supported
+			audio_format negotiate( std::initializer_list<audio_format> formats ) const {
+				for( auto const& format : formats ) {
+					if( supports( format ) ) {
+						return format;
+					}
+				}
+				throw sample_format_exception{};
 			}
 
 			///
@@ -0,0 +1,115 @@
+#ifndef IG_CHIRP_PLANAR_REQUEST_HPP
+#define IG_CHIRP_PLANAR_REQUEST_HPP
+
+#include <chirp/audio_format.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace chirp
+{
+	/// A request for samples to fill non-interleaved float32 channel
+	/// buffers. Samples range from -1.0 to 1.0, and are converted to the
+	/// sample format of the stream by chirp.
+	class planar_request
+	{
+		public:
+			/// duration type
+			using duration_type = chirp::duration_type;
+			/// integral type for frame counts
+			using size_type = std::size_t;
+			/// integral type for channel counts
+			using channel_count = audio_format::channel_count;
+			/// integral type for frame positions
+			using frame_index = audio_format::frame_index;
+			/// monotonic time type for presentation times
+			using time_point = std::chrono::steady_clock::time_point;
+
+			/// Create a planar_request
+			///
+			/// @param channel_ptrs   Pointers to the buffer of each channel
+			/// @param frames         The number of samples in each buffer
+			/// @param format         The audio format of the stream
+			/// @param position       The position of the first requested
+			///                       frame on the timeline of the stream
+			/// @param presentation   The time at which the first requested
+			///                       frame reaches the device, or a default
+			///                       constructed time point if unknown
+			planar_request( float* const* channel_ptrs, size_type frames, audio_format const& format, frame_index position = 0, time_point presentation = time_point{} ) :
+				_channel_ptrs( channel_ptrs ),
+				_frames( frames ),
+				_format( format ),
+				_position( position ),
+				_presentation( presentation )
+			{}
+
+			/// @returns The buffer of a channel, which holds `frames()`
+			///          samples that are all zero when the request is
+			///          issued.
+			float* channel( channel_count index ) const {
+				return _channel_ptrs[index];
+			}
+
+			/// @returns The number of channels
+			channel_count channels() const {
+				return _format.get().channels();
+			}
+
+			/// @returns The number of samples that is requested for each
+			///          channel.
+			size_type frames() const {
+				return _frames;
+			}
+
+			/// @return The audio format of the stream
+			audio_format const& format() const {
+				return _format.get();
+			}
+
+			/// @returns The duration of the requested samples
+			duration_type duration() const {
+				return duration_type{ _frames / (float)_format.get().frequency() };
+			}
+
+			/// @returns The exact position of the first requested frame on
+			///          the timeline of the stream
+			frame_index frame_position() const {
+				return _position;
+			}
+
+			/// @returns The `steady_clock` time at which the first requested
+			///          frame is expected to reach the device, see
+			///          `sample_request::presentation_time()`
+			time_point presentation_time() const {
+				return _presentation;
+			}
+
+		private:
+			/// Buffers of the channels
+			float* const* _channel_ptrs;
+			/// Number of samples in each buffer
+			size_type _frames;
+			/// Format of the stream
+			std::reference_wrapper<audio_format const> _format;
+			/// Position of the first requested frame
+			frame_index _position;
+			/// Time at which the first requested frame is played
+			time_point _presentation;
+	};
+
+	/// Function type for filling planar requests
+	using planar_provider_func = std::function<void(duration_type const&, planar_request const&)>;
+
+	/// Trait for function objects that can fill planar requests
+	template <class F, class = void>
+	struct is_planar_provider : std::false_type {};
+
+	/// Trait for function objects that can fill planar requests
+	template <class F>
+	struct is_planar_provider<F, decltype( void( std::declval<F&>()( std::declval<duration_type const&>(), std::declval<planar_request const&>() ) ) )> : std::true_type {};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_PLANAR_REQUEST_HPP
@@ -0,0 +1,164 @@
+#ifndef IG_CHIRP_RESAMPLER_HPP
+#define IG_CHIRP_RESAMPLER_HPP
+
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_format.hpp>
+#include <chirp/stream_options.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace chirp
+{
+	namespace backend
+	{
+		struct conversion_kernels;
+	}   // namespace backend
+
+	/// Exception type for resampling ratios out of range, and resamplers
+	/// without channels
+	struct resampler_exception : exception {};
+
+	/// Converts interleaved float samples from one frequency to another.
+	///
+	/// The resampler is a windowed-sinc polyphase filter. The coefficients
+	/// between two phases are interpolated, so any ratio can be used, and
+	/// the ratio can be changed while samples are resampled, for instance
+	/// to follow the drift between two clocks. The filter is applied by the
+	/// vector kernels of the CPU.
+	///
+	/// The filter is designed once, for the lowest ratio that the
+	/// resampler may be set to, so that changing the ratio never allocates
+	/// memory or recalculates coefficients and can be done from the play
+	/// thread. By default the ratio can be lowered by a percent, which is
+	/// enough to follow the drift between two clocks. Resamplers that
+	/// change the ratio further are created with a lower bound, and filter
+	/// at the cut-off and length of that bound at any ratio.
+	class resampler
+	{
+		public:
+			/// Integral type for channel counts
+			using channel_count = sample_format::channel_count;
+
+			/// The smallest ratio, which resamples to a sixteenth of the
+			/// frequency
+			static constexpr double minimum_ratio = 1.0 / 16.0;
+			/// The largest ratio
+			static constexpr double maximum_ratio = 64.0;
+
+			/// The number of frames that a call to `process()` used
+			struct result
+			{
+				/// Number of input frames that were consumed
+				std::size_t input_frames;
+				/// Number of output frames that were written
+				std::size_t output_frames;
+			};
+
+			/// Create a resampler
+			/// @param channels   The number of interleaved channels
+			/// @param ratio      The output frequency divided by the input
+			///                   frequency
+			/// @param quality    The quality tier
+			/// @param lowest     The lowest ratio that the resampler may be
+			///                   set to, or zero for a percent below
+			///                   `ratio`
+			/// @throws resampler_exception if there are no channels, or
+			///         a ratio is out of range
+			resampler( channel_count channels, double ratio, resample_quality quality = resample_quality::balanced, double lowest = 0.0 );
+
+			/// Change the ratio, from the next output frame on
+			/// @param ratio   The output frequency divided by the input
+			///                frequency
+			/// @throws resampler_exception if the ratio is out of range,
+			///         or below the lowest ratio of the resampler
+			void set_ratio( double ratio );
+
+			/// Resample as many frames as possible. Input frames are kept
+			/// until the filter has passed them, so the output lags the
+			/// input by half the length of the filter.
+			/// @param input           Interleaved input frames
+			/// @param input_frames    The number of input frames
+			/// @param output          Buffer for interleaved output frames
+			/// @param output_frames   The size of the output buffer, in
+			///                        frames
+			/// @returns The number of frames that were consumed and written.
+			///          Either all input frames are consumed or the output
+			///          buffer is full.
+			result process( float const* input, std::size_t input_frames, float* output, std::size_t output_frames );
+
+			/// Forget all input frames, and start over with silence
+			void reset();
+
+			/// @returns The number of input frames between the next output
+			///          frame and the end of the input that has been
+			///          consumed. This is the delay that the resampler adds.
+			double delay() const {
+				return static_cast<double>( _filled ) - (_time + static_cast<double>( _taps / 2 - 1 ));
+			}
+
+			/// @returns The output frequency divided by the input frequency
+			double ratio() const {
+				return _ratio;
+			}
+
+			/// @returns The lowest ratio that the filter is designed for
+			double lowest_ratio() const {
+				return _lowest;
+			}
+
+			/// @returns The quality tier
+			resample_quality quality() const {
+				return _quality;
+			}
+
+			/// @returns The number of taps of the filter
+			std::size_t taps() const {
+				return _taps;
+			}
+
+			/// @returns The number of interleaved channels
+			channel_count channels() const {
+				return _channels;
+			}
+
+		private:
+			/// Calculate the coefficients of all phases for the lowest
+			/// ratio
+			void design();
+
+			/// Throw if a ratio is out of range
+			static double check( double ratio );
+
+			/// The number of interleaved channels
+			channel_count _channels;
+			/// The quality tier
+			resample_quality _quality;
+			/// The output frequency divided by the input frequency
+			double _ratio;
+			/// The lowest ratio, which the filter is designed for
+			double _lowest;
+			/// The number of input frames per output frame
+			double _step;
+			/// Number of taps of each phase
+			std::size_t _taps;
+			/// Number of phases between two input frames
+			std::size_t _phases;
+			/// Coefficients of each phase, with an extra phase at the end
+			/// to interpolate towards
+			std::vector<float> _coefficients;
+			/// Input frames of each channel, one after the other
+			std::vector<float> _history;
+			/// Number of frames that each channel of the history can hold
+			std::size_t _capacity;
+			/// Number of frames in the history
+			std::size_t _filled;
+			/// Position of the first frame that the next output frame is
+			/// filtered from, with the fraction that selects the phase
+			double _time;
+			/// The vector kernels
+			backend::conversion_kernels const* _kernels;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_RESAMPLER_HPP
@@ -3,6 +3,8 @@
 
 #include <chirp/exceptions.hpp>
 
+#include <cstdint>
+
 namespace chirp
 {
 	///
@@ -13,6 +15,23 @@ namespace chirp
 		little_endian
 	};
 
+	/// The byte order of the platform that chirp is built for
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	constexpr byte_order native_byte_order = byte_order::big_endian;
+#else
+	constexpr byte_order native_byte_order = byte_order::little_endian;
+#endif
+
+	/// The numeric type of the samples of a sample format
+	enum class sample_type {
+		/// Two's complement integers, silent at zero
+		signed_integer,
+		/// Unsigned integers, silent at half of the range
+		unsigned_integer,
+		/// IEEE 754 floating point numbers from -1.0 to 1.0
+		floating_point
+	};
+
 	///
 	///
 	///
@@ -31,16 +50,14 @@ namespace chirp
 			using byte_count = std::uint32_t;
 
 			/// Construct an sample format with a maximum of eight bits per sample.
+			/// The samples are unsigned.
 			///
 			/// @param bits_per_sample   The number of bits that each sample
 			///                          consists of.
 			/// @param channels          The number of interleaved channels
 			/// @pre bits_per_sample <= 8
 			sample_format( bit_count bits_per_sample, channel_count channels ) :
-				_bits_per_sample( bits_per_sample ),
-				_endianness( byte_order::little_endian ),
-				_channels( channels ),
-				_bytes_per_frame( (_bits_per_sample / 8) * _channels )
+				sample_format( sample_type::unsigned_integer, bits_per_sample, container_for( bits_per_sample ), byte_order::little_endian, channels )
 			{
 				if( _bits_per_sample > 8 ) {
 					throw byte_order_exception{};
@@ -48,6 +65,7 @@ namespace chirp
 			}
 
 			/// Construct an sample format, with more than eight bits per sample.
+			/// The samples are signed integers, packed without padding.
 			///
 			/// @param bits_per_sample   The number of bits that each sample
 			///                          consists of. This value must be >8
@@ -55,22 +73,82 @@ namespace chirp
 			/// @param channels          The number of interleaved channels
 			/// @pre bits_per_sample > 8
 			sample_format( bit_count bits_per_sample, byte_order endianness, channel_count channels ) :
-				_bits_per_sample( bits_per_sample ),
-				_endianness( endianness ),
-				_channels( channels ),
-				_bytes_per_frame( (_bits_per_sample / 8) * _channels )
+				sample_format( sample_type::signed_integer, bits_per_sample, container_for( bits_per_sample ), endianness, channels )
 			{
 				if( _bits_per_sample <= 8 ) {
 					throw byte_order_exception{};
 				}
 			}
 
+			/// Construct a sample format of any sample type, with samples
+			/// that are packed without padding.
+			///
+			/// @param type              The numeric type of the samples
+			/// @param bits_per_sample   The number of bits that each sample
+			///                          consists of. Integers may have up to
+			///                          32 bits, floating point numbers 32 or
+			///                          64 bits.
+			/// @param endianness        The byte order of each sample, which
+			///                          is ignored for single byte samples
+			/// @param channels          The number of interleaved channels
+			/// @throws sample_format_exception if the sample type can't have
+			///                                 that many bits
+			sample_format( sample_type type, bit_count bits_per_sample, byte_order endianness, channel_count channels ) :
+				sample_format( type, bits_per_sample, container_for( bits_per_sample ), endianness, channels )
+			{}
+
+			/// Construct a sample format with samples that are padded to a
+			/// wider container, such as 24 bit samples in 32 bits. The
+			/// sample is held in the least significant bits of the
+			/// container, and is sign extended if it is signed.
+			///
+			/// @param type              The numeric type of the samples
+			/// @param bits_per_sample   The number of bits of each sample
+			///                          that are significant
+			/// @param container_bits    The number of bits that each sample
+			///                          takes up, a multiple of eight
+			/// @param endianness        The byte order of each container,
+			///                          which is ignored for single bytes
+			/// @param channels          The number of interleaved channels
+			/// @throws sample_format_exception if the sample type can't have
+			///                                 that many bits, or the samples
+			///                                 don't fit in the container
+			sample_format( sample_type type, bit_count bits_per_sample, bit_count container_bits, byte_order endianness, channel_count channels ) :
+				_type( type ),
+				_bits_per_sample( bits_per_sample ),
+				_bytes_per_sample( static_cast<byte_count>( container_bits / 8 ) ),
+				// The byte order of single bytes is undefined, so it is
+				// always the same in order for equal formats to compare equal
+				_endianness( container_bits > 8 ? endianness : byte_order::little_endian ),
+				_channels( channels ),
+				_bytes_per_frame( _bytes_per_sample * _channels )
+			{
+				auto valid_bits = type == sample_type::floating_point
+					? (bits_per_sample == 32 || bits_per_sample == 64) && container_bits == bits_per_sample
+					: bits_per_sample > 0 && bits_per_sample <= 32 && container_bits <= 32;
+				if( !valid_bits || container_bits % 8 != 0 || container_bits < bits_per_sample ) {
+					throw sample_format_exception{};
+				}
+			}
+
+			/// Retrieve the numeric type of the samples
+			/// @returns The sample type
+			sample_type type() const {
+				return _type;
+			}
+
 			/// Retrieve the bits per sample of the sample format
-			/// @returns The number of bits per individual sample
+			/// @returns The number of significant bits per individual sample
 			bit_count bits_per_sample() const {
 				return _bits_per_sample;
 			}
 
+			/// Retrieve the size of each sample, including padding
+			/// @returns The number of bytes per individual sample
+			byte_count bytes_per_sample() const {
+				return _bytes_per_sample;
+			}
+
 			/// Retrieve the endianness of the sample format
 			/// @returns The byte order of each individual sample
 			/// @throws byte_order_exception is thrown if the format has samples
@@ -78,14 +156,22 @@ namespace chirp
 			///                              size. Byte order does not apply
 			///                              unless the samples are of multiple
 			///                              bytes.
-			/// @pre this.bits_per_sample() > 8
+			/// @pre this.bytes_per_sample() > 1
 			byte_order endianness() const {
-				if( _bits_per_sample <=8 ) {
+				if( _bytes_per_sample <= 1 ) {
 					throw byte_order_exception{};
 				}
 				return _endianness;
 			}
 
+			/// Get the same sample layout in another byte order
+			/// @param endianness   The byte order of each sample
+			/// @returns The sample format in that byte order, which equals
+			///          this one if the samples are single bytes
+			sample_format in_byte_order( byte_order endianness ) const {
+				return sample_format{ _type, _bits_per_sample, static_cast<bit_count>( _bytes_per_sample * 8 ), endianness, _channels };
+			}
+
 			/// Retrieve the number channels of the sample format
 			/// @returns The number of interleaved channels
 			channel_count channels() const {
@@ -94,8 +180,10 @@ namespace chirp
 
 			///
 			bool operator==( sample_format const& lhs ) const {
-				return _bits_per_sample == lhs._bits_per_sample &&
-				       _endianness == lhs._endianness && 
+				return _type == lhs._type &&
+				       _bits_per_sample == lhs._bits_per_sample &&
+				       _bytes_per_sample == lhs._bytes_per_sample &&
+				       _endianness == lhs._endianness &&
 				       _channels == lhs._channels;
 			}
 
@@ -110,7 +198,15 @@ namespace chirp
 			}
 
 		private:
+			/// @returns The number of bits of the smallest whole number of
+			///          bytes that holds a sample
+			static bit_count container_for( bit_count bits_per_sample ) {
+				return static_cast<bit_count>( ((bits_per_sample + 7) / 8) * 8 );
+			}
+
+			sample_type _type;             ///< The numeric type of the samples
 			bit_count _bits_per_sample;    ///< The number of bits per individual sample
+			byte_count _bytes_per_sample;  ///< The number of bytes per individual sample
 			byte_order _endianness;        ///< The byte order of each sample
 			channel_count _channels;       ///< The number of interleaved channels
 			byte_count _bytes_per_frame;   ///< The number of bytes per frame
@@ -124,6 +220,18 @@ namespace chirp
 	extern sample_format const sixteen_bits_big_endian_mono;
 	extern sample_format const sixteen_bits_little_endian_stereo;
 	extern sample_format const sixteen_bits_big_endian_stereo;
+	extern sample_format const twenty_four_bits_little_endian_mono;
+	extern sample_format const twenty_four_bits_little_endian_stereo;
+	extern sample_format const twenty_four_in_thirty_two_bits_little_endian_mono;
+	extern sample_format const twenty_four_in_thirty_two_bits_little_endian_stereo;
+	extern sample_format const thirty_two_bits_little_endian_mono;
+	extern sample_format const thirty_two_bits_little_endian_stereo;
+
+	// Constants for floating point sample formats, in the native byte order
+	extern sample_format const float32_mono;
+	extern sample_format const float32_stereo;
+	extern sample_format const float64_mono;
+	extern sample_format const float64_stereo;
 }
 
-#endif   // IG_CHIRP_SAMPLE_FORMAT_HPP
\ No newline at end of file
+#endif   // IG_CHIRP_SAMPLE_FORMAT_HPP
@@ -0,0 +1,208 @@
+#ifndef IG_CHIRP_SAMPLE_GENERATOR_HPP
+#define IG_CHIRP_SAMPLE_GENERATOR_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+#include <chirp/sample_view.hpp>
+
+// Sample generators are coroutines, which requires C++20. Everything is
+// implemented in this header, so the library itself can still be built
+// as C++14.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#	if __has_include(<coroutine>)
+#		define CHIRP_WITH_COROUTINES
+#	endif
+#endif
+
+#if defined(CHIRP_WITH_COROUTINES)
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+namespace chirp
+{
+	/// A block of interleaved frames that a sample generator yields. The
+	/// frames only have to stay valid until the generator is resumed.
+	class sample_block
+	{
+		public:
+			/// Create a block
+			/// @param ptr      Pointer to interleaved frames of the format
+			///                 of the stream
+			/// @param frames   The number of frames
+			sample_block( void const* ptr, std::size_t frames ) :
+				_ptr( ptr ),
+				_size( frames )
+			{}
+
+			/// Create a block from a frame view
+			/// @param view   The frames
+			template <class T, std::size_t Channels>
+			sample_block( frames<T, Channels> const& view ) :
+				_ptr( view.data() ),
+				_size( view.size() )
+			{}
+
+			/// @returns Pointer to the first frame
+			void const* data() const {
+				return _ptr;
+			}
+
+			/// @returns The number of frames
+			std::size_t size() const {
+				return _size;
+			}
+
+		private:
+			/// First frame
+			void const* _ptr;
+			/// Number of frames
+			std::size_t _size;
+	};
+
+	/// Sample provider that is implemented as a coroutine, which yields
+	/// blocks of frames with `co_yield`.
+	///
+	/// The coroutine is resumed on the play thread each time a sample
+	/// request needs more frames than the last block had left. Blocks may
+	/// have any size; they are split over the sample requests as needed.
+	/// Once the coroutine returns, the end of the stream is reported and
+	/// the rest of the stream is silent. The coroutine frame is allocated
+	/// once, when the generator is created.
+	///
+	///     chirp::sample_generator beep( chirp::audio_format format ) {
+	///         std::array<std::int16_t, 256> block{};
+	///         for( int i=0; i<100; ++i ) {
+	///             fill( block );
+	///             co_yield chirp::sample_block{ block.data(), block.size() };
+	///         }
+	///     }
+	class sample_generator :
+		public filling_sample_provider
+	{
+		public:
+			/// Coroutine promise of sample generators
+			class promise_type
+			{
+				public:
+					/// @returns The generator of the coroutine
+					sample_generator get_return_object() {
+						return sample_generator{ std::coroutine_handle<promise_type>::from_promise( *this ) };
+					}
+
+					/// Don't run the coroutine until samples are requested
+					std::suspend_always initial_suspend() noexcept {
+						return {};
+					}
+
+					/// Keep the coroutine frame until the generator is destroyed
+					std::suspend_always final_suspend() noexcept {
+						return {};
+					}
+
+					/// Hand a block of frames to the generator
+					std::suspend_always yield_value( sample_block block ) noexcept {
+						_block = block;
+						return {};
+					}
+
+					/// The coroutine has no result
+					void return_void() noexcept {
+					}
+
+					/// Keep exceptions until the generator can rethrow them
+					void unhandled_exception() noexcept {
+						_exception = std::current_exception();
+					}
+
+					/// @returns The last block that was yielded
+					sample_block const& block() const {
+						return _block;
+					}
+
+					/// @returns An exception that the coroutine let escape
+					std::exception_ptr const& exception() const {
+						return _exception;
+					}
+
+				private:
+					/// Last yielded block
+					sample_block _block{ nullptr, 0 };
+					/// Exception that escaped the coroutine
+					std::exception_ptr _exception;
+			};
+
+			/// Move a generator
+			sample_generator( sample_generator&& other ) noexcept :
+				_handle( std::exchange( other._handle, nullptr ) ),
+				_offset( other._offset )
+			{}
+
+			// Not copy-constructable or assignable
+			sample_generator( sample_generator const& ) = delete;
+			sample_generator& operator=( sample_generator const& ) = delete;
+			sample_generator& operator=( sample_generator&& ) = delete;
+
+			/// Destroy the coroutine
+			~sample_generator() override {
+				if( _handle ) {
+					_handle.destroy();
+				}
+			}
+
+			/// @returns `true` once the coroutine has returned
+			bool done() const {
+				return !_handle || _handle.done();
+			}
+
+			/// Fill a sample request with the blocks yielded by the
+			/// coroutine. This is called on the play thread.
+			/// @returns The number of frames that were yielded, and whether
+			///          the coroutine has returned
+			/// @throws Any exception that escapes the coroutine
+			fill_result fill_samples( duration_type const&, sample_request const& request ) override {
+				auto bytes_per_frame = request.format().bytes_per_frame();
+				auto* target = static_cast<std::uint8_t*>( request.buffer_start() );
+				std::size_t frames = request.frames();
+				while( frames > 0 && !done() ) {
+					auto const& block = _handle.promise().block();
+					if( _offset == block.size() ) {
+						_offset = 0;
+						_handle.resume();
+						if( auto exception = _handle.promise().exception() ) {
+							std::rethrow_exception( exception );
+						}
+						continue;
+					}
+					auto count = std::min( frames, block.size() - _offset );
+					std::memcpy( target, static_cast<std::uint8_t const*>( block.data() ) + _offset * bytes_per_frame, count * bytes_per_frame );
+					target += count * bytes_per_frame;
+					frames -= count;
+					_offset += count;
+				}
+				return fill_result{ static_cast<sample_request::sample_count>( request.frames() - frames ), done() };
+			}
+
+		private:
+			/// Create a generator for a coroutine
+			explicit sample_generator( std::coroutine_handle<promise_type> handle ) :
+				_handle( handle ),
+				_offset( 0 )
+			{}
+
+			/// The coroutine
+			std::coroutine_handle<promise_type> _handle;
+			/// Number of frames of the last block that have been played
+			std::size_t _offset;
+	};
+}   // namespace chirp
+
+#endif   // CHIRP_WITH_COROUTINES
+
+#endif   // IG_CHIRP_SAMPLE_GENERATOR_HPP
@@ -0,0 +1,167 @@
+#ifndef IG_CHIRP_SAMPLE_PROVIDER_HPP
+#define IG_CHIRP_SAMPLE_PROVIDER_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/sample_request.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace chirp
+{
+	/// The outcome of filling a sample request
+	struct fill_result
+	{
+		/// The number of frames that were written, from the start of the
+		/// request. The audio stream fills the frames after them with
+		/// silence.
+		sample_request::sample_count frames;
+		/// `true` if the sample provider has no more samples. The stream
+		/// plays silence from the end of the written frames on.
+		bool end_of_stream;
+
+		/// @returns A result for a request that was written in full
+		static fill_result full( sample_request const& request ) {
+			return fill_result{ request.frames(), false };
+		}
+
+		/// @returns A result for the last frames of the stream
+		static fill_result end( sample_request::sample_count frames ) {
+			return fill_result{ frames, true };
+		}
+	};
+
+	/// Interface for objects that fill sample requests of audio streams.
+	///
+	/// Audio streams only keep a reference to a sample provider that they
+	/// are playing, so starting a stream with a sample provider never
+	/// allocates any memory, and each sample request costs a single
+	/// virtual call. The sample provider must outlive the playback.
+	class sample_provider
+	{
+		public:
+			/// Pure virtual destructor
+			virtual ~sample_provider() = 0;
+
+			/// Fill a sample request. This is called on the play thread,
+			/// with a buffer that has been cleared.
+			/// @param play_time   The amount of time that has been played
+			///                    before the requested samples
+			/// @param request     The request to fill
+			virtual void provide_samples( duration_type const& play_time, sample_request const& request ) = 0;
+
+			/// Fill a sample request, whose buffer has NOT been cleared.
+			/// This is what audio streams call on the play thread. Sample
+			/// providers that write every frame, or that report how many
+			/// frames they wrote, override this to avoid clearing the
+			/// buffer twice. By default, the buffer is cleared and
+			/// `provide_samples()` is called.
+			/// @param play_time   The amount of time that has been played
+			///                    before the requested samples
+			/// @param request     The request to fill
+			/// @returns The number of frames that were written, and whether
+			///          the stream has ended
+			virtual fill_result fill_samples( duration_type const& play_time, sample_request const& request ) {
+				std::memset( request.buffer_start(), 0, request.buffer_size() );
+				provide_samples( play_time, request );
+				return fill_result::full( request );
+			}
+	};
+
+	// destructor implementation
+	inline sample_provider::~sample_provider() {
+	}
+
+	/// Base class for sample providers that fill sample requests without
+	/// having the buffer cleared first, and report how much they wrote.
+	class filling_sample_provider :
+		public sample_provider
+	{
+		public:
+			/// Fill a sample request through `fill_samples()`, and clear
+			/// the frames that weren't written.
+			void provide_samples( duration_type const& play_time, sample_request const& request ) override {
+				clear_tail( request, fill_samples( play_time, request ) );
+			}
+
+			/// Fill a sample request, whose buffer has NOT been cleared
+			fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override = 0;
+
+			/// Clear the frames of a request after the written frames
+			/// @param request   The request
+			/// @param result    The outcome of filling the request
+			static void clear_tail( sample_request const& request, fill_result const& result ) {
+				if( result.frames < request.frames() ) {
+					auto offset = result.frames * request.format().bytes_per_frame();
+					std::memset( static_cast<std::uint8_t*>(request.buffer_start()) + offset, 0, request.buffer_size() - offset );
+				}
+			}
+	};
+
+	/// Sample provider that calls a function object, which is stored by
+	/// value within the sample provider.
+	///
+	/// If the function object returns a `fill_result`, it is called with
+	/// buffers that haven't been cleared, and only the frames it didn't
+	/// write are cleared.
+	template <class F>
+	class callable_sample_provider :
+		public sample_provider
+	{
+		/// Whether the function object returns a fill result
+		using fills = std::is_same<fill_result, decltype( std::declval<F&>()( std::declval<duration_type const&>(), std::declval<sample_request const&>() ) )>;
+
+		public:
+			/// Create a sample provider from a function object
+			/// @param func   The function object, which is called with the
+			///               same arguments as `provide_samples()`.
+			explicit callable_sample_provider( F func ) :
+				_func( std::move(func) )
+			{}
+
+			/// Fill a cleared sample request by calling the function object
+			void provide_samples( duration_type const& play_time, sample_request const& request ) override {
+				_func( play_time, request );
+			}
+
+			/// Fill a sample request by calling the function object
+			fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override {
+				return fill( play_time, request, fills{} );
+			}
+
+			/// @returns The function object
+			F& callable() {
+				return _func;
+			}
+
+		private:
+			/// Fill a sample request with a function object that reports
+			/// how many frames it wrote
+			fill_result fill( duration_type const& play_time, sample_request const& request, std::true_type ) {
+				return _func( play_time, request );
+			}
+
+			/// Fill a sample request with a function object that expects
+			/// a cleared buffer
+			fill_result fill( duration_type const& play_time, sample_request const& request, std::false_type ) {
+				return sample_provider::fill_samples( play_time, request );
+			}
+
+			/// The function object
+			F _func;
+	};
+
+	/// Create a sample provider from a function object, such as a lambda
+	/// with a large capture, without any heap allocation.
+	/// @param func   The function object
+	/// @returns The sample provider, which must be kept alive while any
+	///          audio stream is playing it.
+	template <class F>
+	callable_sample_provider<typename std::decay<F>::type> make_sample_provider( F&& func ) {
+		return callable_sample_provider<typename std::decay<F>::type>{ std::forward<F>(func) };
+	}
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SAMPLE_PROVIDER_HPP
@@ -0,0 +1,132 @@
+#ifndef IG_CHIRP_SAMPLE_QUEUE_HPP
+#define IG_CHIRP_SAMPLE_QUEUE_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chirp
+{
+	/// Exception type for writes to audio streams that aren't playing in
+	/// push mode, and for sample queues with invalid sizes
+	struct push_mode_exception : exception {};
+
+	/// Sample provider that plays samples which are pushed to it by
+	/// another thread.
+	///
+	/// The samples are kept in a single-producer single-consumer ring
+	/// buffer. Both writing and reading are wait-free, so the play thread
+	/// never waits for the producer. Only one thread may write to the
+	/// queue at a time. Samples that haven't been written in time are
+	/// played as silence.
+	///
+	/// A queue that is closed takes no more frames, so a producer that
+	/// waits for room is never left waiting for a play thread that has
+	/// stopped.
+	class sample_queue :
+		public filling_sample_provider
+	{
+		public:
+			/// Integral type for frame counts
+			using frame_count = std::size_t;
+
+			/// Create a sample queue
+			/// @param format              The audio format of the samples
+			/// @param capacity_frames     The size of the ring buffer
+			/// @param high_water_frames   The number of queued frames above
+			///                            which writes block or are cut
+			///                            short, or zero for the capacity.
+			/// @throws push_mode_exception if the capacity is zero, or the
+			///                             high-water mark exceeds it
+			sample_queue( audio_format const& format, frame_count capacity_frames, frame_count high_water_frames = 0 );
+
+			// Not copy-constructable or copy-assignable
+			sample_queue( sample_queue const& ) = delete;
+			sample_queue& operator=( sample_queue const& ) = delete;
+
+			/// Queue as many frames as fit below the high-water mark,
+			/// without waiting.
+			/// @param ptr      Pointer to interleaved frames of the format
+			/// @param frames   The number of frames to queue
+			/// @returns The number of frames that were queued, which is
+			///          none if the queue is closed
+			frame_count try_write( void const* ptr, frame_count frames );
+
+			/// Queue frames, waiting for the play thread to make room below
+			/// the high-water mark as needed. Must not be called on the
+			/// play thread.
+			/// @param ptr      Pointer to interleaved frames of the format
+			/// @param frames   The number of frames to queue
+			/// @returns The number of frames that were queued, which is
+			///          all of them unless the queue was closed
+			frame_count write( void const* ptr, frame_count frames );
+
+			/// Queue frames, waiting for the play thread to make room below
+			/// the high-water mark for at most a given time. Must not be
+			/// called on the play thread.
+			/// @param ptr       Pointer to interleaved frames of the format
+			/// @param frames    The number of frames to queue
+			/// @param timeout   The longest time to wait for room
+			/// @returns The number of frames that were queued
+			frame_count write( void const* ptr, frame_count frames, std::chrono::nanoseconds timeout );
+
+			/// Stop taking frames. Writes that wait for room return the
+			/// frames that they have queued, and later writes queue
+			/// nothing. Frames that are already queued can still be
+			/// played. May be called from any thread.
+			void close() {
+				_closed.store( true, std::memory_order_release );
+			}
+
+			/// @returns `true` if the queue has been closed
+			bool closed() const {
+				return _closed.load( std::memory_order_acquire );
+			}
+
+			/// @returns The number of frames that are queued. May be called
+			///          from any thread.
+			frame_count queued_frames() const {
+				return static_cast<frame_count>( _write_index.load( std::memory_order_acquire ) - _read_index.load( std::memory_order_acquire ) );
+			}
+
+			/// @returns The size of the ring buffer, in frames
+			frame_count capacity() const {
+				return _capacity;
+			}
+
+			/// @returns The number of queued frames above which writes
+			///          block or are cut short
+			frame_count high_water_mark() const {
+				return _high_water;
+			}
+
+			/// Play the queued frames. This is called on the play thread.
+			/// @returns The number of frames that were queued
+			fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override;
+
+		private:
+			/// Audio format of the samples
+			audio_format _format;
+			/// Size of the ring buffer, in frames
+			frame_count _capacity;
+			/// Number of queued frames above which writes are held back
+			frame_count _high_water;
+			/// The ring buffer
+			std::vector<std::uint8_t> _buffer;
+			/// Total number of frames written, only written by the producer
+			std::atomic<std::uint64_t> _write_index;
+			/// Total number of frames read, only written by the play thread
+			std::atomic<std::uint64_t> _read_index;
+			/// Flag telling if the queue takes no more frames
+			std::atomic<bool> _closed;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SAMPLE_QUEUE_HPP
@@ -3,6 +3,7 @@
 
 #include <chirp/audio_format.hpp>
 
+#include <chrono>
 #include <functional>
 
 namespace chirp
@@ -20,16 +21,27 @@ namespace chirp
 			using byte_count = audio_format::byte_count;
 			/// integral type for sample counts
 			using sample_count = audio_format::byte_count;
+			/// integral type for frame positions
+			using frame_index = audio_format::frame_index;
+			/// monotonic time type for presentation times
+			using time_point = std::chrono::steady_clock::time_point;
 
 			/// Create a sample_request
 			///
 			/// @param buffer_ptr    Pointer to the target buffer
 			/// @param buffer_size   Size of the target buffer, in bytes
 			/// @param format        The audio format that is requested
-			sample_request( pointer buffer_ptr, byte_count buffer_size, audio_format const& format ) :
+			/// @param position      The position of the first requested
+			///                      frame on the timeline of the stream
+			/// @param presentation  The time at which the first requested
+			///                      frame reaches the device, or a default
+			///                      constructed time point if unknown
+			sample_request( pointer buffer_ptr, byte_count buffer_size, audio_format const& format, frame_index position = 0, time_point presentation = time_point{} ) :
 				_start_ptr( buffer_ptr ),
 				_end_ptr( static_cast<std::uint8_t*>(buffer_ptr) + buffer_size ),
-				_format( format )
+				_format( format ),
+				_position( position ),
+				_presentation( presentation )
 			{}
 
 			/// @returns Pointer to the start of the buffer that is the target
@@ -73,6 +85,24 @@ namespace chirp
 				return duration_type{ frames() / (float)_format.get().frequency() };
 			}
 
+			/// @returns The exact position of the first requested frame on
+			///          the timeline of the stream, counted from when the
+			///          stream was started. Use this rather than the float
+			///          play time for phase-exact timing.
+			frame_index frame_position() const {
+				return _position;
+			}
+
+			/// @returns The `steady_clock` time at which the first requested
+			///          frame is expected to reach the device, estimated
+			///          from how much is queued ahead of its read cursor.
+			///          Latency inside the device itself isn't included.
+			///          A default constructed time point means that the
+			///          backend doesn't play in real time.
+			time_point presentation_time() const {
+				return _presentation;
+			}
+
 		private:
 			/// Start of the target buffer
 			pointer _start_ptr;
@@ -80,6 +110,10 @@ namespace chirp
 			pointer _end_ptr;
 			/// Format of the audio data that i requested
 			std::reference_wrapper<audio_format const> _format;
+			/// Position of the first requested frame
+			frame_index _position;
+			/// Time at which the first requested frame is played
+			time_point _presentation;
 	};
 }
 
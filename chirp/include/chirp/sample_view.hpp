@@ -0,0 +1,198 @@
+#ifndef IG_CHIRP_SAMPLE_VIEW_HPP
+#define IG_CHIRP_SAMPLE_VIEW_HPP
+
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_format.hpp>
+#include <chirp/sample_request.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace chirp
+{
+	/// Channel count of views whose number of channels is only known at
+	/// run time
+	constexpr std::size_t dynamic_channels = 0;
+
+	/// Exception type for views that don't match the sample format of the
+	/// buffer they are created for
+	struct sample_view_exception : exception {};
+
+	/// View of the samples of one channel within interleaved frames
+	template <class T>
+	class channel_view
+	{
+		public:
+			/// Sample type
+			using value_type = T;
+			/// Integral type for sample counts and indices
+			using size_type = std::size_t;
+
+			/// Create a channel view
+			/// @param data     Pointer to the first sample of the channel
+			/// @param size     The number of samples
+			/// @param stride   The distance between samples, in samples
+			channel_view( T* data, size_type size, size_type stride ) :
+				_data( data ),
+				_size( size ),
+				_stride( stride )
+			{}
+
+			/// @returns The sample at an index
+			T& operator[]( size_type index ) const {
+				return _data[index * _stride];
+			}
+
+			/// @returns Pointer to the first sample
+			T* data() const {
+				return _data;
+			}
+
+			/// @returns The number of samples
+			size_type size() const {
+				return _size;
+			}
+
+			/// @returns The distance between samples, in samples
+			size_type stride() const {
+				return _stride;
+			}
+
+		private:
+			/// First sample of the channel
+			T* _data;
+			/// Number of samples
+			size_type _size;
+			/// Distance between samples
+			size_type _stride;
+	};
+
+	/// Typed view of interleaved frames, such as the buffer of a sample
+	/// request.
+	///
+	/// With a channel count that is known at compile time, the stride
+	/// between frames is a constant, so loops over the frames can be
+	/// unrolled and vectorized by the compiler.
+	///
+	/// @tparam T          The sample type, which must be as wide as the
+	///                    samples of the format including padding, and
+	///                    floating point for floating point formats. Use a
+	///                    const type for read-only views.
+	/// @tparam Channels   The number of channels, or `dynamic_channels`
+	template <class T, std::size_t Channels = dynamic_channels>
+	class frames
+	{
+		static_assert( std::is_arithmetic<typename std::remove_const<T>::type>::value, "Samples of chirp sample formats are numbers" );
+
+		public:
+			/// Sample type
+			using value_type = T;
+			/// Integral type for frame counts and indices
+			using size_type = std::size_t;
+
+			/// Create a view of the buffer of a sample request
+			/// @param request   The sample request
+			/// @throws sample_view_exception if the view doesn't match the
+			///                               requested sample format
+			explicit frames( sample_request const& request ) :
+				frames( static_cast<T*>(request.buffer_start()), request.frames(), request.format().channels() )
+			{
+				if( !matches( request.format().sample_format() ) ) {
+					throw sample_view_exception{};
+				}
+			}
+
+			/// Create a view of a buffer
+			/// @param data       Pointer to the first sample of the buffer
+			/// @param size       The number of frames in the buffer
+			/// @param channels   The number of channels of each frame
+			/// @throws sample_view_exception if the number of channels
+			///                               doesn't match `Channels`
+			frames( T* data, size_type size, size_type channels = Channels ) :
+				_data( data ),
+				_size( size ),
+				_channels( channels )
+			{
+				if( channels == 0 || (Channels != dynamic_channels && channels != Channels) ) {
+					throw sample_view_exception{};
+				}
+			}
+
+			/// @returns true if views of this type can be created for a
+			///          sample format, i.e. if the sample type is as wide as
+			///          the samples, of the same kind of number, in the
+			///          native byte order and with a matching number of
+			///          channels.
+			static bool matches( sample_format const& format ) {
+				auto is_float = format.type() == sample_type::floating_point;
+				return format.bytes_per_sample() == sizeof(T) &&
+				       is_float == std::is_floating_point<typename std::remove_const<T>::type>::value &&
+				       (Channels == dynamic_channels || format.channels() == Channels) &&
+				       (sizeof(T) == 1 || format.endianness() == native_byte_order);
+			}
+
+			/// @returns The sample of a channel within a frame
+			T& operator()( size_type frame, size_type channel ) const {
+				return _data[frame * channels() + channel];
+			}
+
+			/// @returns Pointer to the first sample of a frame
+			T* frame( size_type index ) const {
+				return _data + index * channels();
+			}
+
+			/// @returns View of the samples of a channel
+			channel_view<T> channel( size_type index ) const {
+				return channel_view<T>{ _data + index, _size, channels() };
+			}
+
+			/// @returns Pointer to the first sample
+			T* data() const {
+				return _data;
+			}
+
+			/// @returns The number of frames
+			size_type size() const {
+				return _size;
+			}
+
+			/// @returns The number of samples in all frames
+			size_type samples() const {
+				return _size * channels();
+			}
+
+			/// @returns The number of channels
+			size_type channels() const {
+				return Channels == dynamic_channels ? _channels : Channels;
+			}
+
+			/// @returns The alignment of the first sample, in bytes, as
+			///          the largest power of two (up to 64) that divides
+			///          its address.
+			size_type alignment() const {
+				auto address = reinterpret_cast<std::uintptr_t>( _data );
+				size_type result = 1;
+				while( result < 64 && (address & result) == 0 ) {
+					result *= 2;
+				}
+				return result;
+			}
+
+			/// @returns true if the first sample is aligned to a number of
+			///          bytes, which must be a power of two.
+			bool is_aligned( size_type bytes ) const {
+				return (reinterpret_cast<std::uintptr_t>( _data ) & (bytes - 1)) == 0;
+			}
+
+		private:
+			/// First sample
+			T* _data;
+			/// Number of frames
+			size_type _size;
+			/// Number of channels, if they are only known at run time
+			size_type _channels;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SAMPLE_VIEW_HPP
@@ -8,4 +8,27 @@
 #	undef CHIRP_WITH_DIRECTSOUND
 #endif
 
-#endif
\ No newline at end of file
+#if __linux__ && defined(CHIRP_WITH_ALSA)
+	// ALSA support requires libasound, and has to be requested explicitly
+	// by defining CHIRP_WITH_ALSA
+#else
+#	undef CHIRP_WITH_ALSA
+#endif
+
+#if !defined(CHIRP_WITHOUT_NULL)
+	// The null backend has no platform dependencies, and is available
+	// unless it has been explicitly disabled
+#	define CHIRP_WITH_NULL
+#else
+#	undef CHIRP_WITH_NULL
+#endif
+
+#if !defined(CHIRP_WITHOUT_FILE_RENDER)
+	// The file render backend only depends on the standard library, and is
+	// available unless it has been explicitly disabled
+#	define CHIRP_WITH_FILE_RENDER
+#else
+#	undef CHIRP_WITH_FILE_RENDER
+#endif
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef IG_CHIRP_STREAM_OPTIONS_HPP
+#define IG_CHIRP_STREAM_OPTIONS_HPP
+
+#include <chirp/exceptions.hpp>
+#include <chrono>
+#include <cstdint>
+
+namespace chirp
+{
+	/// Exception type for stream options with invalid buffer sizes
+	struct invalid_stream_options_exception : exception {};
+
+	/// Enumerator for the predefined trade-offs between latency and CPU
+	/// usage of audio streams.
+	enum class latency_profile {
+		/// Lowest possible latency, for interactive audio. The stream is
+		/// serviced every couple of milliseconds.
+		ultra_low,
+		/// Low latency, still suitable for interactive audio but with more
+		/// headroom for sample providers that take a while to run.
+		low,
+		/// Moderate latency with a reasonable CPU usage.
+		balanced,
+		/// High latency, for background audio. The stream is only serviced
+		/// a few times per second.
+		power_saving
+	};
+
+	/// Enumerator for the quality tiers of the resampler, which trade the
+	/// steepness of the filter and the suppression of aliasing against
+	/// CPU usage.
+	enum class resample_quality {
+		/// Short filter, for voice and many simultaneous streams
+		fast,
+		/// Transparent for most material
+		balanced,
+		/// Long filter with a steep roll-off and deep suppression
+		best
+	};
+
+	/// Options for creating audio streams.
+	///
+	/// The options are requests, and the backend may adjust them to what
+	/// the device supports. The configuration that was actually used is
+	/// reported by the audio stream.
+	class stream_options
+	{
+		public:
+			/// Create options for the balanced latency profile
+			stream_options() :
+				stream_options( latency_profile::balanced )
+			{
+			}
+
+			/// Create options for a latency profile
+			/// @param profile   The latency profile
+			stream_options( latency_profile profile ) :
+				_profile( profile ),
+				_adaptive_write_ahead( false ),
+				_render_quantum( 0 ),
+				_resampler_quality( resample_quality::balanced )
+			{
+				switch( profile ) {
+					case latency_profile::ultra_low:
+						set( std::chrono::milliseconds{40}, std::chrono::milliseconds{2}, std::chrono::milliseconds{8} );
+						break;
+					case latency_profile::low:
+						set( std::chrono::milliseconds{100}, std::chrono::milliseconds{5}, std::chrono::milliseconds{20} );
+						break;
+					case latency_profile::balanced:
+						set( std::chrono::milliseconds{500}, std::chrono::milliseconds{10}, std::chrono::milliseconds{100} );
+						break;
+					case latency_profile::power_saving:
+					default:
+						set( std::chrono::seconds{2}, std::chrono::milliseconds{100}, std::chrono::milliseconds{500} );
+						break;
+				}
+			}
+
+			/// @returns The latency profile that the options are based on
+			latency_profile profile() const {
+				return _profile;
+			}
+
+			/// @returns The requested size of the device buffer
+			std::chrono::nanoseconds buffer_duration() const {
+				return _buffer_duration;
+			}
+
+			/// @returns The requested time between two services of the stream
+			std::chrono::nanoseconds period() const {
+				return _period;
+			}
+
+			/// @returns The requested amount of samples to keep queued ahead
+			///          of the device, which is the latency of the stream.
+			std::chrono::nanoseconds write_ahead() const {
+				return _write_ahead;
+			}
+
+			/// @returns `true` if the write-ahead limit is adapted to how
+			///          well the machine keeps up with the stream.
+			bool adaptive_write_ahead() const {
+				return _adaptive_write_ahead;
+			}
+
+			/// @returns The fixed number of frames that the sample provider
+			///          is asked for in each sample request, or zero if
+			///          the requests follow the chunking of the device.
+			std::uint32_t render_quantum() const {
+				return _render_quantum;
+			}
+
+			/// Create a copy of the options with another buffer size
+			/// @param duration   The requested size of the device buffer
+			/// @throws invalid_stream_options_exception if the duration
+			///         isn't positive.
+			stream_options with_buffer_duration( std::chrono::nanoseconds duration ) const {
+				auto result = *this;
+				result._buffer_duration = check( duration );
+				return result;
+			}
+
+			/// Create a copy of the options with another period
+			/// @param duration   The requested time between two services
+			/// @throws invalid_stream_options_exception if the duration
+			///         isn't positive.
+			stream_options with_period( std::chrono::nanoseconds duration ) const {
+				auto result = *this;
+				result._period = check( duration );
+				return result;
+			}
+
+			/// Create a copy of the options with another write-ahead limit
+			/// @param duration   The requested amount of samples to keep
+			///                   queued ahead of the device.
+			/// @throws invalid_stream_options_exception if the duration
+			///         isn't positive.
+			stream_options with_write_ahead( std::chrono::nanoseconds duration ) const {
+				auto result = *this;
+				result._write_ahead = check( duration );
+				return result;
+			}
+
+			/// Create a copy of the options where the write-ahead limit is
+			/// adapted while the stream plays. The limit grows when the
+			/// stream underruns or is serviced close to running out of
+			/// samples, and shrinks again while playback is stable. The
+			/// requested write-ahead limit is used as a starting point.
+			/// @param enabled   Whether the limit should be adapted
+			stream_options with_adaptive_write_ahead( bool enabled = true ) const {
+				auto result = *this;
+				result._adaptive_write_ahead = enabled;
+				return result;
+			}
+
+			/// Create a copy of the options where the sample provider is
+			/// always asked for a fixed number of frames. The stream renders
+			/// whole quanta into a staging buffer and splits them over the
+			/// regions of the device buffer, so fixed size DSP blocks can be
+			/// used regardless of how the device is serviced. This adds up
+			/// to one quantum of latency, and events on the timeline of the
+			/// stream fire before the quantum that contains their frame.
+			/// @param frames   The number of frames in each request, which
+			///                 must be a power of two up to 8192, or zero
+			///                 to follow the chunking of the device.
+			/// @throws invalid_stream_options_exception if the number of
+			///         frames isn't a power of two or is too large.
+			stream_options with_render_quantum( std::uint32_t frames ) const {
+				if( (frames & (frames - 1)) != 0 || frames > 8192 ) {
+					throw invalid_stream_options_exception{};
+				}
+				auto result = *this;
+				result._render_quantum = frames;
+				return result;
+			}
+
+			/// @returns The quality of the resampler that is used if the
+			///          device plays another frequency than the stream
+			resample_quality resampler_quality() const {
+				return _resampler_quality;
+			}
+
+			/// Create a copy of the options with another resampler quality.
+			/// Streams are resampled by chirp when the device doesn't play
+			/// their frequency, rather than by the operating system.
+			/// @param quality   The quality tier of the resampler
+			stream_options with_resampler_quality( resample_quality quality ) const {
+				auto result = *this;
+				result._resampler_quality = quality;
+				return result;
+			}
+
+		private:
+			/// Set all durations
+			void set( std::chrono::nanoseconds buffer_duration, std::chrono::nanoseconds period, std::chrono::nanoseconds write_ahead ) {
+				_buffer_duration = buffer_duration;
+				_period = period;
+				_write_ahead = write_ahead;
+			}
+
+			/// Throw if a duration isn't positive
+			static std::chrono::nanoseconds check( std::chrono::nanoseconds duration ) {
+				if( duration <= std::chrono::nanoseconds::zero() ) {
+					throw invalid_stream_options_exception{};
+				}
+				return duration;
+			}
+
+			/// The latency profile
+			latency_profile _profile;
+			/// Requested size of the device buffer
+			std::chrono::nanoseconds _buffer_duration;
+			/// Requested time between two services of the stream
+			std::chrono::nanoseconds _period;
+			/// Requested amount of samples to queue ahead of the device
+			std::chrono::nanoseconds _write_ahead;
+			/// Whether the write-ahead limit should be adapted
+			bool _adaptive_write_ahead;
+			/// Fixed number of frames in each sample request, or zero
+			std::uint32_t _render_quantum;
+			/// Quality of the resampler
+			resample_quality _resampler_quality;
+	};
+
+	/// The buffer configuration that an audio stream actually uses, after
+	/// the backend has adjusted the requested options to the device.
+	struct stream_configuration
+	{
+		/// Integral type for frame counts
+		using frame_count = std::uint32_t;
+
+		/// The frequency of the stream, in frames per second
+		std::uint32_t frequency;
+		/// Size of the device buffer
+		frame_count buffer_frames;
+		/// Number of frames between two services of the stream
+		frame_count period_frames;
+		/// Number of frames that are kept queued ahead of the device. This
+		/// changes while the stream plays if the write-ahead limit is adaptive.
+		frame_count write_ahead_frames;
+
+		/// @returns The size of the device buffer, as a duration
+		std::chrono::nanoseconds buffer_duration() const {
+			return to_duration( buffer_frames );
+		}
+
+		/// @returns The time between two services of the stream
+		std::chrono::nanoseconds period() const {
+			return to_duration( period_frames );
+		}
+
+		/// @returns The longest time from samples being requested until
+		///          they are handed to the device.
+		std::chrono::nanoseconds latency() const {
+			return to_duration( write_ahead_frames );
+		}
+
+		private:
+			/// Convert a number of frames to a duration
+			std::chrono::nanoseconds to_duration( frame_count frames ) const {
+				return frequency == 0
+					? std::chrono::nanoseconds::zero()
+					: std::chrono::nanoseconds( (static_cast<std::uint64_t>(frames) * std::nano::den) / frequency );
+			}
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_STREAM_OPTIONS_HPP
@@ -0,0 +1,38 @@
+#ifndef IG_CHIRP_STREAM_STATISTICS_HPP
+#define IG_CHIRP_STREAM_STATISTICS_HPP
+
+#include <chirp/exceptions.hpp>
+#include <cstdint>
+#include <functional>
+
+namespace chirp
+{
+	/// Counters describing how well an audio stream has kept up with its
+	/// output device since it was created.
+	struct stream_statistics
+	{
+		/// Integral type for the counters
+		using counter_type = std::uint64_t;
+
+		/// Number of times the device has run out of samples
+		counter_type underruns;
+		/// Number of frames the device played without having been given
+		/// samples for them, because of underruns.
+		counter_type silence_frames;
+		/// Number of times the stream was serviced with less than half a
+		/// period of samples left in the device buffer
+		counter_type late_callbacks;
+	};
+
+	/// Function type for handling underrun notifications. The handler is
+	/// called on the play thread right after an underrun has been detected,
+	/// without holding any locks, and is given the updated counters. It
+	/// should return quickly.
+	using underrun_handler_func = std::function<void(stream_statistics const&)>;
+
+	/// Exception type for operations that can't be done while an audio
+	/// stream is playing
+	struct stream_is_playing_exception : exception {};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_STREAM_STATISTICS_HPP
@@ -0,0 +1,182 @@
+#ifndef IG_CHIRP_STREAM_TIMELINE_HPP
+#define IG_CHIRP_STREAM_TIMELINE_HPP
+
+#include <chirp/exceptions.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace chirp
+{
+	/// Exception type for events that can't be scheduled because too many
+	/// events are pending
+	struct stream_timeline_exception : exception {};
+
+	/// Function type for scheduled events. The function is called on the
+	/// play thread, before the sample provider is asked for the frame that
+	/// the event was scheduled at, and is given that frame.
+	using timeline_event_func = std::function<void(std::uint64_t frame)>;
+
+	/// The frame timeline of an audio stream.
+	///
+	/// Frame zero is the first frame that is rendered after the stream has
+	/// been started with `play_async()`. The sample provider can be started
+	/// and stopped at exact frames, and events can be scheduled at exact
+	/// frames; sample requests are split at these frames. Scheduling may
+	/// be done from any thread, before or while the stream plays, and the
+	/// play thread never waits for it.
+	///
+	/// Outside of the range from the start frame to the stop frame, the
+	/// sample provider isn't called and the stream plays silence, but it
+	/// keeps playing until it is stopped with `stop()`. The same goes for
+	/// the frames after the sample provider has reported the end of the
+	/// stream.
+	///
+	/// With a render quantum, sample requests aren't split. Events are then
+	/// fired before the quantum that contains their frame, and the frames
+	/// of the quantum outside of the start and stop frames are silenced.
+	class stream_timeline
+	{
+		public:
+			/// Integral type for frame positions
+			using frame_type = std::uint64_t;
+
+			/// Frame position that is never reached
+			static constexpr frame_type never = std::numeric_limits<frame_type>::max();
+
+			/// The largest number of events that can be pending at once
+			static constexpr std::size_t max_events = 64;
+
+			/// Create an empty timeline
+			stream_timeline();
+
+			// Not copy-constructable or copy-assignable
+			stream_timeline( stream_timeline const& ) = delete;
+			stream_timeline& operator=( stream_timeline const& ) = delete;
+
+			/// @returns The number of frames that have been rendered since
+			///          the stream was started. May be called from any
+			///          thread.
+			frame_type position() const {
+				return _position.load( std::memory_order_acquire );
+			}
+
+			/// Let the sample provider start at a frame. Frames before it
+			/// are silent.
+			/// @param frame   The first frame of the sample provider
+			void schedule_start( frame_type frame ) {
+				_start_frame.store( frame, std::memory_order_release );
+			}
+
+			/// Let the sample provider stop at a frame. The frame and all
+			/// frames after it are silent.
+			/// @param frame   The first silent frame, or `never`
+			void schedule_stop( frame_type frame ) {
+				_stop_frame.store( frame, std::memory_order_release );
+			}
+
+			/// @returns The first frame of the sample provider
+			frame_type start_frame() const {
+				return _start_frame.load( std::memory_order_acquire );
+			}
+
+			/// @returns The first silent frame after the sample provider
+			frame_type stop_frame() const {
+				return _stop_frame.load( std::memory_order_acquire );
+			}
+
+			/// @returns The frame where the sample provider reported the end
+			///          of the stream, or `never`
+			frame_type end_frame() const {
+				return _end_frame.load( std::memory_order_acquire );
+			}
+
+			/// Schedule a function to be called on the play thread right
+			/// before a frame is rendered. Events at frames that have
+			/// already been rendered are fired as soon as possible.
+			/// @param frame   The frame
+			/// @param f       The function
+			/// @throws stream_timeline_exception if `max_events` events
+			///         are already pending
+			void schedule_event( frame_type frame, timeline_event_func f );
+
+			//-------------------------------------------------------------
+			// Play thread interface
+			//-------------------------------------------------------------
+
+			/// Start over from frame zero, without an end of the stream.
+			/// Scheduled frames and events are kept. Must not be called
+			/// while frames are being rendered.
+			void rewind();
+
+			/// Fire the events at or before a frame
+			/// @param frame   The frame
+			void fire_events( frame_type frame );
+
+			/// @returns The first frame after a frame where the sample
+			///          provider starts or stops, or an event is scheduled,
+			///          or `never`.
+			frame_type next_boundary( frame_type frame ) const;
+
+			/// @returns `true` if the sample provider plays a frame
+			bool is_active( frame_type frame ) const {
+				return frame >= start_frame() && frame < stop_frame() && frame < end_frame();
+			}
+
+			/// Mark the end of the stream, after which the sample provider
+			/// isn't called anymore
+			/// @param frame   The first frame after the stream
+			void end( frame_type frame ) {
+				if( frame < end_frame() ) {
+					_end_frame.store( frame, std::memory_order_release );
+				}
+			}
+
+			/// Advance the position
+			/// @param frames   The number of frames that have been rendered
+			void advance( frame_type frames ) {
+				_position.store( _position.load( std::memory_order_relaxed ) + frames, std::memory_order_release );
+			}
+
+		private:
+			/// A scheduled event
+			struct event
+			{
+				/// The frame of the event
+				frame_type frame;
+				/// The function to call
+				timeline_event_func func;
+			};
+
+			/// Move newly scheduled events to the sorted events
+			void collect_events();
+
+			/// Number of frames rendered since the start
+			std::atomic<frame_type> _position;
+			/// First frame of the sample provider
+			std::atomic<frame_type> _start_frame;
+			/// First silent frame after the sample provider
+			std::atomic<frame_type> _stop_frame;
+			/// First frame after the end of the stream
+			std::atomic<frame_type> _end_frame;
+			/// Serializes threads that schedule events
+			std::mutex _schedule_mutex;
+			/// Ring of newly scheduled events, handed to the play thread
+			std::array<event, max_events> _incoming;
+			/// Number of events that have been scheduled
+			std::atomic<std::size_t> _incoming_write;
+			/// Number of scheduled events that the play thread has taken
+			std::atomic<std::size_t> _incoming_read;
+			/// Events that the play thread has taken, sorted by frame
+			std::array<event, max_events> _events;
+			/// Number of sorted events
+			std::size_t _event_count;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_STREAM_TIMELINE_HPP
@@ -0,0 +1,325 @@
+#ifndef IG_CHIRP_VOICE_ENGINE_HPP
+#define IG_CHIRP_VOICE_ENGINE_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chirp
+{
+	namespace backend
+	{
+		struct conversion_kernels;
+	}   // namespace backend
+
+	/// Exception type for voice engines without voices, and for voices
+	/// with invalid parameters
+	struct voice_exception : exception {};
+
+	/// The parameters of a voice
+	struct voice_parameters
+	{
+		/// Linear gain
+		float gain = 1.0f;
+		/// Playback rate, where 1.0 plays the samples at the frequency of
+		/// the voice engine. Must be above zero and at most
+		/// `voice_engine::maximum_pitch`.
+		float pitch = 1.0f;
+		/// Position from -1.0, left only, to 1.0, right only, with a
+		/// constant power pan law. Ignored for mono output.
+		float pan = 0.0f;
+		/// Voices with a higher priority can take over the voices of a
+		/// lower priority when all voices are in use
+		int priority = 0;
+	};
+
+	/// Lightweight reference to a voice, which is only valid until the
+	/// voice ends or is stolen
+	struct voice_handle
+	{
+		/// The serial number of the request that played the voice, or
+		/// zero for a handle that doesn't refer to any voice
+		std::uint64_t serial;
+
+		/// @returns `true` if a voice was requested, which may have been
+		///          rejected or ended since
+		explicit operator bool() const {
+			return serial != 0;
+		}
+	};
+
+	/// Counters of a voice engine
+	struct voice_statistics
+	{
+		/// Integral type for the counters
+		using counter_type = std::uint64_t;
+
+		/// Number of voices that have been played
+		counter_type played;
+		/// Number of voices that were ended early to play another voice
+		counter_type stolen;
+		/// Number of voices that weren't played, because all voices had
+		/// a higher priority or too many requests were queued
+		counter_type rejected;
+	};
+
+	/// Sample provider that plays thousands of short mono sounds.
+	///
+	/// Playing a sound takes a voice, which is a slot in arrays that hold
+	/// the source, position, gain, pitch and pan of all voices, rather
+	/// than an audio stream and a function object of its own. The voices
+	/// that play are swept in blocks of frames, and each of them is read
+	/// at its pitch with linear interpolation and panned into the block by
+	/// the vector kernels of the CPU. Voices end by themselves, so sounds
+	/// can be fired and forgotten.
+	///
+	/// The number of voices is fixed, and no memory is allocated while
+	/// sounds are played. When all voices are in use, a sound takes over
+	/// the voice with the lowest priority, and of these the one that has
+	/// played the longest, if its own priority is at least as high.
+	///
+	/// The play thread never waits for a lock. Playing, stopping and
+	/// changing voices queues a request in a ring that the play thread
+	/// applies before each block, so the voices are only changed by the
+	/// play thread. Requests that don't fit into the ring are dropped, and
+	/// sounds that are played then are rejected. The ring holds twice as
+	/// many requests as there are voices, and at least 64.
+	///
+	/// The samples of each sound must stay valid until its voice no longer
+	/// plays. Sounds are played at the frequency of the voice engine,
+	/// scaled by their pitch. The voice engine provides float samples in
+	/// native byte order, with one or two channels, and may be played by a
+	/// stream of an output device or of a mixer. All functions may be
+	/// called from any thread, but samples must only be requested by one
+	/// thread at a time.
+	class voice_engine :
+		public filling_sample_provider
+	{
+		public:
+			/// Integral type for frame counts
+			using frame_count = std::size_t;
+
+			/// The highest pitch
+			static constexpr float maximum_pitch = 16.0f;
+
+			/// Create a voice engine
+			/// @param format   The format of the samples it provides, with
+			///                 float samples in native byte order, and one
+			///                 or two channels
+			/// @param voices   The number of voices
+			/// @throws sample_format_exception if the format isn't
+			///         supported
+			/// @throws voice_exception if there are no voices
+			voice_engine( audio_format const& format, std::size_t voices );
+
+			// Not copy-constructable or copy-assignable
+			voice_engine( voice_engine const& ) = delete;
+			voice_engine& operator=( voice_engine const& ) = delete;
+
+			/// Play a sound, from the next block on. The voice is taken, or
+			/// the sound is rejected, when the request is applied.
+			/// @param samples      The mono samples of the sound, which must
+			///                     stay valid while the voice plays
+			/// @param frames       The number of samples
+			/// @param parameters   The parameters of the voice
+			/// @returns A handle to the voice, or an empty handle if the
+			///          request ring is full
+			/// @throws voice_exception if there are no samples, or the
+			///         pitch is out of range
+			voice_handle play( float const* samples, frame_count frames, voice_parameters const& parameters = voice_parameters{} );
+
+			/// End a voice, from the next block on. Handles of voices that
+			/// have ended are ignored.
+			/// @param voice   The handle of the voice
+			void stop( voice_handle voice );
+
+			/// End all voices
+			void stop_all();
+
+			/// Change the gain of a voice that plays
+			/// @param voice   The handle of the voice
+			/// @param gain    The linear gain
+			void set_gain( voice_handle voice, float gain );
+
+			/// Change the pan position of a voice that plays
+			/// @param voice   The handle of the voice
+			/// @param pan     The position from -1.0 to 1.0
+			void set_pan( voice_handle voice, float pan );
+
+			/// Change the pitch of a voice that plays
+			/// @param voice   The handle of the voice
+			/// @param pitch   The playback rate
+			/// @throws voice_exception if the pitch is out of range
+			void set_pitch( voice_handle voice, float pitch );
+
+			/// @returns `true` if the voice of a handle is still playing,
+			///          or is queued to play
+			bool is_playing( voice_handle voice ) const;
+
+			/// @returns The number of voices that played in the last block
+			std::size_t playing_voices() const {
+				return _playing_voices;
+			}
+
+			/// @returns The number of voices
+			std::size_t voices() const {
+				return _sources.size();
+			}
+
+			/// @returns The counters since the voice engine was created
+			voice_statistics statistics() const;
+
+			/// @returns The format of the provided samples
+			audio_format const& format() const {
+				return _format;
+			}
+
+			/// Apply the queued requests, and mix the voices that play into
+			/// a request. Stops when no voice plays, and leaves the rest
+			/// of the request to be cleared.
+			/// @param play_time   The play time of the request
+			/// @param request     The request, in the format of the voice
+			///                    engine
+			/// @returns The number of frames that were mixed
+			fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override;
+
+		private:
+			/// What a request does
+			enum class command_type : std::uint8_t
+			{
+				play,
+				stop,
+				stop_all,
+				set_gain,
+				set_pan,
+				set_pitch
+			};
+
+			/// A request to the play thread
+			struct command
+			{
+				/// What the request does
+				command_type type;
+				/// The serial number of the voice that the request changes
+				std::uint64_t serial;
+				/// The samples of a sound that is played
+				float const* samples;
+				/// The number of samples of a sound that is played
+				frame_count frames;
+				/// The parameters of a sound that is played
+				voice_parameters parameters;
+				/// The gain, pan position or pitch that is set
+				float value;
+			};
+
+			/// An element of the request ring
+			struct command_cell
+			{
+				/// The position in the ring that the cell can be written
+				/// at, plus one once it has been written
+				std::atomic<std::uint64_t> sequence;
+				/// The request
+				command request;
+			};
+
+			/// Queue a request
+			/// @param request   The request
+			/// @returns The serial number of the request, or zero if the
+			///          ring is full
+			std::uint64_t post( command const& request );
+
+			/// Apply the queued requests. Must only be called by the
+			/// thread that requests samples.
+			void apply_commands();
+
+			/// Take a voice for a sound
+			/// @param serial    The serial number of the request
+			/// @param request   The request
+			void start_voice( std::uint64_t serial, command const& request );
+
+			/// Find the slot of a voice
+			/// @param serial   The serial number of the voice
+			/// @returns The slot, or the number of voices if the voice
+			///          doesn't play
+			std::size_t find( std::uint64_t serial ) const;
+
+			/// Calculate the gains of the channels from the gain and pan
+			/// of a voice
+			/// @param index   The slot of the voice
+			void update_gains( std::size_t index );
+
+			/// Read and pan one voice into a block
+			/// @param index    The slot of the voice
+			/// @param target   The interleaved block
+			/// @param frames   The number of frames of the block
+			void render_voice( std::size_t index, float* target, std::size_t frames );
+
+			/// Throw if a pitch is out of range
+			static float check_pitch( float pitch );
+
+			/// The format of the provided samples
+			audio_format _format;
+			/// The vector kernels
+			backend::conversion_kernels const* _kernels;
+
+			// The state of the voices, one element for each slot, which is
+			// only changed by the play thread
+			/// Samples of each voice
+			std::vector<float const*> _sources;
+			/// Number of samples of each voice
+			std::vector<frame_count> _lengths;
+			/// Read position of each voice
+			std::vector<double> _positions;
+			/// Playback rate of each voice
+			std::vector<float> _pitches;
+			/// Linear gain of each voice
+			std::vector<float> _gains;
+			/// Pan position of each voice
+			std::vector<float> _pans;
+			/// Gain of the left, or only, channel of each voice
+			std::vector<float> _left_gains;
+			/// Gain of the right channel of each voice
+			std::vector<float> _right_gains;
+			/// Priority of each voice
+			std::vector<int> _priorities;
+			/// The serial number of the request that each voice plays,
+			/// which orders the voices by age, or zero if the voice is
+			/// free or stopped
+			std::vector<std::atomic<std::uint64_t>> _serials;
+
+			/// Slots of the voices that play, in no particular order
+			std::vector<std::uint32_t> _playing;
+			/// Slots that are free
+			std::vector<std::uint32_t> _free;
+			/// Scratch buffer for reading a voice
+			std::vector<float> _scratch;
+			/// Number of voices that played in the last block
+			std::atomic<std::size_t> _playing_voices;
+
+			/// The request ring
+			std::vector<command_cell> _commands;
+			/// The slot that each request played its voice in, at the
+			/// position of the request in the ring
+			std::vector<std::atomic<std::uint32_t>> _placements;
+			/// The position of the next request that is queued
+			std::atomic<std::uint64_t> _enqueued;
+			/// The position of the next request that is applied
+			std::atomic<std::uint64_t> _applied;
+
+			// The counters
+			/// Number of voices that have been played
+			std::atomic<voice_statistics::counter_type> _played;
+			/// Number of voices that were taken over
+			std::atomic<voice_statistics::counter_type> _stolen;
+			/// Number of sounds that were rejected
+			std::atomic<voice_statistics::counter_type> _rejected;
+	};
+}   // namespace chirp
+
+#endif   // IG_CHIRP_VOICE_ENGINE_HPP
@@ -0,0 +1,492 @@
+#include "alsa_backend.hpp"
+
+#if defined(CHIRP_WITH_ALSA)
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	/// The longest time the play thread sleeps while streams are playing.
+	/// Streams arm the play thread timer themselves, so this is only a
+	/// safety net.
+	auto const FallbackInterval = std::chrono::milliseconds{100};
+
+	/// The pcm name of the default ALSA device
+	char const* const DefaultPcmName = "default";
+
+	/// Throw an alsa_exception if an ALSA function call failed
+	/// @param result   The return value of an ALSA function
+	/// @returns The return value if it is not an error code
+	template <class T>
+	T check( T result ) {
+		if( result < 0 ) {
+			throw chirp::backend::alsa_exception{};
+		}
+		return result;
+	}
+
+	/// Retrieve a hint from a device name hint, as a string
+	std::string get_hint( void* hint, char const* id ) {
+		std::string result;
+		if( char* value = ::snd_device_name_get_hint( hint, id ) ) {
+			result = value;
+			std::free( value );
+		}
+		return result;
+	}
+
+	/// The ALSA formats of an integer sample layout
+	struct integer_pcm_format
+	{
+		/// Size of each sample, including padding
+		std::uint32_t bytes_per_sample;
+		/// Number of significant bits
+		std::uint32_t bits_per_sample;
+		/// Signed little and big endian formats
+		snd_pcm_format_t signed_le, signed_be;
+		/// Unsigned little and big endian formats
+		snd_pcm_format_t unsigned_le, unsigned_be;
+	};
+
+	/// The integer sample layouts that ALSA supports
+	integer_pcm_format const IntegerPcmFormats[] = {
+		{ 1, 8, SND_PCM_FORMAT_S8, SND_PCM_FORMAT_S8, SND_PCM_FORMAT_U8, SND_PCM_FORMAT_U8 },
+		{ 2, 16, SND_PCM_FORMAT_S16_LE, SND_PCM_FORMAT_S16_BE, SND_PCM_FORMAT_U16_LE, SND_PCM_FORMAT_U16_BE },
+		{ 3, 24, SND_PCM_FORMAT_S24_3LE, SND_PCM_FORMAT_S24_3BE, SND_PCM_FORMAT_U24_3LE, SND_PCM_FORMAT_U24_3BE },
+		{ 4, 24, SND_PCM_FORMAT_S24_LE, SND_PCM_FORMAT_S24_BE, SND_PCM_FORMAT_U24_LE, SND_PCM_FORMAT_U24_BE },
+		{ 4, 32, SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_S32_BE, SND_PCM_FORMAT_U32_LE, SND_PCM_FORMAT_U32_BE }
+	};
+
+	/// Find the ALSA format that corresponds to a sample format
+	/// @returns The format, or `SND_PCM_FORMAT_UNKNOWN` if there is no
+	///          corresponding format
+	snd_pcm_format_t pcm_format( chirp::audio_format const& format ) {
+		bool little_endian = format.bytes_per_sample() == 1 || format.endianness() == chirp::byte_order::little_endian;
+		if( format.type() == chirp::sample_type::floating_point ) {
+			if( format.bytes_per_sample() == 4 ) {
+				return little_endian ? SND_PCM_FORMAT_FLOAT_LE : SND_PCM_FORMAT_FLOAT_BE;
+			}
+			return little_endian ? SND_PCM_FORMAT_FLOAT64_LE : SND_PCM_FORMAT_FLOAT64_BE;
+		}
+		for( auto const& candidate : IntegerPcmFormats ) {
+			if( candidate.bytes_per_sample == format.bytes_per_sample() && candidate.bits_per_sample == format.bits_per_sample() ) {
+				if( format.type() == chirp::sample_type::unsigned_integer ) {
+					return little_endian ? candidate.unsigned_le : candidate.unsigned_be;
+				}
+				return little_endian ? candidate.signed_le : candidate.signed_be;
+			}
+		}
+		return SND_PCM_FORMAT_UNKNOWN;
+	}
+
+	/// Restrict the hardware parameters of a pcm to a format
+	/// @returns A negative error code if the pcm can't play the format
+	int restrict_format( snd_pcm_t* pcm, snd_pcm_hw_params_t* hw_params, chirp::audio_format const& format ) {
+		auto result = ::snd_pcm_hw_params_set_access( pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED );
+		if( result >= 0 ) {
+			result = ::snd_pcm_hw_params_set_format( pcm, hw_params, pcm_format( format ) );
+		}
+		if( result >= 0 ) {
+			result = ::snd_pcm_hw_params_set_channels( pcm, hw_params, format.channels() );
+		}
+		if( result >= 0 ) {
+			result = ::snd_pcm_hw_params_set_rate( pcm, hw_params, format.frequency(), 0 );
+		}
+		return result;
+	}
+
+	/// Pick the frequency of the device buffer. The resampling of the
+	/// plug layer is turned off, so that streams at other frequencies are
+	/// resampled by chirp at the quality of the stream options.
+	/// @returns The requested frequency if the pcm plays it, and otherwise
+	///          the nearest frequency that it plays
+	chirp::audio_format::frequency_type device_frequency( snd_pcm_t* pcm, snd_pcm_hw_params_t* hw_params, chirp::audio_format const& format ) {
+		unsigned int frequency = format.frequency();
+		if( ::snd_pcm_hw_params_set_rate_resample( pcm, hw_params, 0 ) >= 0 &&
+		    ::snd_pcm_hw_params_test_rate( pcm, hw_params, frequency, 0 ) != 0 &&
+		    ::snd_pcm_hw_params_set_rate_near( pcm, hw_params, &frequency, nullptr ) < 0 ) {
+			frequency = format.frequency();
+		}
+		return frequency;
+	}
+
+	/// Pick the format of the device buffer, which is the requested format
+	/// if the pcm plays it, the same samples in native byte order, which
+	/// are swapped without loss, and otherwise a format that the samples
+	/// can be converted to. The frequency is the nearest one that the pcm
+	/// plays.
+	/// @returns The format, or the requested samples if the pcm plays none
+	///          of them
+	chirp::audio_format device_format( snd_pcm_t* pcm, snd_pcm_hw_params_t* hw_params, chirp::audio_format const& format ) {
+		using chirp::sample_type;
+		auto channels = format.channels();
+		auto frequency = device_frequency( pcm, hw_params, format );
+		chirp::audio_format const candidates[] = {
+			{ frequency, format.sample_format() },
+			{ frequency, format.sample_format().in_byte_order( chirp::native_byte_order ) },
+			{ frequency, chirp::sample_format{ sample_type::floating_point, 32, chirp::native_byte_order, channels } },
+			{ frequency, chirp::sample_format{ sample_type::signed_integer, 32, chirp::native_byte_order, channels } },
+			{ frequency, chirp::sample_format{ sample_type::signed_integer, 16, chirp::native_byte_order, channels } }
+		};
+		if( ::snd_pcm_hw_params_set_access( pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED ) >= 0 ) {
+			for( auto const& candidate : candidates ) {
+				auto candidate_format = pcm_format( candidate );
+				if( candidate_format != SND_PCM_FORMAT_UNKNOWN && ::snd_pcm_hw_params_test_format( pcm, hw_params, candidate_format ) == 0 ) {
+					return candidate;
+				}
+			}
+		}
+		return candidates[0];
+	}
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		//-----------------------------------------------------------------
+		// alsa_platform implementation
+		//-----------------------------------------------------------------
+
+		// alsa_platform default constructor
+		alsa_platform::alsa_platform() :
+			_output_devices( get_alsa_output_devices() )
+		{
+		}
+
+		// alsa_platform destructor
+		alsa_platform::~alsa_platform() {
+		}
+
+		// alsa_platform::default_ouput_device()
+		alsa_platform::output_device_ptr alsa_platform::default_output_device() const {
+			auto it = std::find_if( std::begin(_output_devices), std::end(_output_devices),
+				[]( auto const& device_ptr ){
+					return device_ptr->name() == DefaultPcmName;
+				});
+			if( it == std::end(_output_devices) ) {
+				throw alsa_exception{};
+			}
+			return *it;
+		}
+
+		// alsa_platform::get_output_devices()
+		alsa_platform::output_device_collection alsa_platform::get_output_devices() const {
+			return output_device_collection( std::begin(_output_devices), std::end(_output_devices) );
+		}
+
+		// alsa_platform::get_alsa_output_devices()
+		alsa_platform::alsa_output_device_collection alsa_platform::get_alsa_output_devices() const {
+			alsa_output_device_collection result;
+			void** hints = nullptr;
+			check( ::snd_device_name_hint( -1, "pcm", &hints ) );
+			for( void** hint = hints; *hint != nullptr; ++hint ) {
+				// Devices without an IOID hint supports both input and output
+				auto name = get_hint( *hint, "NAME" );
+				auto io = get_hint( *hint, "IOID" );
+				if( !name.empty() && (io.empty() || io == "Output") ) {
+					result.push_back( std::make_shared<alsa_output_device>( name, get_hint( *hint, "DESC" ) ) );
+				}
+			}
+			::snd_device_name_free_hint( hints );
+
+			// The default device can always be opened, even when the
+			// configuration doesn't list it
+			auto has_default = std::any_of( std::begin(result), std::end(result),
+				[]( auto const& device_ptr ){
+					return device_ptr->name() == DefaultPcmName;
+				});
+			if( !has_default ) {
+				result.insert( std::begin(result), std::make_shared<alsa_output_device>( DefaultPcmName, "Default ALSA Output" ) );
+			}
+			return result;
+		}
+
+		//-----------------------------------------------------------------
+		// alsa_output_device implementation
+		//-----------------------------------------------------------------
+
+		// alsa_output_device constructor
+		alsa_output_device::alsa_output_device( std::string const& pcm_name, std::string const& description ) :
+			_pcm_name( pcm_name ),
+			_description( description ),
+			_play_thread( FallbackInterval )
+		{
+		}
+
+		// alsa_output_device::create_audio_stream()
+		std::unique_ptr<audio_stream> alsa_output_device::create_audio_stream( audio_format const& format, stream_options const& options ) {
+			return std::make_unique<alsa_audio_stream>( *this, format, options );
+		}
+
+		// alsa_output_device::supports()
+		bool alsa_output_device::supports( audio_format const& format ) const {
+			if( pcm_format( format ) == SND_PCM_FORMAT_UNKNOWN ) {
+				return false;
+			}
+
+			// Ask the pcm itself, as plugins may convert formats that the
+			// hardware doesn't support
+			snd_pcm_t* ptr = nullptr;
+			if( ::snd_pcm_open( &ptr, _pcm_name.c_str(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK ) < 0 ) {
+				return false;
+			}
+			std::unique_ptr<snd_pcm_t, pcm_close_deleter> pcm{ ptr };
+			snd_pcm_hw_params_t* hw_params = nullptr;
+			snd_pcm_hw_params_alloca( &hw_params );
+			return ::snd_pcm_hw_params_any( ptr, hw_params ) >= 0 && restrict_format( ptr, hw_params, format ) >= 0;
+		}
+
+		// operator==()
+		bool alsa_output_device::operator==(chirp::backend::output_device const& other ) const {
+			auto ptr = dynamic_cast<alsa_output_device const*>(&other);
+			return ptr != nullptr && ptr->_pcm_name == _pcm_name;
+		}
+
+		//-----------------------------------------------------------------
+		// alsa_audio_stream implementation
+		//-----------------------------------------------------------------
+
+		// alsa_audio_stream constructor
+		alsa_audio_stream::alsa_audio_stream( alsa_output_device& device, audio_format const& format, stream_options const& options ) :
+			_device( device ),
+			_format( format ),
+			_buffer_frames( 0 ),
+			_state( audio_stream_state::invalid ),
+			_renderer( format, options ),
+			_scheduler( open_pcm( device.name(), format, options ) )
+		{
+			_renderer.set_device_format( _format );
+		}
+
+		// alsa_audio_stream::open_pcm()
+		ring_buffer_scheduler alsa_audio_stream::open_pcm( std::string const& pcm_name, audio_format const& format, stream_options const& options ) {
+			snd_pcm_t* ptr = nullptr;
+			check( ::snd_pcm_open( &ptr, pcm_name.c_str(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK ) );
+			_pcm = pcm_ptr{ ptr };
+
+			// Hardware parameters, the access mode must be mmap so that the
+			// samples can be written directly into the device buffer
+			snd_pcm_hw_params_t* hw_params = nullptr;
+			snd_pcm_hw_params_alloca( &hw_params );
+			check( ::snd_pcm_hw_params_any( ptr, hw_params ) );
+			_format = device_format( ptr, hw_params, format );
+			if( pcm_format( _format ) == SND_PCM_FORMAT_UNKNOWN ) {
+				throw sample_format_exception{};
+			}
+			check( restrict_format( ptr, hw_params, _format ) );
+			unsigned int buffer_time = static_cast<unsigned int>( std::chrono::duration_cast<std::chrono::microseconds>(options.buffer_duration()).count() );
+			check( ::snd_pcm_hw_params_set_buffer_time_near( ptr, hw_params, &buffer_time, nullptr ) );
+			unsigned int period_time = static_cast<unsigned int>( std::chrono::duration_cast<std::chrono::microseconds>(options.period()).count() );
+			check( ::snd_pcm_hw_params_set_period_time_near( ptr, hw_params, &period_time, nullptr ) );
+			check( ::snd_pcm_hw_params( ptr, hw_params ) );
+			check( ::snd_pcm_hw_params_get_buffer_size( hw_params, &_buffer_frames ) );
+
+			// Software parameters, the pcm is started explicitly once the
+			// first samples have been written to it. The pcm poll descriptors
+			// becomes ready when there is room for another period below the
+			// write-ahead limit.
+			snd_pcm_uframes_t period_frames = 0;
+			check( ::snd_pcm_hw_params_get_period_size( hw_params, &period_frames, nullptr ) );
+			auto bytes_per_frame = _format.bytes_per_frame();
+			ring_buffer_scheduler scheduler{
+				_format,
+				static_cast<ring_buffer_scheduler::byte_count>( _buffer_frames * bytes_per_frame ),
+				ring_buffer_scheduler::bytes_for( _format, options.write_ahead() ),
+				static_cast<ring_buffer_scheduler::byte_count>( period_frames * bytes_per_frame ) };
+			auto limit_frames = static_cast<snd_pcm_uframes_t>( scheduler.write_ahead_bytes() / bytes_per_frame );
+			period_frames = static_cast<snd_pcm_uframes_t>( scheduler.period_bytes() / bytes_per_frame );
+			snd_pcm_sw_params_t* sw_params = nullptr;
+			snd_pcm_sw_params_alloca( &sw_params );
+			check( ::snd_pcm_sw_params_current( ptr, sw_params ) );
+			check( ::snd_pcm_sw_params_set_start_threshold( ptr, sw_params, _buffer_frames + 1 ) );
+			check( ::snd_pcm_sw_params_set_avail_min( ptr, sw_params, _buffer_frames - limit_frames + period_frames ) );
+			check( ::snd_pcm_sw_params( ptr, sw_params ) );
+			check( ::snd_pcm_prepare( ptr ) );
+
+			_state = audio_stream_state::ready;
+			return scheduler;
+		}
+
+		// update()
+		void alsa_audio_stream::update( duration_type const& delta ) {
+			// A stream that is stopped from the play thread is updated
+			// until the loop drops its connection
+			if( _state != audio_stream_state::playing ) {
+				return;
+			}
+			auto* pcm = _pcm.get();
+
+			// Recover from underruns and suspends
+			auto avail = ::snd_pcm_avail_update( pcm );
+			if( avail < 0 ) {
+				if( ::snd_pcm_recover( pcm, static_cast<int>(avail), 1 ) < 0 ) {
+					_state = audio_stream_state::invalid;
+					return;
+				}
+				avail = ::snd_pcm_avail_update( pcm );
+				if( avail < 0 ) {
+					return;
+				}
+			}
+
+			// ALSA keeps track of the buffer positions itself, so the read
+			// cursor is derived from the number of frames that are queued
+			auto bytes_per_frame = _format.bytes_per_frame();
+			auto buffer_bytes = _scheduler.buffer_bytes();
+			auto written_ahead_bytes = static_cast<ring_buffer_scheduler::byte_count>(
+				(_buffer_frames - std::min<snd_pcm_uframes_t>( static_cast<snd_pcm_uframes_t>(avail), _buffer_frames )) * bytes_per_frame );
+			auto read_cursor = (_scheduler.write_position() + buffer_bytes - written_ahead_bytes) % buffer_bytes;
+
+			// The mmapped area may end at the end of the ring buffer, in which
+			// case the rest of the frames are written from the start of it.
+			auto frames_to_write = static_cast<snd_pcm_uframes_t>( _scheduler.plan( read_cursor, std::chrono::duration_cast<std::chrono::nanoseconds>( delta ) ).size() / bytes_per_frame );
+			auto now = render_loop::clock_type::now();
+			while( frames_to_write > 0 && _state == audio_stream_state::playing ) {
+				snd_pcm_channel_area_t const* areas = nullptr;
+				snd_pcm_uframes_t offset = 0;
+				snd_pcm_uframes_t frames = frames_to_write;
+				if( ::snd_pcm_mmap_begin( pcm, &areas, &offset, &frames ) < 0 || frames == 0 ) {
+					break;
+				}
+				auto* ptr = static_cast<std::uint8_t*>(areas[0].addr) + (areas[0].first / 8) + offset * (areas[0].step / 8);
+				issue_sample_request( ptr, static_cast<std::uint32_t>( frames * bytes_per_frame ), now );
+				if( ::snd_pcm_mmap_commit( pcm, offset, frames ) < 0 ) {
+					break;
+				}
+				frames_to_write -= frames;
+			}
+
+			// If the sample provider stopped the stream, the pcm was dropped
+			// while it was being written to, so it is dropped again to
+			// discard what was committed after that
+			if( _state != audio_stream_state::playing ) {
+				::snd_pcm_drop( pcm );
+				::snd_pcm_prepare( pcm );
+				return;
+			}
+
+			if( ::snd_pcm_state( pcm ) == SND_PCM_STATE_PREPARED ) {
+				::snd_pcm_start( pcm );
+			}
+
+			// The poll descriptors wakes the play thread up when a period
+			// has been played, the timer is only a backup for plugins that
+			// don't support polling properly.
+			_device.play_thread().wake_at( render_loop::clock_type::now() + _scheduler.refill_delay( read_cursor ) );
+		}
+
+		// issue_sample_request()
+		void alsa_audio_stream::issue_sample_request( void* ptr, std::uint32_t size, render_loop::clock_type::time_point now ) {
+			// The write starts where the samples that are queued ahead of
+			// the read cursor end
+			_renderer.render( ptr, size, now + _scheduler.latency() );
+			_scheduler.commit( size );
+		}
+
+		// play_async()
+		void alsa_audio_stream::play_async( sample_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void alsa_audio_stream::play_async( planar_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void alsa_audio_stream::play_async( sample_provider& provider ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			// A stream that was stopped from the play thread may still
+			// be updated
+			_device.play_thread().wait_for_update();
+			_renderer.set_sample_provider( provider );
+			_renderer.rewind();
+			// The pcm is prepared and empty until the first update
+			_scheduler.reset();
+			_device.play_thread().ensure_running();
+			_connection = _device.play_thread().on_update.connect( [this]( duration_type const& delta ) { update( delta ); } );
+			_state = audio_stream_state::playing;
+
+			// Let the play thread wake up when a period has elapsed
+			std::vector<pollfd> descriptors( static_cast<std::size_t>( std::max( ::snd_pcm_poll_descriptors_count( _pcm.get() ), 0 ) ) );
+			auto count = ::snd_pcm_poll_descriptors( _pcm.get(), descriptors.data(), static_cast<unsigned int>(descriptors.size()) );
+			descriptors.resize( static_cast<std::size_t>( std::max( count, 0 ) ) );
+			_device.play_thread().add_poll_descriptors( this, descriptors );
+			_device.play_thread().notify();
+		}
+
+		// stop()
+		void alsa_audio_stream::stop() {
+			// The play thread holds the lock of the update signal, which
+			// play_async() takes while holding ours, so it doesn't take
+			// ours. The signal lock keeps it from racing play_async().
+			std::unique_lock<std::mutex> lock{_mutex, std::defer_lock};
+			if( !_device.play_thread().on_loop_thread() ) {
+				lock.lock();
+			}
+			auto state = audio_stream_state::playing;
+			auto stopped = _state.compare_exchange_strong( state, audio_stream_state::ready );
+			// A stream that failed while playing is still connected
+			if( stopped || state == audio_stream_state::invalid ) {
+				_device.play_thread().disconnect( _connection.release() );
+				_device.play_thread().remove_poll_descriptors( this );
+			}
+			if( stopped ) {
+				::snd_pcm_drop( _pcm.get() );
+				::snd_pcm_prepare( _pcm.get() );
+			}
+			else {
+				// The stream may have been stopped from the play thread,
+				// which may still be updating it
+				_device.play_thread().wait_for_update();
+			}
+		}
+
+		// state()
+		audio_stream_state alsa_audio_stream::state() const {
+			return _state;
+		}
+
+		// configuration()
+		stream_configuration alsa_audio_stream::configuration() const {
+			return _scheduler.configuration();
+		}
+
+		// statistics()
+		stream_statistics alsa_audio_stream::statistics() const {
+			return _scheduler.statistics();
+		}
+
+		// set_underrun_handler()
+		void alsa_audio_stream::set_underrun_handler( underrun_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_scheduler.set_underrun_handler( std::move(f) );
+		}
+
+		// callback_timing()
+		callback_statistics alsa_audio_stream::callback_timing() const {
+			return _renderer.statistics();
+		}
+
+		// set_budget_handler()
+		void alsa_audio_stream::set_budget_handler( float fraction, budget_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_renderer.set_budget_handler( fraction, std::move(f) );
+		}
+
+		// timeline()
+		stream_timeline& alsa_audio_stream::timeline() {
+			return _renderer.timeline();
+		}
+
+		// latency()
+		std::chrono::nanoseconds alsa_audio_stream::latency() const {
+			return _scheduler.latency();
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_ALSA)
@@ -0,0 +1,250 @@
+#ifndef IG_CHIRP_SRC_ALSA_BACKEND_HPP
+#define IG_CHIRP_SRC_ALSA_BACKEND_HPP
+
+#include <chirp/static_config.hpp>
+
+#if defined(CHIRP_WITH_ALSA)
+
+#include <chirp/backend.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_request.hpp>
+#include <nod/nod.hpp>
+
+#include "../engine/render_loop.hpp"
+#include "../engine/ring_buffer_scheduler.hpp"
+#include "../engine/stream_renderer.hpp"
+
+#include <alsa/asoundlib.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace chirp
+{
+	namespace backend
+	{
+		// Exceptions
+
+		/// Root exceptions for all exceptional events within the ALSA
+		/// backend.
+		struct alsa_exception :
+			chirp::backend_exception
+		{};
+
+		/// Custom deleter used in conjunction with smart pointers to close
+		/// ALSA pcm handles.
+		struct pcm_close_deleter
+		{
+			void operator()( snd_pcm_t* ptr ) const {
+				if( ptr ) {
+					::snd_pcm_close( ptr );
+				}
+			}
+		};
+
+		/// Audio device implementation for the ALSA backend
+		class alsa_output_device :
+			public backend::output_device
+		{
+			public:
+				/// Parameterized constructor
+				/// @param pcm_name      The ALSA pcm name of the device, which is
+				///                      used when opening the device.
+				/// @param description   Human readable description of the device
+				alsa_output_device( std::string const& pcm_name, std::string const& description );
+
+				/// @returns The device name, which is the ALSA pcm name
+				std::string name() const override {
+					return _pcm_name;
+				}
+
+				/// @returns Human readable description of the device
+				std::string const& description() const {
+					return _description;
+				}
+
+				/// Create a new audio stream instance with a given format.
+				/// If the pcm doesn't play the format, the samples are
+				/// swapped to the native byte order, or converted to float,
+				/// 32 bit or 16 bit samples.
+				/// @throws sample_format_exception if the pcm plays none of
+				///                                 these formats
+				/// @throws alsa_exception if the pcm can't be configured
+				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format, stream_options const& options ) override;
+
+				/// Check if the pcm can play a format, by opening it. A pcm
+				/// that is in use by another application may report that
+				/// it can't.
+				/// @returns `true` if the pcm accepts the format
+				bool supports( audio_format const& format ) const override;
+
+				/// Check for equality
+				bool operator==(output_device const& other) const override;
+
+				/// @returns The play thread of the device
+				render_loop& play_thread() {
+					return _play_thread;
+				}
+
+			private:
+				/// The ALSA pcm name
+				std::string _pcm_name;
+				/// The device description
+				std::string _description;
+				/// Play thread
+				render_loop _play_thread;
+		};
+
+		/// Audio stream implementation for the ALSA backend.
+		///
+		/// The pcm is opened in mmap access mode, so that sample requests
+		/// point directly into the ring buffer of the device.
+		class alsa_audio_stream :
+			public backend::audio_stream
+		{
+			public:
+				/// Create an ALSA audio stream instance.
+				/// @param device   The ALSA audio device that is to
+				///                 play the audio stream.
+				/// @param format    The requested format of the audio stream
+				/// @param options   The requested buffer configuration
+				/// @throws alsa_exception if the audio stream cannot
+				///         be created.
+				alsa_audio_stream( alsa_output_device& device, audio_format const& format, stream_options const& options );
+
+				/// Destroy the audio stream.
+				~alsa_audio_stream() {
+					stop();
+				}
+
+				/// @returns the state of the audio stream
+				audio_stream_state state() const override;
+
+				/// Start playing the audio stream asyncronously
+				void play_async( sample_provider_func f ) override;
+
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				void play_async( sample_provider& provider ) override;
+
+				/// Start playing the audio stream with a planar provider function
+				/// @param f   The function
+				void play_async( planar_provider_func f ) override;
+
+				/// Stop playing the audio stream if it is playing
+				void stop() override;
+
+				/// @returns The buffer configuration that the stream uses
+				stream_configuration configuration() const override;
+
+				/// @returns The underrun counters of the stream
+				stream_statistics statistics() const override;
+
+				/// Set the function that is called when an underrun is detected
+				void set_underrun_handler( underrun_handler_func f ) override;
+
+				/// @returns The timing of the sample provider
+				callback_statistics callback_timing() const override;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget
+				void set_budget_handler( float fraction, budget_handler_func f ) override;
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() override;
+
+				/// @returns The time until a frame that is rendered now is
+				///          played
+				std::chrono::nanoseconds latency() const override;
+
+				/// Update function that will be called by the play thread
+				/// at each update tick while the audio stream is playing.
+				/// This function is responsible for requesting new samples
+				/// to send to the device.
+				/// @param delta   The time duration since the last time the
+				///                update function was called for this audio
+				///                stream instance.
+				void update( duration_type const& delta );
+
+			private:
+				/// Unique pointer type to the ALSA pcm handle
+				using pcm_ptr = std::unique_ptr<snd_pcm_t, pcm_close_deleter>;
+
+				/// Open and configure the pcm of the device
+				/// @param pcm_name   The ALSA pcm name of the device
+				/// @param format     The requested format of the audio stream
+				/// @param options    The requested buffer configuration, which
+				///                   is adjusted to what the device supports.
+				/// @returns The scheduler for writing into the device buffer
+				/// @throws alsa_exception is throw if the pcm cannot be opened,
+				///         or can't be configured in mmap access mode.
+				/// @throws sample_format_exception if the pcm plays no format
+				///         that the samples can be converted to
+				ring_buffer_scheduler open_pcm( std::string const& pcm_name, audio_format const& format, stream_options const& options );
+
+				/// Create a sample request and call the current sample provider
+				/// @param ptr    Pointer into the mmapped device buffer where
+				///               samples should be written.
+				/// @param size   The number of bytes of the memory buffer
+				///               that should be filled with samples.
+				/// @param now    The current time, from which the
+				///               presentation time is derived.
+				void issue_sample_request( void* ptr, std::uint32_t size, render_loop::clock_type::time_point now );
+
+				/// Device reference
+				alsa_output_device& _device;
+				/// Audio format of the device buffer, which may differ from
+				/// the format of the stream
+				audio_format _format;
+				/// The pcm handle
+				pcm_ptr _pcm;
+				/// The size of the device buffer, in frames
+				snd_pcm_uframes_t _buffer_frames;
+				/// Current audio state
+				std::atomic<audio_stream_state> _state;
+				/// Connection to the device update callback
+				nod::scoped_connection _connection;
+				/// Mutex for syncronizing the internal state
+				std::mutex _mutex;
+				/// Issues sample requests to the sample provider
+				stream_renderer _renderer;
+				/// Scheduler for writing ahead of the device
+				ring_buffer_scheduler _scheduler;
+		};
+
+		/// Implementation of the ALSA platform
+		class alsa_platform :
+			public backend::platform
+		{
+			public:
+				// typedefs
+				using alsa_output_device_ptr = std::shared_ptr<alsa_output_device>;
+				using alsa_output_device_collection = std::vector<alsa_output_device_ptr>;
+
+				/// Default constructor
+				alsa_platform();
+				/// Destructor
+				~alsa_platform();
+
+				/// Create an instance of the default outout device
+				output_device_ptr default_output_device() const override;
+
+				/// @returns collection of output devices
+				output_device_collection get_output_devices() const override;
+
+			private:
+				/// Retrieve a collection of all available output devices
+				/// @returns Collection of output devices
+				alsa_output_device_collection get_alsa_output_devices() const;
+
+				/// Collection with all available output devices
+				alsa_output_device_collection _output_devices;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_ALSA)
+#endif   // IG_CHIRP_SRC_ALSA_BACKEND_HPP
@@ -3,6 +3,16 @@
 
 // backend implementations
 #include "directsound/directsound_backend.hpp"
+#include "alsa/alsa_backend.hpp"
+#include "null/null_backend.hpp"
+#include "file_render/file_render_backend.hpp"
+
+namespace
+{
+	/// The file that the file render backend renders to, when it is
+	/// requested by its backend identity
+	char const* const DefaultRenderPath = "chirp.wav";
+}   // anonymous namespace
 
 namespace chirp
 {
@@ -22,18 +32,44 @@ namespace chirp
 				case backend_identity::directsound:
 					return std::make_unique<backend::directsound_platform>();
 #endif
+#if defined(CHIRP_WITH_ALSA)
+				case backend_identity::alsa:
+					return std::make_unique<backend::alsa_platform>();
+#endif
+#if defined(CHIRP_WITH_NULL)
+				case backend_identity::null:
+					return std::make_unique<backend::null_platform>();
+#endif
+#if defined(CHIRP_WITH_FILE_RENDER)
+				case backend_identity::file_render:
+					return create_file_render_platform( DefaultRenderPath );
+#endif
 
 				default:
 					throw unknown_backend_exception{};
 			};
 		}
 
+		// create_file_render_platform()
+		std::unique_ptr<platform> factory::create_file_render_platform( std::string const& path, std::chrono::nanoseconds length ) const {
+#if defined(CHIRP_WITH_FILE_RENDER)
+			return std::make_unique<backend::file_render_platform>( path, length );
+#else
+			static_cast<void>(path);
+			static_cast<void>(length);
+			throw unknown_backend_exception{};
+#endif
+		}
 
 
 		// default_backend()
 		backend_identity default_backend() {
 #if defined(CHIRP_WITH_DIRECTSOUND)
 			return backend_identity::directsound;
+#elif defined(CHIRP_WITH_ALSA)
+			return backend_identity::alsa;
+#elif defined(CHIRP_WITH_NULL)
+			return backend_identity::null;
 #else
 			throw no_default_backend{};
 #endif
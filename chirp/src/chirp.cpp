@@ -10,6 +10,16 @@ namespace chirp
 	sample_format const sixteen_bits_big_endian_mono = { 16, byte_order::big_endian, 1 };
 	sample_format const sixteen_bits_little_endian_stereo = { 16, byte_order::little_endian, 2 };
 	sample_format const sixteen_bits_big_endian_stereo = { 16, byte_order::big_endian, 2 };
+	sample_format const twenty_four_bits_little_endian_mono = { 24, byte_order::little_endian, 1 };
+	sample_format const twenty_four_bits_little_endian_stereo = { 24, byte_order::little_endian, 2 };
+	sample_format const twenty_four_in_thirty_two_bits_little_endian_mono = { sample_type::signed_integer, 24, 32, byte_order::little_endian, 1 };
+	sample_format const twenty_four_in_thirty_two_bits_little_endian_stereo = { sample_type::signed_integer, 24, 32, byte_order::little_endian, 2 };
+	sample_format const thirty_two_bits_little_endian_mono = { 32, byte_order::little_endian, 1 };
+	sample_format const thirty_two_bits_little_endian_stereo = { 32, byte_order::little_endian, 2 };
+	sample_format const float32_mono = { sample_type::floating_point, 32, native_byte_order, 1 };
+	sample_format const float32_stereo = { sample_type::floating_point, 32, native_byte_order, 2 };
+	sample_format const float64_mono = { sample_type::floating_point, 64, native_byte_order, 1 };
+	sample_format const float64_stereo = { sample_type::floating_point, 64, native_byte_order, 2 };
 
 
 	// constructor
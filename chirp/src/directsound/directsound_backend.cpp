@@ -4,6 +4,7 @@
 
 #define NOMINMAX
 #include <Windows.h>
+#include <mmreg.h>
 #include <algorithm>
 #include <mutex>
 
@@ -25,10 +26,46 @@ namespace
 	}
 
 
-	// TEMPORARY CONSTANTS, these will get moved to some form of parameters
-	auto const BufferSize_seconds = std::chrono::seconds{2};
-	auto const UpdateInterval = std::chrono::milliseconds{10};
-	auto const WriteAheadLimit = std::chrono::milliseconds{500};
+	/// The longest time the play thread sleeps while streams are playing.
+	/// Streams arm the play thread timer themselves, so this is only a
+	/// safety net.
+	auto const FallbackInterval = std::chrono::milliseconds{100};
+
+	/// Sub-formats of extensible wave formats. They are defined here so
+	/// that there is no need to link with a library of GUIDs.
+	GUID const SubtypePcm = { 0x00000001, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+	GUID const SubtypeIeeeFloat = { 0x00000003, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+
+	/// Check if a format has a wave format. Wave formats are little
+	/// endian. Integer samples are unsigned if they are eight bits and
+	/// signed if they are wider. Windows wants padded samples in the most
+	/// significant bits of their container, while chirp keeps them in the
+	/// least significant bits, so padded samples can't be played.
+	bool has_wave_format( chirp::audio_format const& format ) {
+		if( format.bytes_per_sample() > 1 && format.endianness() != chirp::byte_order::little_endian ) {
+			return false;
+		}
+		switch( format.type() ) {
+			case chirp::sample_type::floating_point:
+				return true;
+			case chirp::sample_type::unsigned_integer:
+				return format.bits_per_sample() == 8;
+			case chirp::sample_type::signed_integer:
+				return format.bits_per_sample() > 8 && format.bits_per_sample() == format.bytes_per_sample() * 8;
+		}
+		return false;
+	}
+
+	/// Pick the format of the sound buffer, which is the requested format
+	/// if there is a wave format for it, the same samples in little endian
+	/// if there is one for those, and float samples otherwise
+	chirp::audio_format device_format( chirp::audio_format const& format ) {
+		chirp::audio_format little_endian{ format.frequency(), format.sample_format().in_byte_order( chirp::byte_order::little_endian ) };
+		if( has_wave_format( little_endian ) ) {
+			return little_endian;
+		}
+		return { format.frequency(), chirp::sample_format{ chirp::sample_type::floating_point, 32, chirp::byte_order::little_endian, format.channels() } };
+	}
 
 }   // anonymous namespace
 
@@ -80,15 +117,28 @@ namespace chirp
 		// directsound_output_device implementation
 		//-----------------------------------------------------------------
 
+		// directsound_output_device constructor
+		directsound_output_device::directsound_output_device( GUID guid, std::string const& name ) :
+			_guid( guid ),
+			_name( name ),
+			_play_thread( FallbackInterval )
+		{
+		}
+
 		// directsound_output_device::create_audio_stream()
-		std::unique_ptr<audio_stream> directsound_output_device::create_audio_stream( audio_format const& format ) {
+		std::unique_ptr<audio_stream> directsound_output_device::create_audio_stream( audio_format const& format, stream_options const& options ) {
 			if( !_dsi ) {
 				_dsi = directsound_instance{ _guid };
 				if( FAILED(_dsi.ptr()->SetCooperativeLevel( ::GetDesktopWindow(), DSSCL_NORMAL)) ) {
 					throw directsound_exception{};
 				}
 			}
-			return std::make_unique<directsound_audio_stream>( *this, format );
+			return std::make_unique<directsound_audio_stream>( *this, format, options );
+		}
+
+		// directsound_output_device::supports()
+		bool directsound_output_device::supports( audio_format const& format ) const {
+			return has_wave_format( format );
 		}
 
 		// operator==()
@@ -97,47 +147,45 @@ namespace chirp
 			return ptr != nullptr && ptr->_guid == _guid;
 		}
 
-		// ensure_play_thread_is_running()
-		void directsound_output_device::ensure_play_thread_is_running() {
-			if( _play_thread.joinable() ) {
-				return;
-			}
-
-			// start the play thread
-			_abort_play_thread = false;
-			_play_thread = std::thread{
-				[this]() {
-					auto last_update = std::chrono::high_resolution_clock::now();
-					while( !_abort_play_thread ) {
-						std::this_thread::sleep_for( UpdateInterval );
-						auto now = std::chrono::high_resolution_clock::now();
-						this->on_update( std::chrono::duration_cast<chirp::duration_type>(now - last_update) );
-						last_update = now;
-					}
-				}
-			};
-		}
-
 		//-----------------------------------------------------------------
 		// directsound_audio_stream implementation
 		//-----------------------------------------------------------------
 
+		// directsound_audio_stream constructor
+		directsound_audio_stream::directsound_audio_stream(directsound_output_device& device, audio_format const& format, stream_options const& options) :
+			_device(device),
+			_format(device_format( format )),
+			_state(audio_stream_state::invalid),
+			_scheduler( create_buffer( _device.directsound(), _format, options ) ),
+			_renderer( format, options )
+		{
+			_renderer.set_device_format( _format );
+		}
+
 		// directsound_audio_stream::create_buffer()
-		void directsound_audio_stream::create_buffer(directsound_instance& instance, audio_format const& format) {
-			WAVEFORMATEX waveFormat;
-			waveFormat.wFormatTag = WAVE_FORMAT_PCM;
+		ring_buffer_scheduler directsound_audio_stream::create_buffer(directsound_instance& instance, audio_format const& format, stream_options const& options) {
+
+			// Plain wave formats only describe integer samples of up to 16
+			// bits in up to two channels, everything else is extensible
+			WAVEFORMATEXTENSIBLE extensibleFormat;
+			WAVEFORMATEX& waveFormat = extensibleFormat.Format;
+			auto extensible = format.type() == sample_type::floating_point || format.bits_per_sample() > 16 || format.channels() > 2;
+			waveFormat.wFormatTag = extensible ? WAVE_FORMAT_EXTENSIBLE : WAVE_FORMAT_PCM;
 			waveFormat.nChannels = format.channels();
 			waveFormat.nSamplesPerSec = format.frequency();
 			waveFormat.nAvgBytesPerSec = format.bytes_per_second();
 			waveFormat.nBlockAlign = static_cast<WORD>(format.bytes_per_frame());
-			waveFormat.wBitsPerSample = format.bits_per_sample();
-			waveFormat.cbSize = 0;
+			waveFormat.wBitsPerSample = static_cast<WORD>(format.bytes_per_sample() * 8);
+			waveFormat.cbSize = static_cast<WORD>( extensible ? sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX) : 0 );
+			extensibleFormat.Samples.wValidBitsPerSample = format.bits_per_sample();
+			extensibleFormat.dwChannelMask = 0;
+			extensibleFormat.SubFormat = format.type() == sample_type::floating_point ? SubtypeIeeeFloat : SubtypePcm;
 
 			DSBUFFERDESC bufferDesc;
 			bufferDesc.dwSize = sizeof(DSBUFFERDESC);
 			bufferDesc.dwFlags = DSBCAPS_GLOBALFOCUS | DSBCAPS_GETCURRENTPOSITION2;
 			bufferDesc.dwReserved = 0;
-			bufferDesc.dwBufferBytes = static_cast<DWORD>( BufferSize_seconds.count() * format.bytes_per_second() );
+			bufferDesc.dwBufferBytes = ring_buffer_scheduler::bytes_for( format, options.buffer_duration() );
 			bufferDesc.guid3DAlgorithm = DS3DALG_DEFAULT;
 			bufferDesc.lpwfxFormat = &waveFormat;
 			LPDIRECTSOUNDBUFFER ptr = nullptr;
@@ -149,6 +197,8 @@ namespace chirp
 
 			clear_entire_buffer();
 			_state = audio_stream_state::ready;
+
+			return ring_buffer_scheduler{ format, options };
 		}
 
 		// directsound_audio_stream::clear_entire_buffer()
@@ -189,70 +239,74 @@ namespace chirp
 
 		// update()
 		void directsound_audio_stream::update( duration_type const& delta ) {
-			delta;
-
-			auto limit_duration_ms = static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(WriteAheadLimit).count());
-			auto limit_byte_count = static_cast<DWORD>((_format.bytes_per_second() * limit_duration_ms) / std::milli{}.den);
-			auto buffer_bytes = static_cast<DWORD>(BufferSize_seconds.count()*_format.bytes_per_second());
-
+			// A stream that is stopped from the play thread is updated
+			// until the loop drops its connection
+			if( _state != audio_stream_state::playing ) {
+				return;
+			}
 			restore_lost_buffer();
 
 			DWORD read_cursor = 0;
 			DWORD write_cursor = 0;
 			if( FAILED(_buffer->GetCurrentPosition(&read_cursor, &write_cursor) ) ) {
 				stop();
+				return;
 			}
-			else {
-				// We want to write data to the buffer, from the last write position
-				// (making sure we are beyond the write cursor of the buffer)
-				// and to the play cursor (wrapping around), but we also want to
-				// respect the write-ahead limitation.
-
-				// Let's check if we need to wait until we can write more data to the buffer
-				DWORD written_ahead_bytes = (_current_write_position >= read_cursor) ? (_current_write_position - read_cursor) : (buffer_bytes - read_cursor + _current_write_position);
-				if( written_ahead_bytes >= limit_byte_count ) {
-					return;
-				}
-
-				DWORD from = _current_write_position; //std::max<DWORD>( write_cursor, _current_write_position );
-				DWORD unsafe_bytes = (read_cursor <= write_cursor) ? (write_cursor - read_cursor) : (buffer_bytes - read_cursor + write_cursor);
-				DWORD byte_count =
-					std::min<DWORD>(
-						buffer_bytes - unsafe_bytes,
-						limit_byte_count
-					);
 
+			auto schedule = _scheduler.plan( read_cursor, write_cursor, std::chrono::duration_cast<std::chrono::nanoseconds>( delta ) );
+			if( schedule.count > 0 ) {
 				void* ptr1 = nullptr;
 				void* ptr2 = nullptr;
 				DWORD size1 = 0;
 				DWORD size2 = 0;
-				if( !FAILED(_buffer->Lock( from, byte_count, &ptr1, &size1, &ptr2, &size2, 0 )) ) {
-					issue_sample_request( ptr1, size1, buffer_bytes );
-					if( ptr2 != nullptr ) {
-						issue_sample_request( ptr2, size2, buffer_bytes );
+				if( !FAILED(_buffer->Lock( schedule.regions[0].offset, schedule.size(), &ptr1, &size1, &ptr2, &size2, 0 )) ) {
+					auto now = render_loop::clock_type::now();
+					issue_sample_request( ptr1, size1, now );
+					if( ptr2 != nullptr && _state == audio_stream_state::playing ) {
+						issue_sample_request( ptr2, size2, now );
 					}
 					_buffer->Unlock(ptr1, size1, ptr2, size2);
 				}
 			}
+
+			// Wake up again when there is room for another period
+			_device.play_thread().wake_at( render_loop::clock_type::now() + _scheduler.refill_delay( read_cursor ) );
 		}
 
 		// issue_sample_request()
-		void directsound_audio_stream::issue_sample_request( void* ptr, std::uint32_t size, std::uint32_t buffer_bytes ) {
-			std::memset( ptr, 0, size );
-			_sample_provider( _play_duration, sample_request{ptr, size, _format} );
-			_play_duration += std::chrono::microseconds( (std::micro::den * size) / _format.bytes_per_second() );
-			_current_write_position = _current_write_position + size;
-			if( _current_write_position >= buffer_bytes ) {
-				_current_write_position -= buffer_bytes;
-			}
+		void directsound_audio_stream::issue_sample_request( void* ptr, std::uint32_t size, render_loop::clock_type::time_point now ) {
+			// The write starts where the samples that are queued ahead of
+			// the read cursor end
+			_renderer.render( ptr, size, now + _scheduler.latency() );
+			_scheduler.commit( size );
 		}
 
 		// play_async()
 		void directsound_audio_stream::play_async( sample_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void directsound_audio_stream::play_async( planar_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void directsound_audio_stream::play_async( sample_provider& provider ) {
 			std::unique_lock<std::mutex> lock{_mutex};
-			_sample_provider = f;
-			_device.ensure_play_thread_is_running();
-			_connection = _device.on_update.connect( std::bind(&directsound_audio_stream::update, this, std::placeholders::_1) );
+			// A stream that was stopped from the play thread may still
+			// be updated
+			_device.play_thread().wait_for_update();
+			_renderer.set_sample_provider( provider );
+			_renderer.rewind();
+			// Stopping a buffer keeps its play position, so it is moved back
+			// to the start, where the scheduler begins writing, and the
+			// samples of the previous run are cleared
+			_scheduler.reset();
+			_buffer->SetCurrentPosition( 0 );
+			clear_entire_buffer();
+			_device.play_thread().ensure_running();
+			_connection = _device.play_thread().on_update.connect( [this]( duration_type const& delta ) { update( delta ); } );
 			auto hr = _buffer->Play(0, 0, DSBPLAY_LOOPING );
 			if( FAILED(hr) ) {
 				_buffer->Stop();
@@ -261,16 +315,28 @@ namespace chirp
 			}
 			else {
 				_state = audio_stream_state::playing;
+				_device.play_thread().notify();
 			}
 		}
 
 		// stop()
 		void directsound_audio_stream::stop() {
-			std::unique_lock<std::mutex> lock{_mutex};
-			if( _state == audio_stream_state::playing ) {
+			// The play thread holds the lock of the update signal, which
+			// play_async() takes while holding ours, so it doesn't take
+			// ours. The signal lock keeps it from racing play_async().
+			std::unique_lock<std::mutex> lock{_mutex, std::defer_lock};
+			if( !_device.play_thread().on_loop_thread() ) {
+				lock.lock();
+			}
+			auto state = audio_stream_state::playing;
+			if( _state.compare_exchange_strong( state, audio_stream_state::ready ) ) {
 				_buffer->Stop();
-				_connection.disconnect();
-				_state = audio_stream_state::ready;
+				_device.play_thread().disconnect( _connection.release() );
+			}
+			else {
+				// The stream may have been stopped from the play thread,
+				// which may still be updating it
+				_device.play_thread().wait_for_update();
 			}
 		}
 
@@ -288,6 +354,43 @@ namespace chirp
 			}
 			return _state;
 		}
+
+		// configuration()
+		stream_configuration directsound_audio_stream::configuration() const {
+			return _scheduler.configuration();
+		}
+
+		// statistics()
+		stream_statistics directsound_audio_stream::statistics() const {
+			return _scheduler.statistics();
+		}
+
+		// set_underrun_handler()
+		void directsound_audio_stream::set_underrun_handler( underrun_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_scheduler.set_underrun_handler( std::move(f) );
+		}
+
+		// callback_timing()
+		callback_statistics directsound_audio_stream::callback_timing() const {
+			return _renderer.statistics();
+		}
+
+		// set_budget_handler()
+		void directsound_audio_stream::set_budget_handler( float fraction, budget_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_renderer.set_budget_handler( fraction, std::move(f) );
+		}
+
+		// timeline()
+		stream_timeline& directsound_audio_stream::timeline() {
+			return _renderer.timeline();
+		}
+
+		// latency()
+		std::chrono::nanoseconds directsound_audio_stream::latency() const {
+			return _scheduler.latency();
+		}
 	}   // namespace backend
 }   // namespace chirp
 
@@ -10,6 +10,10 @@
 #include <chirp/sample_request.hpp>
 #include <nod/nod.hpp>
 
+#include "../engine/render_loop.hpp"
+#include "../engine/ring_buffer_scheduler.hpp"
+#include "../engine/stream_renderer.hpp"
+
 #include <dsound.h>
 #include <vector>
 #include <string>
@@ -136,19 +140,7 @@ namespace chirp
 				/// Parameterized constructor
 				/// @param guid   The guid of the device
 				/// @param name   The name of the device
-				directsound_output_device( GUID guid, std::string const& name ) :
-					_guid( guid ),
-					_name( name ),
-					_abort_play_thread( false )
-				{}
-
-				/// Destructor
-				~directsound_output_device() {
-					_abort_play_thread = true;
-					if( _play_thread.joinable() ) {
-						_play_thread.join();
-					}
-				}
+				directsound_output_device( GUID guid, std::string const& name );
 
 				/// @returns The device guid
 				GUID guid() const {
@@ -161,7 +153,13 @@ namespace chirp
 				}
 
 				/// Create a new audio stream instance with a given format.
-				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format ) override;
+				/// Big endian samples are swapped to little endian, and
+				/// samples without a wave format are converted to float
+				/// samples.
+				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format, stream_options const& options ) override;
+
+				/// @returns `true` if there is a wave format for the samples
+				bool supports( audio_format const& format ) const override;
 
 				/// Check for equality
 				bool operator==(output_device const& other) const override;
@@ -176,12 +174,10 @@ namespace chirp
 					return _dsi;
 				}
 
-				/// Start the device play thread if it is not running.
-				void ensure_play_thread_is_running();
-
-				/// Singal that will be will be invoked each update tick
-				/// of the play thread.
-				nod::signal<void(duration_type const&)> on_update;
+				/// @returns The play thread of the device
+				render_loop& play_thread() {
+					return _play_thread;
+				}
 
 			private:
 				/// The device guid
@@ -191,9 +187,7 @@ namespace chirp
 				/// The direct sound instance
 				directsound_instance _dsi;
 				/// Play thread
-				std::thread _play_thread;
-				/// Atomic flag for aborting the play thread
-				std::atomic<bool> _abort_play_thread;
+				render_loop _play_thread;
 		};
 
 		/// Audio stream implementation for the directsound backend.
@@ -204,18 +198,11 @@ namespace chirp
 				/// Create a directsound audio stream instance.
 				/// @param device   The directsound audio device that is to
 				///                 play the audio stream.
-				/// @param format   The requested format of the audio stream
+				/// @param format    The requested format of the audio stream
+				/// @param options   The requested buffer configuration
 				/// @throws directsound_exception if the audio stream cannot
 				///         be created.
-				directsound_audio_stream(directsound_output_device& device, audio_format const& format) :
-					_device(device),
-					_format(format),
-					_state(audio_stream_state::invalid),
-					_play_duration(0.0),
-					_current_write_position(0)
-				{
-					create_buffer( _device.directsound(), format );
-				}
+				directsound_audio_stream(directsound_output_device& device, audio_format const& format, stream_options const& options);
 
 				/// Destroy the audio stream.
 				~directsound_audio_stream() {
@@ -228,9 +215,40 @@ namespace chirp
 				/// Start playing the audio stream asyncronously
 				void play_async( sample_provider_func f ) override;
 
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				void play_async( sample_provider& provider ) override;
+
+				/// Start playing the audio stream with a planar provider function
+				/// @param f   The function
+				void play_async( planar_provider_func f ) override;
+
 				/// Stop playing the audio stream if it is playing
 				void stop() override;
 
+				/// @returns The buffer configuration that the stream uses
+				stream_configuration configuration() const override;
+
+				/// @returns The underrun counters of the stream
+				stream_statistics statistics() const override;
+
+				/// Set the function that is called when an underrun is detected
+				void set_underrun_handler( underrun_handler_func f ) override;
+
+				/// @returns The timing of the sample provider
+				callback_statistics callback_timing() const override;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget
+				void set_budget_handler( float fraction, budget_handler_func f ) override;
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() override;
+
+				/// @returns The time until a frame that is rendered now is
+				///          played
+				std::chrono::nanoseconds latency() const override;
+
 				/// Update function that will be called by the play thread
 				/// at each update tick while the audio stream is playing.
 				/// This function is responsible for requesting new samples
@@ -246,11 +264,13 @@ namespace chirp
 
 				/// Create the underlying directsound buffer
 				/// @param instance   The directsound device instance
-				/// @param format     The requested format of the sound buffer
-				///                   to be created.
+				/// @param format     The format of the sound buffer to be
+				///                   created, which must have a wave format
+				/// @param options    The requested buffer configuration
+				/// @returns The scheduler for writing into the buffer
 				/// @throws directsound_exception is throw if the buffer cannot
 				///         be created.
-				void create_buffer(directsound_instance& instance, audio_format const& format);
+				ring_buffer_scheduler create_buffer(directsound_instance& instance, audio_format const& format, stream_options const& options);
 
 				/// Fill the entire buffer with zeros
 				/// @throws directsound_exception is thrown if the buffer cannot be locked for writing.
@@ -262,16 +282,17 @@ namespace chirp
 				/// @param size           The number of bytes of the memory
 				///                       buffer that should be filled with
 				///                       samples.
-				/// @param buffer_bytes   The total number of bytes of the 
-				///                       directsound buffer of the request.
-				void issue_sample_request( void* ptr, std::uint32_t size, std::uint32_t buffer_bytes );
+				/// @param now            The current time, from which the
+				///                       presentation time is derived.
+				void issue_sample_request( void* ptr, std::uint32_t size, render_loop::clock_type::time_point now );
 
 				/// Restore the directsound buffer if it has been lost
 				void restore_lost_buffer();
 
 				/// Device reference
 				directsound_output_device& _device;
-				/// Audio format
+				/// Audio format of the sound buffer, which may differ from
+				/// the format of the stream
 				audio_format _format;
 				/// Pointer to the directsound buffer
 				buffer_ptr _buffer;
@@ -279,14 +300,12 @@ namespace chirp
 				std::atomic<audio_stream_state> _state;
 				/// Connection to the device update callback
 				nod::scoped_connection _connection;
-				/// The amount of time that has been played
-				chirp::duration_type _play_duration;
 				/// Mutex for syncronizing the internal state
 				std::mutex _mutex;
-				/// The buffer position where we stopped writing last time
-				std::uint32_t _current_write_position;
-				/// Current callback for handling sample requests
-				sample_provider_func _sample_provider;
+				/// Scheduler for writing ahead of the read cursor of the buffer
+				ring_buffer_scheduler _scheduler;
+				/// Issues sample requests to the sample provider
+				stream_renderer _renderer;
 		};
 
 
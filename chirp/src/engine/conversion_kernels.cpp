@@ -0,0 +1,172 @@
+#include "conversion_kernels.hpp"
+
+#include <algorithm>
+
+#if defined(CHIRP_WITH_X86_KERNELS) && defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace
+{
+	/// Clamp a float sample to the range -1.0 to 1.0
+	inline float clamp( float sample ) {
+		return std::min( 1.0f, std::max( -1.0f, sample ) );
+	}
+
+	// encode_int16()
+	void encode_int16( float const* source, std::int16_t* target, std::size_t count ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			target[i] = static_cast<std::int16_t>( clamp(source[i]) * 32767.0f );
+		}
+	}
+
+	// decode_int16()
+	void decode_int16( std::int16_t const* source, float* target, std::size_t count ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			target[i] = static_cast<float>( source[i] ) * (1.0f / 32767.0f);
+		}
+	}
+
+	// encode_int32()
+	void encode_int32( float const* source, std::int32_t* target, std::size_t count, float scale ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			target[i] = static_cast<std::int32_t>( clamp(source[i]) * scale );
+		}
+	}
+
+	// decode_int32()
+	void decode_int32( std::int32_t const* source, float* target, std::size_t count, float inverse_scale ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			target[i] = static_cast<float>( source[i] ) * inverse_scale;
+		}
+	}
+
+	/// Reverse the byte order of samples of a size
+	/// @tparam Bytes   The number of bytes of each sample
+	template <std::size_t Bytes>
+	void swap( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		for( std::size_t i=0; i<count; ++i ) {
+			std::reverse( ptr + i * Bytes, ptr + (i + 1) * Bytes );
+		}
+	}
+
+	// fir()
+	float fir( float const* samples, float const* phase, float const* next_phase, float fraction, std::size_t taps ) {
+		float sum = 0.0f;
+		for( std::size_t i=0; i<taps; ++i ) {
+			sum += samples[i] * (phase[i] + fraction * (next_phase[i] - phase[i]));
+		}
+		return sum;
+	}
+
+	// mix()
+	void mix( float const* source, float* target, std::size_t count ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			target[i] += source[i];
+		}
+	}
+
+	// clip()
+	void clip( float* samples, std::size_t count ) {
+		for( std::size_t i=0; i<count; ++i ) {
+			samples[i] = clamp( samples[i] );
+		}
+	}
+
+	// interpolate()
+	void interpolate( float const* source, float* target, std::size_t frames, float offset, float step, float gain ) {
+		for( std::size_t i=0; i<frames; ++i ) {
+			auto position = offset + static_cast<float>( i ) * step;
+			auto index = static_cast<std::int32_t>( position );
+			auto fraction = position - static_cast<float>( index );
+			auto a = source[index];
+			target[i] = gain * (a + fraction * (source[index + 1] - a));
+		}
+	}
+
+	// pan()
+	void pan( float const* source, float* target, std::size_t frames, float left, float right ) {
+		for( std::size_t i=0; i<frames; ++i ) {
+			target[2 * i] += source[i] * left;
+			target[2 * i + 1] += source[i] * right;
+		}
+	}
+
+	/// The scalar kernels
+	chirp::backend::conversion_kernels const ScalarKernels = { encode_int16, decode_int16, encode_int32, decode_int32, swap<2>, swap<4>, swap<8>, fir, mix, clip, interpolate, pan };
+
+#if defined(CHIRP_WITH_X86_KERNELS)
+	/// Ask the CPU and the operating system which instruction sets can
+	/// be used
+	chirp::backend::simd_level detect() {
+		using chirp::backend::simd_level;
+#if defined(_MSC_VER)
+		int info[4] = {};
+		__cpuid( info, 0 );
+		auto max_leaf = info[0];
+		__cpuid( info, 1 );
+		auto sse2 = (info[3] & (1 << 26)) != 0;
+		// The operating system has to save the AVX registers, and the
+		// AVX-512 registers for AVX-512
+		auto osxsave = (info[2] & (1 << 27)) != 0;
+		auto xcr0 = osxsave ? _xgetbv( 0 ) : 0;
+		auto avx_state = (xcr0 & 0x06) == 0x06;
+		auto avx512_state = (xcr0 & 0xe6) == 0xe6;
+		auto avx2 = false;
+		auto avx512 = false;
+		if( max_leaf >= 7 ) {
+			__cpuidex( info, 7, 0 );
+			avx2 = avx_state && (info[1] & (1 << 5)) != 0;
+			avx512 = avx512_state && (info[1] & (1 << 16)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		auto sse2 = __builtin_cpu_supports( "sse2" ) != 0;
+		auto avx2 = __builtin_cpu_supports( "avx2" ) != 0;
+		auto avx512 = __builtin_cpu_supports( "avx512f" ) != 0;
+#endif
+		return avx512 ? simd_level::avx512 :
+		       avx2 ? simd_level::avx2 :
+		       sse2 ? simd_level::sse2 :
+		       simd_level::scalar;
+	}
+#endif
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// detected_simd_level()
+		simd_level detected_simd_level() {
+#if defined(CHIRP_WITH_X86_KERNELS)
+			static simd_level const level = detect();
+			return level;
+#else
+			return simd_level::scalar;
+#endif
+		}
+
+		// kernels_for()
+		conversion_kernels const& kernels_for( simd_level level ) {
+			switch( level ) {
+#if defined(CHIRP_WITH_X86_KERNELS)
+				case simd_level::avx512:
+					return avx512_kernels();
+				case simd_level::avx2:
+					return avx2_kernels();
+				case simd_level::sse2:
+					return sse2_kernels();
+#endif
+				default:
+					return ScalarKernels;
+			}
+		}
+
+		// scalar_kernels()
+		conversion_kernels const& scalar_kernels() {
+			return ScalarKernels;
+		}
+	}   // namespace backend
+}   // namespace chirp
@@ -0,0 +1,109 @@
+#ifndef IG_CHIRP_SRC_ENGINE_CONVERSION_KERNELS_HPP
+#define IG_CHIRP_SRC_ENGINE_CONVERSION_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Vector kernels are only available on x86. They are compiled without
+// special compiler flags, each function enables its instruction set with
+// a target attribute, and is only called if the CPU supports it.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#	define CHIRP_WITH_X86_KERNELS
+#	if defined(__GNUC__) || defined(__clang__)
+#		define CHIRP_TARGET(isa) __attribute__((target(isa)))
+#	else
+#		define CHIRP_TARGET(isa)
+#	endif
+#endif
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Instruction set levels of the conversion kernels
+		enum class simd_level {
+			/// Plain C++, which is the reference for the others
+			scalar,
+			/// SSE2, four samples at a time
+			sse2,
+			/// AVX2, eight samples at a time
+			avx2,
+			/// AVX-512, sixteen samples at a time
+			avx512
+		};
+
+		/// Conversions between float samples and integer samples of the
+		/// native byte order, byte order reversal, the filter of the
+		/// resampler, the accumulation of the mixer and the voices of the
+		/// voice engine, which are the hot paths of sample format
+		/// conversion.
+		///
+		/// Float samples are clamped to the range -1.0 to 1.0, scaled and
+		/// truncated towards zero. Integer samples are multiplied by the
+		/// inverse of the scale. The kernels of all levels give exactly the
+		/// same results as the scalar kernels, except for the filter, which
+		/// adds up its products in another order, and the interpolation and
+		/// panning of voices, which may round differently.
+		struct conversion_kernels
+		{
+			/// Convert float samples to 16 bit samples, with a scale of 32767
+			void (*encode_int16)( float const* source, std::int16_t* target, std::size_t count );
+			/// Convert 16 bit samples to float samples
+			void (*decode_int16)( std::int16_t const* source, float* target, std::size_t count );
+			/// Convert float samples to 32 bit samples, which may hold
+			/// fewer significant bits
+			void (*encode_int32)( float const* source, std::int32_t* target, std::size_t count, float scale );
+			/// Convert 32 bit samples to float samples
+			void (*decode_int32)( std::int32_t const* source, float* target, std::size_t count, float inverse_scale );
+			/// Reverse the byte order of 2 byte samples in place
+			void (*swap16)( void* samples, std::size_t count );
+			/// Reverse the byte order of 4 byte samples in place
+			void (*swap32)( void* samples, std::size_t count );
+			/// Reverse the byte order of 8 byte samples in place
+			void (*swap64)( void* samples, std::size_t count );
+			/// Apply a filter with coefficients that are interpolated
+			/// between two phases of a polyphase filter
+			/// @returns The sum of `samples[i] * (phase[i] + fraction *
+			///          (next_phase[i] - phase[i]))`
+			float (*fir)( float const* samples, float const* phase, float const* next_phase, float fraction, std::size_t taps );
+			/// Add float samples to the samples of a mix
+			void (*mix)( float const* source, float* target, std::size_t count );
+			/// Clamp float samples to the range -1.0 to 1.0 in place
+			void (*clip)( float* samples, std::size_t count );
+			/// Read mono samples at fractional positions, interpolating
+			/// linearly between neighbouring samples. Frame `i` is read at
+			/// `offset + i * step`, and the sample after the last position
+			/// must be readable.
+			void (*interpolate)( float const* source, float* target, std::size_t frames, float offset, float step, float gain );
+			/// Add mono samples to interleaved stereo samples, with a gain
+			/// for each channel. The vector kernels may fuse the products
+			/// and sums, and round them differently.
+			void (*pan)( float const* source, float* target, std::size_t frames, float left, float right );
+		};
+
+		/// @returns The highest level that the CPU and the operating system
+		///          support. It is detected once.
+		simd_level detected_simd_level();
+
+		/// @returns The kernels of a level, or of the highest level below it
+		///          that is available on the platform. The level must be
+		///          supported by the CPU.
+		conversion_kernels const& kernels_for( simd_level level );
+
+		/// @returns The scalar reference kernels
+		conversion_kernels const& scalar_kernels();
+
+#if defined(CHIRP_WITH_X86_KERNELS)
+		/// @returns The SSE2 kernels
+		conversion_kernels const& sse2_kernels();
+
+		/// @returns The AVX2 kernels
+		conversion_kernels const& avx2_kernels();
+
+		/// @returns The AVX-512 kernels
+		conversion_kernels const& avx512_kernels();
+#endif
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_CONVERSION_KERNELS_HPP
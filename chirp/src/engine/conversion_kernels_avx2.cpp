@@ -0,0 +1,202 @@
+#include "conversion_kernels.hpp"
+
+#if defined(CHIRP_WITH_X86_KERNELS)
+
+#include <immintrin.h>
+
+namespace
+{
+	// encode_int16()
+	CHIRP_TARGET("avx2")
+	void encode_int16( float const* source, std::int16_t* target, std::size_t count ) {
+		auto const low = _mm256_set1_ps( -1.0f );
+		auto const high = _mm256_set1_ps( 1.0f );
+		auto const scale = _mm256_set1_ps( 32767.0f );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto a = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( source + i ), low ), high );
+			auto b = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( source + i + 8 ), low ), high );
+			// Packing works within 128 bit lanes, so the middle quarters
+			// have to be swapped afterwards
+			auto packed = _mm256_packs_epi32( _mm256_cvttps_epi32( _mm256_mul_ps( a, scale ) ), _mm256_cvttps_epi32( _mm256_mul_ps( b, scale ) ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( target + i ), _mm256_permute4x64_epi64( packed, 0xd8 ) );
+		}
+		chirp::backend::scalar_kernels().encode_int16( source + i, target + i, count - i );
+	}
+
+	// decode_int16()
+	CHIRP_TARGET("avx2")
+	void decode_int16( std::int16_t const* source, float* target, std::size_t count ) {
+		auto const scale = _mm256_set1_ps( 1.0f / 32767.0f );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			auto samples = _mm256_cvtepi16_epi32( _mm_loadu_si128( reinterpret_cast<__m128i const*>( source + i ) ) );
+			_mm256_storeu_ps( target + i, _mm256_mul_ps( _mm256_cvtepi32_ps( samples ), scale ) );
+		}
+		chirp::backend::scalar_kernels().decode_int16( source + i, target + i, count - i );
+	}
+
+	// encode_int32()
+	CHIRP_TARGET("avx2")
+	void encode_int32( float const* source, std::int32_t* target, std::size_t count, float scale ) {
+		auto const low = _mm256_set1_ps( -1.0f );
+		auto const high = _mm256_set1_ps( 1.0f );
+		auto const factor = _mm256_set1_ps( scale );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			auto a = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( source + i ), low ), high );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( target + i ), _mm256_cvttps_epi32( _mm256_mul_ps( a, factor ) ) );
+		}
+		chirp::backend::scalar_kernels().encode_int32( source + i, target + i, count - i, scale );
+	}
+
+	// decode_int32()
+	CHIRP_TARGET("avx2")
+	void decode_int32( std::int32_t const* source, float* target, std::size_t count, float inverse_scale ) {
+		auto const factor = _mm256_set1_ps( inverse_scale );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			auto samples = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( source + i ) );
+			_mm256_storeu_ps( target + i, _mm256_mul_ps( _mm256_cvtepi32_ps( samples ), factor ) );
+		}
+		chirp::backend::scalar_kernels().decode_int32( source + i, target + i, count - i, inverse_scale );
+	}
+
+	/// Reverse the bytes of samples of a size with a byte shuffle
+	/// @param samples   The samples
+	/// @param count     The number of samples
+	/// @param order     The byte order of the first 16 bytes after the
+	///                  shuffle, which is repeated in the upper lane
+	/// @param bytes     The number of bytes of each sample
+	CHIRP_TARGET("avx2")
+	inline std::size_t shuffle( std::uint8_t* samples, std::size_t count, __m128i order, std::size_t bytes ) {
+		auto const mask = _mm256_broadcastsi128_si256( order );
+		auto per_vector = 32 / bytes;
+		std::size_t i = 0;
+		for( ; i+per_vector<=count; i+=per_vector ) {
+			auto* vector = reinterpret_cast<__m256i*>( samples + i * bytes );
+			_mm256_storeu_si256( vector, _mm256_shuffle_epi8( _mm256_loadu_si256( vector ), mask ) );
+		}
+		return i;
+	}
+
+	// swap16()
+	CHIRP_TARGET("avx2")
+	void swap16( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		auto done = shuffle( ptr, count, _mm_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 ), 2 );
+		chirp::backend::scalar_kernels().swap16( ptr + done * 2, count - done );
+	}
+
+	// swap32()
+	CHIRP_TARGET("avx2")
+	void swap32( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		auto done = shuffle( ptr, count, _mm_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ), 4 );
+		chirp::backend::scalar_kernels().swap32( ptr + done * 4, count - done );
+	}
+
+	// swap64()
+	CHIRP_TARGET("avx2")
+	void swap64( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		auto done = shuffle( ptr, count, _mm_setr_epi8( 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 ), 8 );
+		chirp::backend::scalar_kernels().swap64( ptr + done * 8, count - done );
+	}
+
+	// fir()
+	CHIRP_TARGET("avx2")
+	float fir( float const* samples, float const* phase, float const* next_phase, float fraction, std::size_t taps ) {
+		auto const t = _mm256_set1_ps( fraction );
+		auto sum = _mm256_setzero_ps();
+		std::size_t i = 0;
+		for( ; i+8<=taps; i+=8 ) {
+			auto a = _mm256_loadu_ps( phase + i );
+			auto coefficients = _mm256_add_ps( a, _mm256_mul_ps( t, _mm256_sub_ps( _mm256_loadu_ps( next_phase + i ), a ) ) );
+			sum = _mm256_add_ps( sum, _mm256_mul_ps( _mm256_loadu_ps( samples + i ), coefficients ) );
+		}
+		// Add up the eight lanes
+		auto half = _mm_add_ps( _mm256_castps256_ps128( sum ), _mm256_extractf128_ps( sum, 1 ) );
+		half = _mm_add_ps( half, _mm_movehl_ps( half, half ) );
+		half = _mm_add_ss( half, _mm_shuffle_ps( half, half, 0x55 ) );
+		return _mm_cvtss_f32( half ) + chirp::backend::scalar_kernels().fir( samples + i, phase + i, next_phase + i, fraction, taps - i );
+	}
+
+	// mix()
+	CHIRP_TARGET("avx2")
+	void mix( float const* source, float* target, std::size_t count ) {
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			_mm256_storeu_ps( target + i, _mm256_add_ps( _mm256_loadu_ps( target + i ), _mm256_loadu_ps( source + i ) ) );
+		}
+		chirp::backend::scalar_kernels().mix( source + i, target + i, count - i );
+	}
+
+	// clip()
+	CHIRP_TARGET("avx2")
+	void clip( float* samples, std::size_t count ) {
+		auto const low = _mm256_set1_ps( -1.0f );
+		auto const high = _mm256_set1_ps( 1.0f );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			_mm256_storeu_ps( samples + i, _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( samples + i ), low ), high ) );
+		}
+		chirp::backend::scalar_kernels().clip( samples + i, count - i );
+	}
+
+	// interpolate()
+	CHIRP_TARGET("avx2")
+	void interpolate( float const* source, float* target, std::size_t frames, float offset, float step, float gain ) {
+		auto const steps = _mm256_set1_ps( step );
+		auto const gains = _mm256_set1_ps( gain );
+		auto const lanes = _mm256_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f );
+		std::size_t i = 0;
+		for( ; i+8<=frames; i+=8 ) {
+			auto frame = _mm256_add_ps( _mm256_set1_ps( static_cast<float>( i ) ), lanes );
+			auto position = _mm256_add_ps( _mm256_set1_ps( offset ), _mm256_mul_ps( frame, steps ) );
+			auto index = _mm256_cvttps_epi32( position );
+			auto fraction = _mm256_sub_ps( position, _mm256_cvtepi32_ps( index ) );
+			auto a = _mm256_i32gather_ps( source, index, 4 );
+			auto b = _mm256_i32gather_ps( source + 1, index, 4 );
+			_mm256_storeu_ps( target + i, _mm256_mul_ps( gains, _mm256_add_ps( a, _mm256_mul_ps( fraction, _mm256_sub_ps( b, a ) ) ) ) );
+		}
+		auto const& scalar = chirp::backend::scalar_kernels();
+		for( ; i<frames; ++i ) {
+			scalar.interpolate( source, target + i, 1, offset + static_cast<float>( i ) * step, step, gain );
+		}
+	}
+
+	// pan()
+	CHIRP_TARGET("avx2")
+	void pan( float const* source, float* target, std::size_t frames, float left, float right ) {
+		auto const gains = _mm256_setr_ps( left, right, left, right, left, right, left, right );
+		std::size_t i = 0;
+		for( ; i+8<=frames; i+=8 ) {
+			auto samples = _mm256_loadu_ps( source + i );
+			// The unpacks work within 128 bit lanes, which are put in
+			// order afterwards
+			auto low = _mm256_unpacklo_ps( samples, samples );
+			auto high = _mm256_unpackhi_ps( samples, samples );
+			auto* frame = target + 2 * i;
+			_mm256_storeu_ps( frame, _mm256_add_ps( _mm256_loadu_ps( frame ), _mm256_mul_ps( _mm256_permute2f128_ps( low, high, 0x20 ), gains ) ) );
+			_mm256_storeu_ps( frame + 8, _mm256_add_ps( _mm256_loadu_ps( frame + 8 ), _mm256_mul_ps( _mm256_permute2f128_ps( low, high, 0x31 ), gains ) ) );
+		}
+		chirp::backend::scalar_kernels().pan( source + i, target + 2 * i, frames - i, left, right );
+	}
+
+	/// The AVX2 kernels
+	chirp::backend::conversion_kernels const Avx2Kernels = { encode_int16, decode_int16, encode_int32, decode_int32, swap16, swap32, swap64, fir, mix, clip, interpolate, pan };
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// avx2_kernels()
+		conversion_kernels const& avx2_kernels() {
+			return Avx2Kernels;
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_X86_KERNELS)
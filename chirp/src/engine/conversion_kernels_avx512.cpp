@@ -0,0 +1,204 @@
+#include "conversion_kernels.hpp"
+
+#if defined(CHIRP_WITH_X86_KERNELS)
+
+// The AVX-512 intrinsics of some GCC versions start from self-initialized
+// undefined vectors, which trips the uninitialized warning
+#if defined(__GNUC__) && !defined(__clang__)
+#	pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#	pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+#include <immintrin.h>
+
+namespace
+{
+	// encode_int16()
+	CHIRP_TARGET("avx512f")
+	void encode_int16( float const* source, std::int16_t* target, std::size_t count ) {
+		auto const low = _mm512_set1_ps( -1.0f );
+		auto const high = _mm512_set1_ps( 1.0f );
+		auto const scale = _mm512_set1_ps( 32767.0f );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto a = _mm512_min_ps( _mm512_max_ps( _mm512_loadu_ps( source + i ), low ), high );
+			auto samples = _mm512_cvtsepi32_epi16( _mm512_cvttps_epi32( _mm512_mul_ps( a, scale ) ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( target + i ), samples );
+		}
+		chirp::backend::scalar_kernels().encode_int16( source + i, target + i, count - i );
+	}
+
+	// decode_int16()
+	CHIRP_TARGET("avx512f")
+	void decode_int16( std::int16_t const* source, float* target, std::size_t count ) {
+		auto const scale = _mm512_set1_ps( 1.0f / 32767.0f );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto samples = _mm512_cvtepi16_epi32( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( source + i ) ) );
+			_mm512_storeu_ps( target + i, _mm512_mul_ps( _mm512_cvtepi32_ps( samples ), scale ) );
+		}
+		chirp::backend::scalar_kernels().decode_int16( source + i, target + i, count - i );
+	}
+
+	// encode_int32()
+	CHIRP_TARGET("avx512f")
+	void encode_int32( float const* source, std::int32_t* target, std::size_t count, float scale ) {
+		auto const low = _mm512_set1_ps( -1.0f );
+		auto const high = _mm512_set1_ps( 1.0f );
+		auto const factor = _mm512_set1_ps( scale );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto a = _mm512_min_ps( _mm512_max_ps( _mm512_loadu_ps( source + i ), low ), high );
+			_mm512_storeu_si512( target + i, _mm512_cvttps_epi32( _mm512_mul_ps( a, factor ) ) );
+		}
+		chirp::backend::scalar_kernels().encode_int32( source + i, target + i, count - i, scale );
+	}
+
+	// decode_int32()
+	CHIRP_TARGET("avx512f")
+	void decode_int32( std::int32_t const* source, float* target, std::size_t count, float inverse_scale ) {
+		auto const factor = _mm512_set1_ps( inverse_scale );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto samples = _mm512_loadu_si512( source + i );
+			_mm512_storeu_ps( target + i, _mm512_mul_ps( _mm512_cvtepi32_ps( samples ), factor ) );
+		}
+		chirp::backend::scalar_kernels().decode_int32( source + i, target + i, count - i, inverse_scale );
+	}
+
+	/// Swap the bytes of each 16 bit half of the 32 bit lanes. AVX-512F
+	/// has neither 16 bit shifts nor byte shuffles, so the bytes are
+	/// moved with 32 bit shifts and masked.
+	CHIRP_TARGET("avx512f")
+	inline __m512i swap_bytes( __m512i samples ) {
+		auto high = _mm512_and_si512( _mm512_slli_epi32( samples, 8 ), _mm512_set1_epi32( static_cast<int>( 0xff00ff00u ) ) );
+		auto low = _mm512_and_si512( _mm512_srli_epi32( samples, 8 ), _mm512_set1_epi32( 0x00ff00ff ) );
+		return _mm512_or_si512( high, low );
+	}
+
+	// swap16()
+	CHIRP_TARGET("avx512f")
+	void swap16( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+32<=count; i+=32 ) {
+			auto* vector = ptr + i * 2;
+			_mm512_storeu_si512( vector, swap_bytes( _mm512_loadu_si512( vector ) ) );
+		}
+		chirp::backend::scalar_kernels().swap16( ptr + i * 2, count - i );
+	}
+
+	// swap32()
+	CHIRP_TARGET("avx512f")
+	void swap32( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			auto* vector = ptr + i * 4;
+			_mm512_storeu_si512( vector, _mm512_rol_epi32( swap_bytes( _mm512_loadu_si512( vector ) ), 16 ) );
+		}
+		chirp::backend::scalar_kernels().swap32( ptr + i * 4, count - i );
+	}
+
+	// swap64()
+	CHIRP_TARGET("avx512f")
+	void swap64( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			auto* vector = ptr + i * 8;
+			_mm512_storeu_si512( vector, _mm512_rol_epi64( _mm512_rol_epi32( swap_bytes( _mm512_loadu_si512( vector ) ), 16 ), 32 ) );
+		}
+		chirp::backend::scalar_kernels().swap64( ptr + i * 8, count - i );
+	}
+
+	// fir()
+	CHIRP_TARGET("avx512f")
+	float fir( float const* samples, float const* phase, float const* next_phase, float fraction, std::size_t taps ) {
+		auto const t = _mm512_set1_ps( fraction );
+		auto sum = _mm512_setzero_ps();
+		std::size_t i = 0;
+		for( ; i+16<=taps; i+=16 ) {
+			auto a = _mm512_loadu_ps( phase + i );
+			auto coefficients = _mm512_add_ps( a, _mm512_mul_ps( t, _mm512_sub_ps( _mm512_loadu_ps( next_phase + i ), a ) ) );
+			sum = _mm512_add_ps( sum, _mm512_mul_ps( _mm512_loadu_ps( samples + i ), coefficients ) );
+		}
+		return _mm512_reduce_add_ps( sum ) + chirp::backend::scalar_kernels().fir( samples + i, phase + i, next_phase + i, fraction, taps - i );
+	}
+
+	// mix()
+	CHIRP_TARGET("avx512f")
+	void mix( float const* source, float* target, std::size_t count ) {
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			_mm512_storeu_ps( target + i, _mm512_add_ps( _mm512_loadu_ps( target + i ), _mm512_loadu_ps( source + i ) ) );
+		}
+		chirp::backend::scalar_kernels().mix( source + i, target + i, count - i );
+	}
+
+	// clip()
+	CHIRP_TARGET("avx512f")
+	void clip( float* samples, std::size_t count ) {
+		auto const low = _mm512_set1_ps( -1.0f );
+		auto const high = _mm512_set1_ps( 1.0f );
+		std::size_t i = 0;
+		for( ; i+16<=count; i+=16 ) {
+			_mm512_storeu_ps( samples + i, _mm512_min_ps( _mm512_max_ps( _mm512_loadu_ps( samples + i ), low ), high ) );
+		}
+		chirp::backend::scalar_kernels().clip( samples + i, count - i );
+	}
+
+	// interpolate()
+	CHIRP_TARGET("avx512f")
+	void interpolate( float const* source, float* target, std::size_t frames, float offset, float step, float gain ) {
+		auto const steps = _mm512_set1_ps( step );
+		auto const gains = _mm512_set1_ps( gain );
+		auto const lanes = _mm512_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f );
+		std::size_t i = 0;
+		for( ; i+16<=frames; i+=16 ) {
+			auto frame = _mm512_add_ps( _mm512_set1_ps( static_cast<float>( i ) ), lanes );
+			auto position = _mm512_add_ps( _mm512_set1_ps( offset ), _mm512_mul_ps( frame, steps ) );
+			auto index = _mm512_cvttps_epi32( position );
+			auto fraction = _mm512_sub_ps( position, _mm512_cvtepi32_ps( index ) );
+			auto a = _mm512_i32gather_ps( index, source, 4 );
+			auto b = _mm512_i32gather_ps( index, source + 1, 4 );
+			_mm512_storeu_ps( target + i, _mm512_mul_ps( gains, _mm512_add_ps( a, _mm512_mul_ps( fraction, _mm512_sub_ps( b, a ) ) ) ) );
+		}
+		auto const& scalar = chirp::backend::scalar_kernels();
+		for( ; i<frames; ++i ) {
+			scalar.interpolate( source, target + i, 1, offset + static_cast<float>( i ) * step, step, gain );
+		}
+	}
+
+	// pan()
+	CHIRP_TARGET("avx512f")
+	void pan( float const* source, float* target, std::size_t frames, float left, float right ) {
+		auto const gains = _mm512_setr_ps( left, right, left, right, left, right, left, right, left, right, left, right, left, right, left, right );
+		auto const low_order = _mm512_setr_epi32( 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7 );
+		auto const high_order = _mm512_setr_epi32( 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15 );
+		std::size_t i = 0;
+		for( ; i+16<=frames; i+=16 ) {
+			auto samples = _mm512_loadu_ps( source + i );
+			auto* frame = target + 2 * i;
+			_mm512_storeu_ps( frame, _mm512_add_ps( _mm512_loadu_ps( frame ), _mm512_mul_ps( _mm512_permutexvar_ps( low_order, samples ), gains ) ) );
+			_mm512_storeu_ps( frame + 16, _mm512_add_ps( _mm512_loadu_ps( frame + 16 ), _mm512_mul_ps( _mm512_permutexvar_ps( high_order, samples ), gains ) ) );
+		}
+		chirp::backend::scalar_kernels().pan( source + i, target + 2 * i, frames - i, left, right );
+	}
+
+	/// The AVX-512 kernels
+	chirp::backend::conversion_kernels const Avx512Kernels = { encode_int16, decode_int16, encode_int32, decode_int32, swap16, swap32, swap64, fir, mix, clip, interpolate, pan };
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// avx512_kernels()
+		conversion_kernels const& avx512_kernels() {
+			return Avx512Kernels;
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_X86_KERNELS)
@@ -0,0 +1,192 @@
+#include "conversion_kernels.hpp"
+
+#if defined(CHIRP_WITH_X86_KERNELS)
+
+#include <immintrin.h>
+
+namespace
+{
+	// encode_int16()
+	CHIRP_TARGET("sse2")
+	void encode_int16( float const* source, std::int16_t* target, std::size_t count ) {
+		auto const low = _mm_set1_ps( -1.0f );
+		auto const high = _mm_set1_ps( 1.0f );
+		auto const scale = _mm_set1_ps( 32767.0f );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			// max and min return the second operand for NaN, which turns
+			// NaN into -1.0 like the scalar clamp
+			auto a = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( source + i ), low ), high );
+			auto b = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( source + i + 4 ), low ), high );
+			auto packed = _mm_packs_epi32( _mm_cvttps_epi32( _mm_mul_ps( a, scale ) ), _mm_cvttps_epi32( _mm_mul_ps( b, scale ) ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( target + i ), packed );
+		}
+		chirp::backend::scalar_kernels().encode_int16( source + i, target + i, count - i );
+	}
+
+	// decode_int16()
+	CHIRP_TARGET("sse2")
+	void decode_int16( std::int16_t const* source, float* target, std::size_t count ) {
+		auto const scale = _mm_set1_ps( 1.0f / 32767.0f );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			// Sign extend by moving each sample to the upper half of a
+			// 32 bit lane and shifting it back down
+			auto samples = _mm_loadu_si128( reinterpret_cast<__m128i const*>( source + i ) );
+			auto a = _mm_srai_epi32( _mm_unpacklo_epi16( samples, samples ), 16 );
+			auto b = _mm_srai_epi32( _mm_unpackhi_epi16( samples, samples ), 16 );
+			_mm_storeu_ps( target + i, _mm_mul_ps( _mm_cvtepi32_ps( a ), scale ) );
+			_mm_storeu_ps( target + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( b ), scale ) );
+		}
+		chirp::backend::scalar_kernels().decode_int16( source + i, target + i, count - i );
+	}
+
+	// encode_int32()
+	CHIRP_TARGET("sse2")
+	void encode_int32( float const* source, std::int32_t* target, std::size_t count, float scale ) {
+		auto const low = _mm_set1_ps( -1.0f );
+		auto const high = _mm_set1_ps( 1.0f );
+		auto const factor = _mm_set1_ps( scale );
+		std::size_t i = 0;
+		for( ; i+4<=count; i+=4 ) {
+			auto a = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( source + i ), low ), high );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( target + i ), _mm_cvttps_epi32( _mm_mul_ps( a, factor ) ) );
+		}
+		chirp::backend::scalar_kernels().encode_int32( source + i, target + i, count - i, scale );
+	}
+
+	// decode_int32()
+	CHIRP_TARGET("sse2")
+	void decode_int32( std::int32_t const* source, float* target, std::size_t count, float inverse_scale ) {
+		auto const factor = _mm_set1_ps( inverse_scale );
+		std::size_t i = 0;
+		for( ; i+4<=count; i+=4 ) {
+			auto samples = _mm_loadu_si128( reinterpret_cast<__m128i const*>( source + i ) );
+			_mm_storeu_ps( target + i, _mm_mul_ps( _mm_cvtepi32_ps( samples ), factor ) );
+		}
+		chirp::backend::scalar_kernels().decode_int32( source + i, target + i, count - i, inverse_scale );
+	}
+
+	/// Swap the bytes of each 16 bit lane
+	CHIRP_TARGET("sse2")
+	inline __m128i swap_bytes( __m128i samples ) {
+		return _mm_or_si128( _mm_slli_epi16( samples, 8 ), _mm_srli_epi16( samples, 8 ) );
+	}
+
+	/// Swap the 16 bit halves of each 32 bit lane
+	CHIRP_TARGET("sse2")
+	inline __m128i swap_halves( __m128i samples ) {
+		return _mm_or_si128( _mm_slli_epi32( samples, 16 ), _mm_srli_epi32( samples, 16 ) );
+	}
+
+	// swap16()
+	CHIRP_TARGET("sse2")
+	void swap16( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+8<=count; i+=8 ) {
+			auto* vector = reinterpret_cast<__m128i*>( ptr + i * 2 );
+			_mm_storeu_si128( vector, swap_bytes( _mm_loadu_si128( vector ) ) );
+		}
+		chirp::backend::scalar_kernels().swap16( ptr + i * 2, count - i );
+	}
+
+	// swap32()
+	CHIRP_TARGET("sse2")
+	void swap32( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+4<=count; i+=4 ) {
+			auto* vector = reinterpret_cast<__m128i*>( ptr + i * 4 );
+			_mm_storeu_si128( vector, swap_halves( swap_bytes( _mm_loadu_si128( vector ) ) ) );
+		}
+		chirp::backend::scalar_kernels().swap32( ptr + i * 4, count - i );
+	}
+
+	// swap64()
+	CHIRP_TARGET("sse2")
+	void swap64( void* samples, std::size_t count ) {
+		auto* ptr = static_cast<std::uint8_t*>( samples );
+		std::size_t i = 0;
+		for( ; i+2<=count; i+=2 ) {
+			auto* vector = reinterpret_cast<__m128i*>( ptr + i * 8 );
+			auto swapped = swap_halves( swap_bytes( _mm_loadu_si128( vector ) ) );
+			_mm_storeu_si128( vector, _mm_shuffle_epi32( swapped, 0xb1 ) );
+		}
+		chirp::backend::scalar_kernels().swap64( ptr + i * 8, count - i );
+	}
+
+	// fir()
+	CHIRP_TARGET("sse2")
+	float fir( float const* samples, float const* phase, float const* next_phase, float fraction, std::size_t taps ) {
+		auto const t = _mm_set1_ps( fraction );
+		auto sum = _mm_setzero_ps();
+		std::size_t i = 0;
+		for( ; i+4<=taps; i+=4 ) {
+			auto a = _mm_loadu_ps( phase + i );
+			auto coefficients = _mm_add_ps( a, _mm_mul_ps( t, _mm_sub_ps( _mm_loadu_ps( next_phase + i ), a ) ) );
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( samples + i ), coefficients ) );
+		}
+		// Add up the four lanes
+		sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+		sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 0x55 ) );
+		return _mm_cvtss_f32( sum ) + chirp::backend::scalar_kernels().fir( samples + i, phase + i, next_phase + i, fraction, taps - i );
+	}
+
+	// mix()
+	CHIRP_TARGET("sse2")
+	void mix( float const* source, float* target, std::size_t count ) {
+		std::size_t i = 0;
+		for( ; i+4<=count; i+=4 ) {
+			_mm_storeu_ps( target + i, _mm_add_ps( _mm_loadu_ps( target + i ), _mm_loadu_ps( source + i ) ) );
+		}
+		chirp::backend::scalar_kernels().mix( source + i, target + i, count - i );
+	}
+
+	// clip()
+	CHIRP_TARGET("sse2")
+	void clip( float* samples, std::size_t count ) {
+		auto const low = _mm_set1_ps( -1.0f );
+		auto const high = _mm_set1_ps( 1.0f );
+		std::size_t i = 0;
+		for( ; i+4<=count; i+=4 ) {
+			_mm_storeu_ps( samples + i, _mm_min_ps( _mm_max_ps( _mm_loadu_ps( samples + i ), low ), high ) );
+		}
+		chirp::backend::scalar_kernels().clip( samples + i, count - i );
+	}
+
+	// pan()
+	CHIRP_TARGET("sse2")
+	void pan( float const* source, float* target, std::size_t frames, float left, float right ) {
+		auto const gains = _mm_setr_ps( left, right, left, right );
+		std::size_t i = 0;
+		for( ; i+4<=frames; i+=4 ) {
+			auto samples = _mm_loadu_ps( source + i );
+			auto* frame = target + 2 * i;
+			_mm_storeu_ps( frame, _mm_add_ps( _mm_loadu_ps( frame ), _mm_mul_ps( _mm_unpacklo_ps( samples, samples ), gains ) ) );
+			_mm_storeu_ps( frame + 4, _mm_add_ps( _mm_loadu_ps( frame + 4 ), _mm_mul_ps( _mm_unpackhi_ps( samples, samples ), gains ) ) );
+		}
+		chirp::backend::scalar_kernels().pan( source + i, target + 2 * i, frames - i, left, right );
+	}
+
+	/// Interpolate with the scalar kernel, as SSE2 can't gather samples
+	void interpolate( float const* source, float* target, std::size_t frames, float offset, float step, float gain ) {
+		chirp::backend::scalar_kernels().interpolate( source, target, frames, offset, step, gain );
+	}
+
+	/// The SSE2 kernels
+	chirp::backend::conversion_kernels const Sse2Kernels = { encode_int16, decode_int16, encode_int32, decode_int32, swap16, swap32, swap64, fir, mix, clip, interpolate, pan };
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// sse2_kernels()
+		conversion_kernels const& sse2_kernels() {
+			return Sse2Kernels;
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_X86_KERNELS)
@@ -0,0 +1,283 @@
+#include "mixer_engine.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	/// Number of frames that each stream renders at a time
+	std::size_t const MixFrames = 1024;
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		//-----------------------------------------------------------------
+		// mixer_engine implementation
+		//-----------------------------------------------------------------
+
+		// mixer_engine constructor
+		mixer_engine::mixer_engine( audio_format::frequency_type frequency, channel_count channels ) :
+			_format( frequency, sample_format{ sample_type::floating_point, 32, native_byte_order, channels } ),
+			_kernels( &kernels_for( detected_simd_level() ) ),
+			_scratch( MixFrames * channels, 0.0f ),
+			_streams( std::make_unique<stream_list>() ),
+			_mixed( _streams.get() ),
+			_mixes( 0 ),
+			_mix_thread( std::thread::id{} ),
+			_started( false )
+		{
+		}
+
+		// mixer_engine destructor
+		mixer_engine::~mixer_engine() {
+			if( _device_stream && _device_stream->is_playing() ) {
+				_device_stream->stop();
+			}
+		}
+
+		// mixer_engine::set_device_stream()
+		void mixer_engine::set_device_stream( chirp::audio_stream stream ) {
+			_device_stream = std::make_unique<chirp::audio_stream>( std::move(stream) );
+			_device_stream->on_underrun( [this]( stream_statistics const& statistics ) { underrun( statistics ); } );
+		}
+
+		// mixer_engine::playing_streams()
+		std::size_t mixer_engine::playing_streams() const {
+			std::unique_lock<std::mutex> lock{_mutex};
+			return static_cast<std::size_t>( std::count_if( _streams->begin(), _streams->end(),
+				[]( mixed_stream const& entry ) { return entry.stream->_state == audio_stream_state::playing; } ) );
+		}
+
+		// mixer_engine::fill_samples()
+		fill_result mixer_engine::fill_samples( duration_type const&, sample_request const& request ) {
+			// Tell threads that change the streams that this list is read
+			_mix_thread = std::this_thread::get_id();
+			++_mixes;
+			auto const& streams = *_mixed.load();
+
+			auto channels = _format.channels();
+			auto* target = static_cast<float*>( request.buffer_start() );
+			std::size_t frames = request.frames();
+			std::size_t done = 0;
+			while( done < frames ) {
+				auto count = std::min( frames - done, MixFrames );
+				auto presentation = request.presentation_time();
+				if( presentation != sample_request::time_point{} ) {
+					presentation += _format.duration_of( done );
+				}
+				auto bytes = static_cast<stream_renderer::byte_count>( count * _format.bytes_per_frame() );
+				auto* block = target + done * channels;
+				bool rendered = false;
+				for( auto const& entry : streams ) {
+					auto* stream = entry.stream;
+					if( stream->_state != audio_stream_state::playing ) {
+						continue;
+					}
+					stream->_mixed = &entry;
+					// The first stream renders into the request, and the
+					// others are added to it
+					if( !rendered ) {
+						stream->_renderer.render( block, bytes, presentation );
+						rendered = true;
+					}
+					else {
+						stream->_renderer.render( _scratch.data(), bytes, presentation );
+						_kernels->mix( _scratch.data(), block, count * channels );
+					}
+				}
+				if( !rendered ) {
+					std::memset( block, 0, bytes );
+				}
+				done += count;
+			}
+			++_mixes;
+
+			_kernels->clip( target, frames * channels );
+			return fill_result{ request.frames(), false };
+		}
+
+		// mixer_engine::change_streams()
+		template <class F>
+		void mixer_engine::change_streams( F change ) {
+			auto streams = std::make_unique<stream_list>( *_streams );
+			change( *streams );
+			_mixed = streams.get();
+			wait_for_mix();
+			_streams = std::move(streams);
+		}
+
+		// mixer_engine::wait_for_mix()
+		void mixer_engine::wait_for_mix() const {
+			if( _mix_thread.load() == std::this_thread::get_id() ) {
+				return;
+			}
+			auto mixes = _mixes.load();
+			if( mixes % 2 != 0 ) {
+				while( _mixes.load() == mixes ) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		// mixer_engine::start()
+		void mixer_engine::start() {
+			if( _device_stream && !_started.exchange( true ) ) {
+				_device_stream->play_async( *this );
+			}
+		}
+
+		// mixer_engine::underrun()
+		void mixer_engine::underrun( stream_statistics const& statistics ) {
+			// The device stream calls this on the play thread, so the list
+			// is read like the mix reads it
+			_mix_thread = std::this_thread::get_id();
+			++_mixes;
+			for( auto const& entry : *_mixed.load() ) {
+				if( entry.stream->_state == audio_stream_state::playing && entry.underrun_handler ) {
+					entry.underrun_handler( statistics );
+				}
+			}
+			++_mixes;
+		}
+
+		//-----------------------------------------------------------------
+		// mixer_stream implementation
+		//-----------------------------------------------------------------
+
+		// mixer_stream constructor
+		mixer_stream::mixer_stream( std::shared_ptr<mixer_engine> mixer, audio_format const& format, stream_options const& options ) :
+			_mixer( std::move(mixer) ),
+			_state( audio_stream_state::ready ),
+			_renderer( format, options ),
+			_mixed( nullptr )
+		{
+			_renderer.set_device_format( _mixer->format() );
+			// The handlers of the stream are kept in the list that is mixed
+			_renderer.set_budget_handler( 0.0f, [this]( budget_event const& event ) { budget_exceeded( event ); } );
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			_mixer->change_streams( [this]( mixer_engine::stream_list& streams ) {
+				streams.push_back( mixer_engine::mixed_stream{ this, 1.0f, budget_handler_func{}, underrun_handler_func{} } );
+			});
+		}
+
+		// mixer_stream destructor
+		mixer_stream::~mixer_stream() {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			_mixer->change_streams( [this]( mixer_engine::stream_list& streams ) {
+				streams.erase( std::remove_if( streams.begin(), streams.end(),
+					[this]( mixer_engine::mixed_stream const& entry ) { return entry.stream == this; } ), streams.end() );
+			});
+		}
+
+		// play_async()
+		void mixer_stream::play_async( sample_provider_func f ) {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			stop();
+			auto& provider = _renderer.adopt( std::move(f) );
+			lock.unlock();
+			play_async( provider );
+		}
+
+		// play_async()
+		void mixer_stream::play_async( planar_provider_func f ) {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			stop();
+			auto& provider = _renderer.adopt( std::move(f) );
+			lock.unlock();
+			play_async( provider );
+		}
+
+		// play_async()
+		void mixer_stream::play_async( sample_provider& provider ) {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			stop();
+			_renderer.set_sample_provider( provider );
+			_renderer.rewind();
+			_state = audio_stream_state::playing;
+			lock.unlock();
+			_mixer->start();
+		}
+
+		// stop()
+		void mixer_stream::stop() {
+			// The mix checks the state of each stream before it renders it,
+			// so only the mix in progress may still call the provider
+			if( _state.exchange( audio_stream_state::ready ) == audio_stream_state::playing ) {
+				_mixer->wait_for_mix();
+			}
+		}
+
+		// budget_exceeded()
+		void mixer_stream::budget_exceeded( budget_event const& event ) {
+			if( _mixed->budget_handler && event.load() > _mixed->budget_fraction ) {
+				_mixed->budget_handler( event );
+			}
+		}
+
+		// state()
+		audio_stream_state mixer_stream::state() const {
+			return _state;
+		}
+
+		// configuration()
+		stream_configuration mixer_stream::configuration() const {
+			if( auto* device = _mixer->device_stream() ) {
+				return device->configuration();
+			}
+			return stream_configuration{ _mixer->format().frequency(), 0, 0, 0 };
+		}
+
+		// statistics()
+		stream_statistics mixer_stream::statistics() const {
+			if( auto* device = _mixer->device_stream() ) {
+				return device->statistics();
+			}
+			return stream_statistics{};
+		}
+
+		// set_underrun_handler()
+		void mixer_stream::set_underrun_handler( underrun_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			_mixer->change_streams( [&]( mixer_engine::stream_list& streams ) {
+				for( auto& entry : streams ) {
+					if( entry.stream == this ) {
+						entry.underrun_handler = std::move(f);
+					}
+				}
+			});
+		}
+
+		// callback_timing()
+		callback_statistics mixer_stream::callback_timing() const {
+			return _renderer.statistics();
+		}
+
+		// set_budget_handler()
+		void mixer_stream::set_budget_handler( float fraction, budget_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mixer->_mutex};
+			_mixer->change_streams( [&]( mixer_engine::stream_list& streams ) {
+				for( auto& entry : streams ) {
+					if( entry.stream == this ) {
+						entry.budget_fraction = fraction;
+						entry.budget_handler = std::move(f);
+					}
+				}
+			});
+		}
+
+		// timeline()
+		stream_timeline& mixer_stream::timeline() {
+			return _renderer.timeline();
+		}
+
+		// latency()
+		std::chrono::nanoseconds mixer_stream::latency() const {
+			if( auto* device = _mixer->device_stream() ) {
+				return device->latency();
+			}
+			return std::chrono::nanoseconds::zero();
+		}
+	}   // namespace backend
+}   // namespace chirp
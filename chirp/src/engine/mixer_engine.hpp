@@ -0,0 +1,247 @@
+#ifndef IG_CHIRP_SRC_ENGINE_MIXER_ENGINE_HPP
+#define IG_CHIRP_SRC_ENGINE_MIXER_ENGINE_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/audio_stream.hpp>
+#include <chirp/backend.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+#include <chirp/stream_options.hpp>
+#include "conversion_kernels.hpp"
+#include "stream_renderer.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chirp
+{
+	namespace backend
+	{
+		class mixer_stream;
+
+		/// Mixes audio streams into the samples of one device stream.
+		///
+		/// The mixer is the sample provider of the device stream. Each time
+		/// it is asked for samples, it lets every playing stream render a
+		/// block of float samples into one scratch buffer, which is shared
+		/// by all streams, and adds the block to the mix with the vector
+		/// kernels. The mix is clipped to full scale before it is handed to
+		/// the device stream, which converts it to the device format.
+		///
+		/// Streams are registered when they are created, and only take
+		/// part in the mix while they play, so memory doesn't grow with
+		/// the number of streams that start and stop.
+		///
+		/// The play thread never waits for a lock. The streams are kept in
+		/// a list that is copied, changed and swapped in by the threads
+		/// that create streams and change their handlers, and the mix reads
+		/// the list that is current when it starts. A previous list is only
+		/// freed after the mix that may read it has ended. The mix must
+		/// only be run by one thread at a time.
+		class mixer_engine :
+			public filling_sample_provider
+		{
+			public:
+				/// Integral type for channel counts
+				using channel_count = sample_format::channel_count;
+
+				/// Create a mixer without a device stream, which is mixed by
+				/// calling `provide_samples()`
+				/// @param frequency   The frequency of the mix
+				/// @param channels    The number of channels of the mix
+				mixer_engine( audio_format::frequency_type frequency, channel_count channels );
+
+				/// Stop the device stream
+				~mixer_engine();
+
+				// Not copy-constructable or copy-assignable
+				mixer_engine( mixer_engine const& ) = delete;
+				mixer_engine& operator=( mixer_engine const& ) = delete;
+
+				/// Set the device stream, which is started when the first
+				/// stream plays. Must be called before any stream plays.
+				/// @param stream   The device stream, with the format of the
+				///                 mix
+				void set_device_stream( chirp::audio_stream stream );
+
+				/// @returns The format of the mix, which has float samples
+				///          in native byte order
+				audio_format const& format() const {
+					return _format;
+				}
+
+				/// @returns The device stream, or null if there is none
+				chirp::audio_stream const* device_stream() const {
+					return _device_stream.get();
+				}
+
+				/// @returns The number of streams that are playing
+				std::size_t playing_streams() const;
+
+				/// Mix a block of samples. The first stream that plays
+				/// renders into the request, so the request doesn't have to
+				/// be cleared.
+				/// @param play_time   The play time of the mix
+				/// @param request     The request for samples in the format
+				///                    of the mix
+				/// @returns All frames of the request
+				fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override;
+
+			private:
+				friend class mixer_stream;
+
+				/// What the mix reads about a stream besides its state
+				struct mixed_stream
+				{
+					/// The stream
+					mixer_stream* stream;
+					/// The fraction of the budget that calls the budget
+					/// handler
+					float budget_fraction;
+					/// Function to call when the sample provider of the
+					/// stream uses more than the fraction of its budget
+					budget_handler_func budget_handler;
+					/// Function to call when the device stream runs out of
+					/// samples while the stream plays
+					underrun_handler_func underrun_handler;
+				};
+
+				/// List of streams that the mix reads
+				using stream_list = std::vector<mixed_stream>;
+
+				/// Swap in a changed copy of the list of streams, and wait
+				/// until the mix no longer reads the previous list. Must be
+				/// called with the mutex held.
+				/// @param change   Function that changes the copy
+				template <class F>
+				void change_streams( F change );
+
+				/// Wait until the mix that is in progress has ended, unless
+				/// it is called by the mix itself
+				void wait_for_mix() const;
+
+				/// Start the device stream if it isn't playing yet
+				void start();
+
+				/// Call the underrun handlers of the playing streams. Reads
+				/// the list of streams like the mix does, without the mutex.
+				/// @param statistics   The statistics of the device stream
+				void underrun( stream_statistics const& statistics );
+
+				/// The format of the mix
+				audio_format _format;
+				/// The vector kernels
+				conversion_kernels const* _kernels;
+				/// Scratch buffer that each stream renders a block into
+				std::vector<float> _scratch;
+				/// Mutex for changing the list of streams, which the mix
+				/// doesn't take
+				mutable std::mutex _mutex;
+				/// All streams of the mixer, whether they play or not
+				std::unique_ptr<stream_list> _streams;
+				/// The list of streams that the next mix reads
+				std::atomic<stream_list const*> _mixed;
+				/// Number of times a mix has started or ended, which is odd
+				/// while a mix is in progress
+				std::atomic<std::uint64_t> _mixes;
+				/// The thread that runs the mix
+				std::atomic<std::thread::id> _mix_thread;
+				/// The device stream
+				std::unique_ptr<chirp::audio_stream> _device_stream;
+				/// Flag telling if the device stream has been started
+				std::atomic<bool> _started;
+		};
+
+		/// Audio stream implementation for streams that are mixed.
+		///
+		/// A mixed stream has no device buffer of its own. Its samples are
+		/// rendered on the play thread of the device stream, converted and
+		/// resampled to the format of the mix by its renderer. The buffer
+		/// configuration, underrun counters and latency are those of the
+		/// device stream.
+		class mixer_stream :
+			public backend::audio_stream
+		{
+			public:
+				/// Create a mixed stream
+				/// @param mixer     The mixer that the stream is mixed by
+				/// @param format    The format of the stream, which must have
+				///                  as many channels as the mix
+				/// @param options   The stream options, of which the render
+				///                  quantum and the resampler quality are
+				///                  used
+				/// @throws sample_format_exception if the stream has another
+				///         number of channels than the mix
+				mixer_stream( std::shared_ptr<mixer_engine> mixer, audio_format const& format, stream_options const& options );
+
+				/// Stop the stream and remove it from the mixer
+				~mixer_stream();
+
+				/// @returns the state of the audio stream
+				audio_stream_state state() const override;
+
+				/// Start playing the audio stream asyncronously
+				void play_async( sample_provider_func f ) override;
+
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				void play_async( sample_provider& provider ) override;
+
+				/// Start playing the audio stream with a planar provider function
+				/// @param f   The function
+				void play_async( planar_provider_func f ) override;
+
+				/// Stop playing the audio stream if it is playing. The
+				/// sample provider isn't called after this returns, unless
+				/// it is called from the sample provider.
+				void stop() override;
+
+				/// @returns The buffer configuration of the device stream
+				stream_configuration configuration() const override;
+
+				/// @returns The underrun counters of the device stream
+				stream_statistics statistics() const override;
+
+				/// Set the function that is called when the device stream
+				/// runs out of samples while this stream plays
+				void set_underrun_handler( underrun_handler_func f ) override;
+
+				/// @returns The timing of the sample provider
+				callback_statistics callback_timing() const override;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget
+				void set_budget_handler( float fraction, budget_handler_func f ) override;
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() override;
+
+				/// @returns The latency of the device stream
+				std::chrono::nanoseconds latency() const override;
+
+			private:
+				friend class mixer_engine;
+
+				/// Call the budget handler of the stream list that is mixed
+				/// @param event   The timing of the sample provider
+				void budget_exceeded( budget_event const& event );
+
+				/// The mixer
+				std::shared_ptr<mixer_engine> _mixer;
+				/// Current audio state
+				std::atomic<audio_stream_state> _state;
+				/// Renders the stream in the format of the mix
+				stream_renderer _renderer;
+				/// The entry of the stream in the list that is mixed, which
+				/// is only used by the mix
+				mixer_engine::mixed_stream const* _mixed;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_MIXER_ENGINE_HPP
@@ -0,0 +1,43 @@
+#include "planar_adapter.hpp"
+#include "sample_conversion.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+	/// The largest number of frames in a planar request
+	std::size_t const BlockFrames = 512;
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// constructor
+		planar_adapter::planar_adapter( audio_format const& format ) :
+			_format( format ),
+			_samples( format.channels() * BlockFrames, 0.0f ),
+			_channel_ptrs( format.channels(), nullptr )
+		{
+			for( std::size_t c=0; c<_channel_ptrs.size(); ++c ) {
+				_channel_ptrs[c] = _samples.data() + c * BlockFrames;
+			}
+		}
+
+		// fill_samples()
+		fill_result planar_adapter::fill_samples( duration_type const& play_time, sample_request const& request ) {
+			auto* target = static_cast<std::uint8_t*>( request.buffer_start() );
+			std::size_t frames = request.frames();
+			auto presentation = request.presentation_time();
+			for( std::size_t offset=0; offset<frames; offset+=BlockFrames ) {
+				auto size = std::min<std::size_t>( BlockFrames, frames - offset );
+				std::fill( _samples.begin(), _samples.end(), 0.0f );
+				auto block_presentation = presentation == sample_request::time_point{} ? presentation : presentation + _format.duration_of( offset );
+				_func( play_time + _format.duration_of( offset ), planar_request{ _channel_ptrs.data(), size, _format, request.frame_position() + offset, block_presentation } );
+				interleave( _channel_ptrs.data(), size, _format.sample_format(), target + offset * _format.bytes_per_frame() );
+			}
+			return fill_result::full( request );
+		}
+	}   // namespace backend
+}   // namespace chirp
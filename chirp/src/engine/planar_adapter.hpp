@@ -0,0 +1,58 @@
+#ifndef IG_CHIRP_SRC_ENGINE_PLANAR_ADAPTER_HPP
+#define IG_CHIRP_SRC_ENGINE_PLANAR_ADAPTER_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/planar_request.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Sample provider that lets a planar provider function fill
+		/// float32 channel buffers, and converts them to the interleaved
+		/// sample format of the stream.
+		///
+		/// The channel buffers are allocated up front, so sample requests
+		/// are split into blocks of a fixed maximum size.
+		class planar_adapter :
+			public filling_sample_provider
+		{
+			public:
+				/// Create an adapter
+				/// @param format   The audio format of the stream
+				explicit planar_adapter( audio_format const& format );
+
+				// Not copy-constructable or copy-assignable
+				planar_adapter( planar_adapter const& ) = delete;
+				planar_adapter& operator=( planar_adapter const& ) = delete;
+
+				/// Set the planar provider function
+				/// @param f   The function
+				void set_function( planar_provider_func f ) {
+					_func = std::move(f);
+				}
+
+				/// Fill a sample request through the planar provider function.
+				/// Every frame is written, so the request isn't cleared.
+				fill_result fill_samples( duration_type const& play_time, sample_request const& request ) override;
+
+			private:
+				/// Audio format of the stream
+				audio_format _format;
+				/// The planar provider function
+				planar_provider_func _func;
+				/// Samples of all channel buffers
+				std::vector<float> _samples;
+				/// Pointers to the start of each channel buffer
+				std::vector<float*> _channel_ptrs;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_PLANAR_ADAPTER_HPP
@@ -0,0 +1,207 @@
+#include "render_loop.hpp"
+
+#include <algorithm>
+
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	/// Shortest time between two wakeups caused by polled descriptors. Some
+	/// devices have descriptors that are always ready, which would otherwise
+	/// make the loop spin.
+	auto const MinimumPollInterval = std::chrono::milliseconds{1};
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// render_loop constructor
+		render_loop::render_loop( clock_type::duration fallback_interval ) :
+			_fallback_interval( fallback_interval ),
+			_next_wakeup( clock_type::time_point::max() ),
+			_notified( false ),
+			_abort( false ),
+			_loop_thread_id( std::thread::id{} )
+		{
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+			if( ::pipe( _interrupt_pipe ) != 0 ) {
+				throw backend_exception{};
+			}
+			for( auto fd : _interrupt_pipe ) {
+				::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) | O_NONBLOCK );
+			}
+#endif
+		}
+
+		// render_loop destructor
+		render_loop::~render_loop() {
+			_abort = true;
+			interrupt_wait();
+			if( _thread.joinable() ) {
+				_thread.join();
+			}
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+			::close( _interrupt_pipe[0] );
+			::close( _interrupt_pipe[1] );
+#endif
+		}
+
+		// ensure_running()
+		void render_loop::ensure_running() {
+			if( _thread.joinable() ) {
+				return;
+			}
+			_abort = false;
+			_thread = std::thread{ &render_loop::run, this };
+		}
+
+		// wake_at()
+		void render_loop::wake_at( clock_type::time_point time ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			if( time < _next_wakeup ) {
+				_next_wakeup = time;
+				lock.unlock();
+				interrupt_wait();
+			}
+		}
+
+		// notify()
+		void render_loop::notify() {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_notified = true;
+			lock.unlock();
+			interrupt_wait();
+		}
+
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+		// add_poll_descriptors()
+		void render_loop::add_poll_descriptors( void const* owner, std::vector<pollfd> const& descriptors ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			for( auto const& descriptor : descriptors ) {
+				_descriptors.emplace_back( owner, descriptor );
+			}
+			lock.unlock();
+			interrupt_wait();
+		}
+
+		// remove_poll_descriptors()
+		void render_loop::remove_poll_descriptors( void const* owner ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_descriptors.erase(
+				std::remove_if( std::begin(_descriptors), std::end(_descriptors),
+					[owner]( auto const& entry ) { return entry.first == owner; } ),
+				std::end(_descriptors) );
+			lock.unlock();
+			interrupt_wait();
+		}
+#endif
+
+		// disconnect()
+		void render_loop::disconnect( nod::connection connection ) {
+			if( on_loop_thread() ) {
+				_stale_connections.push_back( std::move(connection) );
+			}
+			else {
+				connection.disconnect();
+			}
+		}
+
+		// wait_for_update()
+		void render_loop::wait_for_update() const {
+			// The signal is locked while it is invoked
+			if( !on_loop_thread() ) {
+				static_cast<void>( on_update.empty() );
+			}
+		}
+
+		// interrupt_wait()
+		void render_loop::interrupt_wait() {
+			if( on_loop_thread() ) {
+				return;
+			}
+			_condition.notify_all();
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+			char byte = 0;
+			static_cast<void>( ::write( _interrupt_pipe[1], &byte, 1 ) );
+#endif
+		}
+
+		// run()
+		void render_loop::run() {
+			_loop_thread_id = std::this_thread::get_id();
+			auto last_update = clock_type::now();
+			while( !_abort ) {
+				wait();
+				if( _abort ) {
+					break;
+				}
+				auto now = clock_type::now();
+				on_update( std::chrono::duration_cast<chirp::duration_type>(now - last_update) );
+				last_update = now;
+				for( auto& connection : _stale_connections ) {
+					connection.disconnect();
+				}
+				_stale_connections.clear();
+			}
+			_loop_thread_id = std::thread::id{};
+		}
+
+		// wait()
+		void render_loop::wait() {
+			// The signal takes a lock of its own, which is held while the
+			// streams call wake_at(), so it is checked before ours is taken
+			auto connected = !on_update.empty();
+			std::unique_lock<std::mutex> lock{_mutex};
+			auto now = clock_type::now();
+			auto deadline = _next_wakeup;
+			if( connected ) {
+				deadline = std::min( deadline, now + _fallback_interval );
+			}
+
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+			if( !_descriptors.empty() && !_notified ) {
+				std::vector<pollfd> descriptors;
+				descriptors.reserve( _descriptors.size() + 1 );
+				descriptors.push_back( pollfd{ _interrupt_pipe[0], POLLIN, 0 } );
+				for( auto const& entry : _descriptors ) {
+					descriptors.push_back( entry.second );
+				}
+				lock.unlock();
+
+				// Round the timeout up, waking up too early would only make
+				// us poll again.
+				int timeout = -1;
+				if( deadline != clock_type::time_point::max() ) {
+					auto remaining = std::chrono::duration_cast<std::chrono::microseconds>( deadline - now ).count();
+					timeout = static_cast<int>( std::max<long long>( 0, (remaining + 999) / 1000 ) );
+				}
+				std::this_thread::sleep_until( _last_poll + MinimumPollInterval );
+				::poll( descriptors.data(), static_cast<nfds_t>(descriptors.size()), timeout );
+
+				char buffer[64];
+				while( ::read( _interrupt_pipe[0], buffer, sizeof(buffer) ) > 0 ) {
+				}
+				_last_poll = clock_type::now();
+				lock.lock();
+			}
+			else
+#endif
+			if( deadline == clock_type::time_point::max() ) {
+				_condition.wait( lock, [this]() {
+					return _notified || _abort || _next_wakeup != clock_type::time_point::max();
+				});
+			}
+			else {
+				_condition.wait_until( lock, deadline, [this, deadline]() {
+					return _notified || _abort || _next_wakeup < deadline;
+				});
+			}
+			_notified = false;
+			_next_wakeup = clock_type::time_point::max();
+		}
+	}   // namespace backend
+}   // namespace chirp
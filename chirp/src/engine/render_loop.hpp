@@ -0,0 +1,141 @@
+#ifndef IG_CHIRP_SRC_ENGINE_RENDER_LOOP_HPP
+#define IG_CHIRP_SRC_ENGINE_RENDER_LOOP_HPP
+
+#include <chirp/audio_format.hpp>
+#include <nod/nod.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	include <poll.h>
+#	define CHIRP_RENDER_LOOP_WITH_POLL
+#endif
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// The play thread of an output device.
+		///
+		/// The render loop invokes its update signal each time one of the
+		/// audio streams connected to it needs to be serviced. Streams tell
+		/// the loop when that is, either by arming a timer with `wake_at()`
+		/// or by registering file descriptors that becomes ready when a
+		/// device period has elapsed. If no stream has told the loop when
+		/// to wake up, it falls back to waking up at a fixed interval.
+		/// The loop doesn't wake up at all while no streams are connected,
+		/// so streams must call `notify()` after connecting to the loop.
+		class render_loop
+		{
+			public:
+				/// Clock used for wakeup deadlines
+				using clock_type = std::chrono::steady_clock;
+
+				/// Create a render loop. The loop thread isn't started until
+				/// `ensure_running()` is called.
+				/// @param fallback_interval   The longest time the loop will
+				///                            sleep while streams are connected.
+				explicit render_loop( clock_type::duration fallback_interval );
+
+				// Not copy-constructable or copy-assignable
+				render_loop( render_loop const& ) = delete;
+				render_loop& operator=( render_loop const& ) = delete;
+
+				/// Destructor, stops the loop thread
+				~render_loop();
+
+				/// Start the loop thread if it is not running.
+				void ensure_running();
+
+				/// Wake the loop up, at the latest, at a given point in time.
+				/// The request only applies to the next wakeup, so it must be
+				/// renewed at each update.
+				/// @param time   The point in time to wake up at
+				void wake_at( clock_type::time_point time );
+
+				/// Wake the loop up as soon as possible
+				void notify();
+
+				/// @returns `true` if called from the loop thread, such as
+				///          from a sample provider
+				bool on_loop_thread() const {
+					return std::this_thread::get_id() == _loop_thread_id.load();
+				}
+
+				/// Disconnect a stream from the update signal. The signal
+				/// is locked while it is invoked, so when called from the
+				/// loop thread the connection is dropped once the update
+				/// has finished, and the stream may be updated until then.
+				/// @param connection   The connection to drop
+				void disconnect( nod::connection connection );
+
+				/// Wait until no stream is being updated, unless called from
+				/// the loop thread. A stream that was stopped from the loop
+				/// thread waits for this before it is destroyed.
+				void wait_for_update() const;
+
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+				/// Wake the loop up when any of a set of file descriptors is
+				/// ready, in addition to the regular wakeups.
+				/// @param owner         Key used to identify the descriptors
+				///                      when they are removed.
+				/// @param descriptors   The descriptors to poll
+				void add_poll_descriptors( void const* owner, std::vector<pollfd> const& descriptors );
+
+				/// Stop polling the descriptors added by an owner
+				/// @param owner   The key that the descriptors were added with
+				void remove_poll_descriptors( void const* owner );
+#endif
+
+				/// Singal that will be will be invoked each update tick
+				/// of the loop thread.
+				nod::signal<void(duration_type const&)> on_update;
+
+			private:
+				/// Loop thread entry point
+				void run();
+
+				/// Block until it is time for the next update
+				void wait();
+
+				/// Interrupt a pending wait, unless called from the loop thread
+				void interrupt_wait();
+
+				/// The longest time to sleep while streams are connected
+				clock_type::duration _fallback_interval;
+				/// The earliest requested wakeup
+				clock_type::time_point _next_wakeup;
+				/// Flag telling if the loop should wake up as soon as possible
+				bool _notified;
+				/// Atomic flag for aborting the loop thread
+				std::atomic<bool> _abort;
+				/// Mutex for syncronizing wakeup requests
+				std::mutex _mutex;
+				/// Condition used for waiting when there is nothing to poll
+				std::condition_variable _condition;
+#if defined(CHIRP_RENDER_LOOP_WITH_POLL)
+				/// Registered descriptors, with their owners
+				std::vector<std::pair<void const*, pollfd>> _descriptors;
+				/// Pipe used for interrupting poll, read end and write end
+				int _interrupt_pipe[2];
+				/// The last time the loop woke up from polling
+				clock_type::time_point _last_poll;
+#endif
+				/// Connections that are dropped after the current update
+				std::vector<nod::connection> _stale_connections;
+				/// Loop thread
+				std::thread _thread;
+				/// Id of the loop thread, which the loop thread sets itself,
+				/// so that any thread may read it while `_thread` is assigned
+				std::atomic<std::thread::id> _loop_thread_id;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_RENDER_LOOP_HPP
@@ -0,0 +1,212 @@
+#include "ring_buffer_scheduler.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	/// The amount of stable playback before an adaptive write-ahead limit
+	/// is shrunk by one period
+	auto const AdaptiveStableDuration = std::chrono::seconds{4};
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// constructor
+		ring_buffer_scheduler::ring_buffer_scheduler( audio_format const& format, byte_count buffer_bytes, byte_count write_ahead_bytes, byte_count period_bytes ) :
+			_format( format ),
+			_buffer_bytes( buffer_bytes - (buffer_bytes % format.bytes_per_frame()) ),
+			// A completely filled buffer can't be told apart from an empty
+			// one, so we always leave one frame unwritten.
+			_write_ahead_bytes( std::min( write_ahead_bytes - (write_ahead_bytes % format.bytes_per_frame()), _buffer_bytes - std::min( _buffer_bytes, format.bytes_per_frame() ) ) ),
+			_period_bytes( std::min( period_bytes - (period_bytes % format.bytes_per_frame()), _write_ahead_bytes.load() ) ),
+			_write_position( 0 ),
+			_last_read_cursor( 0 ),
+			_queued_bytes( 0 ),
+			_latency_bytes( 0 ),
+			_adaptive( false ),
+			// An adaptive limit moves one period at a time, between two
+			// periods and what fits in the buffer with a period to spare
+			_controller(
+				_write_ahead_bytes,
+				2 * _period_bytes,
+				_buffer_bytes - std::min( _buffer_bytes, std::max( _period_bytes, format.bytes_per_frame() ) ),
+				std::max( _period_bytes, format.bytes_per_frame() ),
+				bytes_for( format, AdaptiveStableDuration ) ),
+			_underruns( 0 ),
+			_silence_frames( 0 ),
+			_late_callbacks( 0 )
+		{
+		}
+
+		// constructor
+		ring_buffer_scheduler::ring_buffer_scheduler( audio_format const& format, stream_options const& options ) :
+			ring_buffer_scheduler(
+				format,
+				bytes_for( format, options.buffer_duration() ),
+				bytes_for( format, options.write_ahead() ),
+				bytes_for( format, options.period() ) )
+		{
+			_adaptive = options.adaptive_write_ahead();
+			if( _adaptive ) {
+				_write_ahead_bytes = _controller.write_ahead();
+			}
+		}
+
+		// copy constructor
+		ring_buffer_scheduler::ring_buffer_scheduler( ring_buffer_scheduler const& other ) :
+			_format( other._format ),
+			_buffer_bytes( other._buffer_bytes ),
+			_write_ahead_bytes( other._write_ahead_bytes.load() ),
+			_period_bytes( other._period_bytes ),
+			_write_position( other._write_position ),
+			_last_read_cursor( other._last_read_cursor ),
+			_queued_bytes( other._queued_bytes ),
+			_latency_bytes( other._latency_bytes.load() ),
+			_adaptive( other._adaptive ),
+			_controller( other._controller ),
+			_underruns( other._underruns.load() ),
+			_silence_frames( other._silence_frames.load() ),
+			_late_callbacks( other._late_callbacks.load() ),
+			_underrun_handler( other._underrun_handler )
+		{
+		}
+
+		// bytes_for()
+		ring_buffer_scheduler::byte_count ring_buffer_scheduler::bytes_for( audio_format const& format, std::chrono::nanoseconds duration ) {
+			auto const ns_per_second = std::nano::den;
+			auto count = duration.count();
+			auto frames =
+				static_cast<std::uint64_t>( count / ns_per_second ) * format.frequency() +
+				static_cast<std::uint64_t>( count % ns_per_second ) * format.frequency() / ns_per_second;
+			return static_cast<byte_count>( frames * format.bytes_per_frame() );
+		}
+
+		// configuration()
+		stream_configuration ring_buffer_scheduler::configuration() const {
+			auto bytes_per_frame = _format.bytes_per_frame();
+			return stream_configuration{
+				_format.frequency(),
+				_buffer_bytes / bytes_per_frame,
+				_period_bytes / bytes_per_frame,
+				_write_ahead_bytes / bytes_per_frame };
+		}
+
+		// statistics()
+		stream_statistics ring_buffer_scheduler::statistics() const {
+			return stream_statistics{ _underruns, _silence_frames, _late_callbacks };
+		}
+
+		// written_ahead()
+		ring_buffer_scheduler::byte_count ring_buffer_scheduler::written_ahead( byte_count read_cursor ) const {
+			return distance( read_cursor, _write_position );
+		}
+
+		// plan()
+		ring_buffer_scheduler::schedule ring_buffer_scheduler::plan( byte_count read_cursor, byte_count write_cursor, std::chrono::nanoseconds elapsed ) {
+			// The cursors only tell how far the device has played modulo the
+			// buffer size, the elapsed time tells how many whole laps around
+			// the buffer it has made on top of that.
+			std::uint64_t played = distance( _last_read_cursor, read_cursor );
+			std::uint64_t expected = bytes_for( _format, elapsed );
+			if( expected > played + _buffer_bytes / 2 ) {
+				played += ((expected - played + _buffer_bytes / 2) / _buffer_bytes) * _buffer_bytes;
+			}
+
+			// If the device has played everything that was queued since the
+			// last time, it has run past the write position and is playing
+			// old samples.
+			auto started = _queued_bytes > 0;
+			auto underrun = started && played >= _queued_bytes;
+			auto written_ahead_bytes = underrun ? 0 : written_ahead( read_cursor );
+
+			// The device may already be playing the samples between its read
+			// and write cursor, so we can't write there
+			auto unsafe_bytes = distance( read_cursor, write_cursor );
+			if( underrun || written_ahead_bytes < unsafe_bytes ) {
+				_write_position = write_cursor;
+				written_ahead_bytes = unsafe_bytes;
+			}
+
+			// Being serviced with less than half a period left is a close call
+			auto late = started && !underrun && written_ahead_bytes < _period_bytes / 2;
+			if( late ) {
+				++_late_callbacks;
+			}
+			if( underrun ) {
+				++_underruns;
+				_silence_frames += (played - _queued_bytes) / _format.bytes_per_frame();
+				if( _underrun_handler ) {
+					_underrun_handler( statistics() );
+				}
+			}
+			if( _adaptive && started ) {
+				_write_ahead_bytes = _controller.update( underrun, late, static_cast<byte_count>( std::min<std::uint64_t>( played, _buffer_bytes ) ) );
+			}
+			_last_read_cursor = read_cursor;
+			_queued_bytes = written_ahead_bytes;
+			_latency_bytes.store( written_ahead_bytes, std::memory_order_release );
+			return schedule_after( written_ahead_bytes );
+		}
+
+		// plan_consumed()
+		ring_buffer_scheduler::schedule ring_buffer_scheduler::plan_consumed() {
+			// Nothing is queued, so the device can't have run out of samples
+			_last_read_cursor = _write_position;
+			_queued_bytes = 0;
+			_latency_bytes.store( 0, std::memory_order_release );
+			return schedule_after( 0 );
+		}
+
+		// schedule_after()
+		ring_buffer_scheduler::schedule ring_buffer_scheduler::schedule_after( byte_count written_ahead_bytes ) const {
+			// Let's check if we need to wait until we can write more data to the buffer
+			schedule result{ {}, 0 };
+			byte_count limit = _write_ahead_bytes;
+			if( written_ahead_bytes >= limit ) {
+				return result;
+			}
+
+			// Write from the last write position up to the write-ahead limit,
+			// wrapping around at the end of the buffer
+			auto byte_count = limit - written_ahead_bytes;
+			auto size1 = std::min( byte_count, _buffer_bytes - _write_position );
+			result.regions[result.count++] = region{ _write_position, size1 };
+			if( byte_count > size1 ) {
+				result.regions[result.count++] = region{ 0, byte_count - size1 };
+			}
+			return result;
+		}
+
+		// commit()
+		void ring_buffer_scheduler::commit( byte_count size ) {
+			_write_position += size;
+			if( _write_position >= _buffer_bytes ) {
+				_write_position -= _buffer_bytes;
+			}
+			_queued_bytes += size;
+			_latency_bytes.store( _queued_bytes, std::memory_order_release );
+		}
+
+		// refill_delay()
+		std::chrono::nanoseconds ring_buffer_scheduler::refill_delay( byte_count read_cursor ) const {
+			auto written_ahead_bytes = written_ahead( read_cursor );
+			byte_count limit = _write_ahead_bytes;
+			auto refill_bytes = limit - std::min( limit, _period_bytes );
+			if( written_ahead_bytes <= refill_bytes ) {
+				return std::chrono::nanoseconds::zero();
+			}
+			auto wait_bytes = static_cast<std::uint64_t>( written_ahead_bytes - refill_bytes );
+			return std::chrono::nanoseconds( (wait_bytes * std::nano::den) / _format.bytes_per_second() );
+		}
+
+		// reset()
+		void ring_buffer_scheduler::reset() {
+			_write_position = 0;
+			_last_read_cursor = 0;
+			_queued_bytes = 0;
+			_latency_bytes.store( 0, std::memory_order_release );
+		}
+	}   // namespace backend
+}   // namespace chirp
@@ -0,0 +1,252 @@
+#ifndef IG_CHIRP_SRC_ENGINE_RING_BUFFER_SCHEDULER_HPP
+#define IG_CHIRP_SRC_ENGINE_RING_BUFFER_SCHEDULER_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/stream_options.hpp>
+#include <chirp/stream_statistics.hpp>
+
+#include "write_ahead_controller.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Scheduler for writing samples ahead of a device read cursor in a
+		/// ring buffer.
+		///
+		/// The scheduler keeps track of the position where the last write
+		/// ended, and decides which regions of the ring buffer that should
+		/// be filled next, given the current read cursor of the device. It
+		/// keeps at most `write_ahead_bytes()` of samples queued ahead of
+		/// the read cursor, and never schedules writes into the unsafe
+		/// region between the read and write cursors of the device.
+		///
+		/// The scheduler also detects when the device has played past the
+		/// samples that were written to it, and resyncs the write position
+		/// ahead of the device. The write-ahead limit can optionally be
+		/// adapted to how well the stream keeps up, see
+		/// `write_ahead_controller`.
+		///
+		/// All positions and sizes are in bytes, and are always multiples
+		/// of the frame size of the audio format.
+		class ring_buffer_scheduler
+		{
+			public:
+				/// Integral type for byte counts and buffer positions
+				using byte_count = audio_format::byte_count;
+
+				/// A contiguous region of the ring buffer
+				struct region
+				{
+					/// Buffer position of the start of the region
+					byte_count offset;
+					/// Size of the region
+					byte_count size;
+				};
+
+				/// The regions that should be written to next. There are two
+				/// regions when the write wraps around the end of the buffer.
+				struct schedule
+				{
+					/// The regions, in the order they should be written
+					std::array<region, 2> regions;
+					/// The number of regions that are used
+					std::size_t count;
+
+					/// @returns The total size of all regions
+					byte_count size() const {
+						byte_count result = 0;
+						for( std::size_t i=0; i<count; ++i ) {
+							result += regions[i].size;
+						}
+						return result;
+					}
+				};
+
+				/// Create a scheduler for a ring buffer
+				/// @param format              The audio format of the buffer
+				/// @param buffer_bytes        The size of the ring buffer
+				/// @param write_ahead_bytes   The maximum amount of samples
+				///                            to keep ahead of the read cursor.
+				///                            Limited to the buffer size.
+				/// @param period_bytes        The amount of samples that have
+				///                            to be played before there is
+				///                            any point in writing again.
+				ring_buffer_scheduler( audio_format const& format, byte_count buffer_bytes, byte_count write_ahead_bytes, byte_count period_bytes );
+
+				/// Create a scheduler for a ring buffer with the sizes
+				/// requested by stream options.
+				/// @param format    The audio format of the buffer
+				/// @param options   The requested buffer configuration
+				ring_buffer_scheduler( audio_format const& format, stream_options const& options );
+
+				/// Copy constructor
+				ring_buffer_scheduler( ring_buffer_scheduler const& other );
+
+				// Not copy-assignable
+				ring_buffer_scheduler& operator=( ring_buffer_scheduler const& ) = delete;
+
+				/// Calculate the number of whole frames that fits in a
+				/// duration, in bytes.
+				/// @param format     The audio format of the frames
+				/// @param duration   The duration
+				/// @returns The size of the frames, in bytes
+				static byte_count bytes_for( audio_format const& format, std::chrono::nanoseconds duration );
+
+				/// @returns The size of the ring buffer
+				byte_count buffer_bytes() const {
+					return _buffer_bytes;
+				}
+
+				/// @returns The maximum amount of samples to write ahead. This
+				///          may be read from any thread.
+				byte_count write_ahead_bytes() const {
+					return _write_ahead_bytes;
+				}
+
+				/// @returns `true` if the write-ahead limit is adaptive
+				bool adaptive() const {
+					return _adaptive;
+				}
+
+				/// @returns The size of a period
+				byte_count period_bytes() const {
+					return _period_bytes;
+				}
+
+				/// @returns The buffer configuration, in frames
+				stream_configuration configuration() const;
+
+				/// @returns The underrun counters. This may be called from
+				///          any thread.
+				stream_statistics statistics() const;
+
+				/// Set the function that is called from `plan()` when an
+				/// underrun has been detected. Must not be called while
+				/// `plan()` may be running on another thread.
+				/// @param f   The handler
+				void set_underrun_handler( underrun_handler_func f ) {
+					_underrun_handler = std::move(f);
+				}
+
+				/// @returns The time it takes the device to play the samples
+				///          that were queued ahead of its read cursor as of
+				///          the last call to `plan()` or `commit()`, which is
+				///          also when the next write will be played. This may
+				///          be read from any thread.
+				std::chrono::nanoseconds latency() const {
+					return _format.duration_of( _latency_bytes.load( std::memory_order_acquire ) / _format.bytes_per_frame() );
+				}
+
+				/// @returns The buffer position where the next write starts
+				byte_count write_position() const {
+					return _write_position;
+				}
+
+				/// Calculate the amount of samples that are queued ahead of
+				/// a read cursor.
+				/// @param read_cursor   The read cursor of the device
+				/// @returns The number of bytes between the read cursor and
+				///          the write position.
+				byte_count written_ahead( byte_count read_cursor ) const;
+
+				/// Decide which regions that should be written next.
+				///
+				/// If the device has played past the write position, or the
+				/// write position is inside the unsafe region, the write
+				/// position is moved to the write cursor of the device.
+				/// @param read_cursor    The read cursor of the device
+				/// @param write_cursor   The write cursor of the device, which
+				///                       is the end of the unsafe region.
+				/// @param elapsed        The time since the last call, if known.
+				///                       It is used for telling how many times
+				///                       the device has wrapped around the
+				///                       buffer during long stalls.
+				/// @returns The regions to write, which may be empty
+				schedule plan( byte_count read_cursor, byte_count write_cursor, std::chrono::nanoseconds elapsed = std::chrono::nanoseconds::zero() );
+
+				/// Decide which regions that should be written next, for
+				/// devices without an unsafe region.
+				/// @param read_cursor    The read cursor of the device
+				/// @param elapsed        The time since the last call, if known
+				/// @returns The regions to write, which may be empty
+				schedule plan( byte_count read_cursor, std::chrono::nanoseconds elapsed = std::chrono::nanoseconds::zero() ) {
+					return plan( read_cursor, read_cursor, elapsed );
+				}
+
+				/// Decide which regions that should be written next, for
+				/// devices that consume the samples as soon as they are
+				/// written, such as a file. Nothing is ever queued ahead of
+				/// such a device, so no underruns or late services are
+				/// counted.
+				/// @returns The regions to write, up to the write-ahead limit
+				schedule plan_consumed();
+
+				/// Move the write position forward after samples have been
+				/// written at the write position.
+				/// @param size   The number of bytes that were written
+				void commit( byte_count size );
+
+				/// Calculate how long the device can play before there is
+				/// room for another period below the write-ahead limit.
+				/// @param read_cursor   The read cursor of the device
+				/// @returns The time until the samples should be refilled
+				std::chrono::nanoseconds refill_delay( byte_count read_cursor ) const;
+
+				/// Move the write position back to the start of the buffer,
+				/// before the device starts reading from it.
+				void reset();
+
+			private:
+				/// Schedule the regions from the write position up to the
+				/// write-ahead limit
+				/// @param written_ahead_bytes   The amount of samples that
+				///                              are queued
+				/// @returns The regions to write, which may be empty
+				schedule schedule_after( byte_count written_ahead_bytes ) const;
+
+				/// Distance from one position to another, wrapping around
+				byte_count distance( byte_count from, byte_count to ) const {
+					return (to >= from) ? (to - from) : (_buffer_bytes - from + to);
+				}
+
+				/// Audio format of the buffer
+				audio_format _format;
+				/// The size of the ring buffer
+				byte_count _buffer_bytes;
+				/// The maximum amount of samples to write ahead
+				std::atomic<byte_count> _write_ahead_bytes;
+				/// The size of a period
+				byte_count _period_bytes;
+				/// The buffer position where we stopped writing last time
+				byte_count _write_position;
+				/// The read cursor at the last call to `plan()`
+				byte_count _last_read_cursor;
+				/// The amount of samples queued ahead of the last read cursor
+				byte_count _queued_bytes;
+				/// The amount of samples queued after the last write
+				std::atomic<byte_count> _latency_bytes;
+				/// Whether the write-ahead limit is adaptive
+				bool _adaptive;
+				/// Controller for the write-ahead limit, if it is adaptive
+				write_ahead_controller _controller;
+				/// Number of underruns
+				std::atomic<stream_statistics::counter_type> _underruns;
+				/// Number of frames played without samples
+				std::atomic<stream_statistics::counter_type> _silence_frames;
+				/// Number of services with less than half a period left
+				std::atomic<stream_statistics::counter_type> _late_callbacks;
+				/// Function to call when an underrun is detected
+				underrun_handler_func _underrun_handler;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_RING_BUFFER_SCHEDULER_HPP
@@ -0,0 +1,408 @@
+#include "sample_conversion.hpp"
+
+#include <chirp/exceptions.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	/// Number of samples that are converted through float at a time
+	std::size_t const BlockSamples = 1024;
+
+	/// Clamp a float sample to the range -1.0 to 1.0
+	inline float clamp( float sample ) {
+		return std::min( 1.0f, std::max( -1.0f, sample ) );
+	}
+
+	/// Convert float samples to interleaved integer samples of the native
+	/// byte order. The channel count is a template parameter for the
+	/// common layouts, so that the inner loop has a constant stride and
+	/// can be vectorized.
+	/// @tparam T          The integral sample type
+	/// @tparam Channels   The number of channels, or 0 if it is only known
+	///                    at run time
+	template <class T, std::size_t Channels>
+	void interleave_native( float const* const* channels, std::size_t channel_count, std::size_t frames, float scale, float offset, T* target ) {
+		auto stride = Channels == 0 ? channel_count : Channels;
+		for( std::size_t c=0; c<stride; ++c ) {
+			float const* source = channels[c];
+			T* ptr = target + c;
+			for( std::size_t i=0; i<frames; ++i ) {
+				ptr[i * stride] = static_cast<T>( clamp(source[i]) * scale + offset );
+			}
+		}
+	}
+
+	/// Convert float samples to interleaved integer samples of the native
+	/// byte order, picking a specialized loop for mono and stereo
+	template <class T>
+	void interleave_native( float const* const* channels, std::size_t channel_count, std::size_t frames, float scale, float offset, T* target ) {
+		switch( channel_count ) {
+			case 1:
+				interleave_native<T, 1>( channels, channel_count, frames, scale, offset, target );
+				break;
+			case 2:
+				interleave_native<T, 2>( channels, channel_count, frames, scale, offset, target );
+				break;
+			default:
+				interleave_native<T, 0>( channels, channel_count, frames, scale, offset, target );
+				break;
+		}
+	}
+
+	/// Convert float samples to interleaved floating point samples of the
+	/// native byte order. They aren't clamped, as floating point formats
+	/// can hold samples beyond full scale.
+	/// @tparam T   The floating point sample type
+	template <class T>
+	void interleave_float( float const* const* channels, std::size_t channel_count, std::size_t frames, T* target ) {
+		for( std::size_t c=0; c<channel_count; ++c ) {
+			float const* source = channels[c];
+			T* ptr = target + c;
+			for( std::size_t i=0; i<frames; ++i ) {
+				ptr[i * channel_count] = static_cast<T>( source[i] );
+			}
+		}
+	}
+
+	/// Convert float samples to interleaved packed 24 bit samples
+	void interleave_packed_24( float const* const* channels, std::size_t channel_count, std::size_t frames, float offset, bool little_endian, std::uint8_t* target ) {
+		for( std::size_t i=0; i<frames; ++i ) {
+			for( std::size_t c=0; c<channel_count; ++c ) {
+				auto value = static_cast<std::uint32_t>( static_cast<std::int32_t>( clamp(channels[c][i]) * 8388607.0f + offset ) );
+				if( little_endian ) {
+					target[0] = static_cast<std::uint8_t>( value );
+					target[1] = static_cast<std::uint8_t>( value >> 8 );
+					target[2] = static_cast<std::uint8_t>( value >> 16 );
+				}
+				else {
+					target[0] = static_cast<std::uint8_t>( value >> 16 );
+					target[1] = static_cast<std::uint8_t>( value >> 8 );
+					target[2] = static_cast<std::uint8_t>( value );
+				}
+				target += 3;
+			}
+		}
+	}
+
+	/// Reverse the byte order of each sample in a buffer, with the vector
+	/// kernels for samples of 2, 4 and 8 bytes
+	void swap_byte_order( chirp::backend::conversion_kernels const& kernels, std::uint8_t* ptr, std::size_t size, std::size_t bytes_per_sample ) {
+		auto count = size / bytes_per_sample;
+		switch( bytes_per_sample ) {
+			case 2:
+				kernels.swap16( ptr, count );
+				break;
+			case 4:
+				kernels.swap32( ptr, count );
+				break;
+			case 8:
+				kernels.swap64( ptr, count );
+				break;
+			default:
+				for( std::size_t i=0; i<count; ++i ) {
+					std::reverse( ptr + i * bytes_per_sample, ptr + (i + 1) * bytes_per_sample );
+				}
+				break;
+		}
+	}
+
+	/// Calculate the scale of integer samples. The scale of 32 bit samples
+	/// is the largest float below 2^31, as 2147483647 can't be represented
+	/// and would overflow.
+	float integer_scale( chirp::sample_format const& format ) {
+		auto bits = format.bits_per_sample();
+		return bits == 32 ? 2147483520.0f : static_cast<float>( (std::uint32_t{1} << (bits - 1)) - 1 );
+	}
+
+	/// Read a sample of up to eight bytes
+	std::uint64_t load( std::uint8_t const* ptr, std::size_t bytes, bool little_endian ) {
+		std::uint64_t value = 0;
+		for( std::size_t i=0; i<bytes; ++i ) {
+			auto shift = 8 * (little_endian ? i : bytes - 1 - i);
+			value |= std::uint64_t{ptr[i]} << shift;
+		}
+		return value;
+	}
+
+	/// Write the lower bytes of a value as a sample
+	void store( std::uint8_t* ptr, std::size_t bytes, bool little_endian, std::uint64_t value ) {
+		for( std::size_t i=0; i<bytes; ++i ) {
+			auto shift = 8 * (little_endian ? i : bytes - 1 - i);
+			ptr[i] = static_cast<std::uint8_t>( value >> shift );
+		}
+	}
+
+	/// Convert samples of any format to float samples, one at a time
+	void decode_generic( std::uint8_t const* source, float* target, std::size_t count, chirp::sample_format const& format, float inverse_scale ) {
+		auto bytes = format.bytes_per_sample();
+		auto little_endian = bytes == 1 || format.endianness() == chirp::byte_order::little_endian;
+		auto type = format.type();
+		auto bits = format.bits_per_sample();
+		for( std::size_t i=0; i<count; ++i ) {
+			auto raw = load( source + i * bytes, bytes, little_endian );
+			if( type == chirp::sample_type::floating_point ) {
+				if( bytes == 4 ) {
+					auto value = static_cast<std::uint32_t>( raw );
+					std::memcpy( &target[i], &value, sizeof(float) );
+				}
+				else {
+					double value;
+					std::memcpy( &value, &raw, sizeof(double) );
+					target[i] = static_cast<float>( value );
+				}
+			}
+			else {
+				// Signed samples are sign extended from their significant
+				// bits, unsigned ones are moved down from the middle of
+				// their range
+				std::int64_t value;
+				if( type == chirp::sample_type::unsigned_integer ) {
+					value = static_cast<std::int64_t>( raw & ((std::uint64_t{1} << bits) - 1) ) - (std::int64_t{1} << (bits - 1));
+				}
+				else {
+					value = static_cast<std::int64_t>( raw << (64 - bits) ) >> (64 - bits);
+				}
+				target[i] = static_cast<float>( value ) * inverse_scale;
+			}
+		}
+	}
+
+	/// Convert float samples to samples of any format, one at a time
+	void encode_generic( float const* source, std::uint8_t* target, std::size_t count, chirp::sample_format const& format, float scale ) {
+		auto bytes = format.bytes_per_sample();
+		auto little_endian = bytes == 1 || format.endianness() == chirp::byte_order::little_endian;
+		auto type = format.type();
+		auto bits = format.bits_per_sample();
+		for( std::size_t i=0; i<count; ++i ) {
+			std::uint64_t raw;
+			if( type == chirp::sample_type::floating_point ) {
+				if( bytes == 4 ) {
+					std::uint32_t value;
+					std::memcpy( &value, &source[i], sizeof(float) );
+					raw = value;
+				}
+				else {
+					auto value = static_cast<double>( source[i] );
+					std::memcpy( &raw, &value, sizeof(double) );
+				}
+			}
+			else {
+				// Signed samples are sign extended into their container
+				auto value = static_cast<std::int64_t>( static_cast<std::int32_t>( clamp(source[i]) * scale ) );
+				if( type == chirp::sample_type::unsigned_integer ) {
+					value += std::int64_t{1} << (bits - 1);
+				}
+				raw = static_cast<std::uint64_t>( value );
+			}
+			store( target + i * bytes, bytes, little_endian, raw );
+		}
+	}
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// interleave()
+		void interleave( float const* const* channels, std::size_t frames, sample_format const& format, void* target ) {
+			std::size_t channel_count = format.channels();
+			auto bytes_per_sample = format.bytes_per_sample();
+			if( format.type() == sample_type::floating_point ) {
+				if( bytes_per_sample == 4 ) {
+					interleave_float( channels, channel_count, frames, static_cast<float*>(target) );
+				}
+				else {
+					interleave_float( channels, channel_count, frames, static_cast<double*>(target) );
+				}
+			}
+			else {
+				// Integers are scaled to the range of their significant bits,
+				// and unsigned ones are offset to the middle of it
+				auto bits = format.bits_per_sample();
+				auto is_unsigned = format.type() == sample_type::unsigned_integer;
+				auto scale = integer_scale( format );
+				auto offset = is_unsigned && bits < 32 ? static_cast<float>( std::uint32_t{1} << (bits - 1) ) : 0.0f;
+				switch( bytes_per_sample ) {
+					case 1:
+						if( is_unsigned ) {
+							interleave_native( channels, channel_count, frames, scale, offset, static_cast<std::uint8_t*>(target) );
+						}
+						else {
+							interleave_native( channels, channel_count, frames, scale, offset, static_cast<std::int8_t*>(target) );
+						}
+						return;
+					case 2:
+						if( is_unsigned ) {
+							interleave_native( channels, channel_count, frames, scale, offset, static_cast<std::uint16_t*>(target) );
+						}
+						else {
+							interleave_native( channels, channel_count, frames, scale, offset, static_cast<std::int16_t*>(target) );
+						}
+						break;
+					case 3:
+						interleave_packed_24( channels, channel_count, frames, offset, format.endianness() == byte_order::little_endian, static_cast<std::uint8_t*>(target) );
+						return;
+					case 4: {
+						// The offset of unsigned 32 bit samples can't be added
+						// exactly in float, so the sign bit is flipped instead
+						auto* samples = static_cast<std::int32_t*>(target);
+						interleave_native( channels, channel_count, frames, scale, offset, samples );
+						if( is_unsigned && bits == 32 ) {
+							auto* ptr = static_cast<std::uint32_t*>(target);
+							for( std::size_t i=0; i<frames * channel_count; ++i ) {
+								ptr[i] ^= 0x80000000u;
+							}
+						}
+						break;
+					}
+					default:
+						std::memset( target, 0, frames * format.bytes_per_frame() );
+						return;
+				}
+			}
+			if( format.endianness() != native_byte_order ) {
+				swap_byte_order( kernels_for( detected_simd_level() ), static_cast<std::uint8_t*>(target), frames * format.bytes_per_frame(), bytes_per_sample );
+			}
+		}
+
+		//-----------------------------------------------------------------
+		// sample_converter implementation
+		//-----------------------------------------------------------------
+
+		// sample_converter constructor
+		sample_converter::sample_converter( sample_format const& source, sample_format const& target, simd_level level ) :
+			_source( source ),
+			_target( target ),
+			_kernels( &kernels_for( level ) ),
+			_method( method::pivot ),
+			_decoding( codec_for( source ) ),
+			_encoding( codec_for( target ) ),
+			_swap_source( _decoding != codec::generic && source.bytes_per_sample() > 1 && source.endianness() != native_byte_order ),
+			_swap_target( _encoding != codec::generic && target.bytes_per_sample() > 1 && target.endianness() != native_byte_order ),
+			_scale( 0.0f ),
+			_inverse_scale( 0.0f )
+		{
+			if( source.channels() != target.channels() ) {
+				throw sample_format_exception{};
+			}
+			if( source == target ) {
+				_method = method::copy;
+			}
+			else if( source.bytes_per_sample() > 1 ) {
+				auto swapped = source.endianness() == byte_order::little_endian ? byte_order::big_endian : byte_order::little_endian;
+				if( target == source.in_byte_order( swapped ) ) {
+					_method = method::swap;
+				}
+			}
+			if( target.type() != sample_type::floating_point ) {
+				_scale = integer_scale( target );
+			}
+			if( source.type() != sample_type::floating_point ) {
+				auto scale = integer_scale( source );
+				_inverse_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+			}
+		}
+
+		// sample_converter::convert()
+		void sample_converter::convert( void const* source, std::size_t frames, void* target ) const {
+			if( converts_in_place() ) {
+				std::memcpy( target, source, frames * _source.bytes_per_frame() );
+				convert_in_place( target, frames );
+				return;
+			}
+
+			// Samples are independent of their channel, so the blocks don't
+			// have to end at frame boundaries
+			std::array<float, BlockSamples> block;
+			std::array<std::uint32_t, BlockSamples> swapped;
+			auto const* input = static_cast<std::uint8_t const*>( source );
+			auto* output = static_cast<std::uint8_t*>( target );
+			auto samples = frames * _source.channels();
+			while( samples > 0 ) {
+				auto count = std::min( samples, BlockSamples );
+				if( _swap_source ) {
+					// Samples of the vector codecs are at most 4 bytes
+					std::memcpy( swapped.data(), input, count * _source.bytes_per_sample() );
+					swap_byte_order( *_kernels, reinterpret_cast<std::uint8_t*>(swapped.data()), count * _source.bytes_per_sample(), _source.bytes_per_sample() );
+					decode( reinterpret_cast<std::uint8_t const*>(swapped.data()), block.data(), count );
+				}
+				else {
+					decode( input, block.data(), count );
+				}
+				encode( block.data(), output, count );
+				if( _swap_target ) {
+					swap_byte_order( *_kernels, output, count * _target.bytes_per_sample(), _target.bytes_per_sample() );
+				}
+				input += count * _source.bytes_per_sample();
+				output += count * _target.bytes_per_sample();
+				samples -= count;
+			}
+		}
+
+		// sample_converter::convert_in_place()
+		void sample_converter::convert_in_place( void* buffer, std::size_t frames ) const {
+			if( _method == method::swap ) {
+				swap_byte_order( *_kernels, static_cast<std::uint8_t*>(buffer), frames * _target.bytes_per_frame(), _target.bytes_per_sample() );
+			}
+		}
+
+		// sample_converter::decode()
+		void sample_converter::decode( std::uint8_t const* source, float* target, std::size_t count ) const {
+			switch( _decoding ) {
+				case codec::float32:
+					std::memcpy( target, source, count * sizeof(float) );
+					break;
+				case codec::int16:
+					_kernels->decode_int16( reinterpret_cast<std::int16_t const*>(source), target, count );
+					break;
+				case codec::int32:
+					_kernels->decode_int32( reinterpret_cast<std::int32_t const*>(source), target, count, _inverse_scale );
+					break;
+				case codec::generic:
+					decode_generic( source, target, count, _source, _inverse_scale );
+					break;
+			}
+		}
+
+		// sample_converter::encode()
+		void sample_converter::encode( float const* source, std::uint8_t* target, std::size_t count ) const {
+			switch( _encoding ) {
+				case codec::float32:
+					std::memcpy( target, source, count * sizeof(float) );
+					break;
+				case codec::int16:
+					_kernels->encode_int16( source, reinterpret_cast<std::int16_t*>(target), count );
+					break;
+				case codec::int32:
+					_kernels->encode_int32( source, reinterpret_cast<std::int32_t*>(target), count, _scale );
+					break;
+				case codec::generic:
+					encode_generic( source, target, count, _target, _scale );
+					break;
+			}
+		}
+
+		// sample_converter::codec_for()
+		sample_converter::codec sample_converter::codec_for( sample_format const& format ) {
+			// Samples of the other byte order are swapped before decoding
+			// and after encoding
+			auto bytes = format.bytes_per_sample();
+			switch( format.type() ) {
+				case sample_type::floating_point:
+					return bytes == 4 ? codec::float32 : codec::generic;
+				case sample_type::signed_integer:
+					if( bytes == 2 && format.bits_per_sample() == 16 ) {
+						return codec::int16;
+					}
+					return bytes == 4 ? codec::int32 : codec::generic;
+				case sample_type::unsigned_integer:
+					break;
+			}
+			return codec::generic;
+		}
+	}   // namespace backend
+}   // namespace chirp
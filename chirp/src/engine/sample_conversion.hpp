@@ -0,0 +1,139 @@
+#ifndef IG_CHIRP_SRC_ENGINE_SAMPLE_CONVERSION_HPP
+#define IG_CHIRP_SRC_ENGINE_SAMPLE_CONVERSION_HPP
+
+#include <chirp/sample_format.hpp>
+#include "conversion_kernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Convert planar float samples to interleaved samples of a sample
+		/// format.
+		///
+		/// For integer formats, float samples are clamped to the range
+		/// -1.0 to 1.0, scaled to the full range of the significant bits
+		/// and truncated towards zero. Unsigned samples are offset to the
+		/// middle of their range. Floating point formats get the samples
+		/// as they are. Samples wider than a byte are written in the byte
+		/// order of the format.
+		///
+		/// @param channels   Pointers to the samples of each channel, one
+		///                   for each channel of the format
+		/// @param frames     The number of samples of each channel
+		/// @param format     The sample format to convert to
+		/// @param target     Buffer for `frames` interleaved frames
+		void interleave( float const* const* channels, std::size_t frames, sample_format const& format, void* target );
+
+		/// Converts interleaved samples from one sample format to another
+		/// with the same number of channels.
+		///
+		/// Samples that only differ in byte order are swapped, which is
+		/// lossless and can be done in place. Other conversions go through
+		/// float samples, which hold 24 significant bits. Integer samples
+		/// are scaled like `interleave()` does, and clamped to full scale
+		/// on the way back. 16 bit, 32 bit and float samples are converted
+		/// by the vector kernels of a SIMD level, and swapped by them if
+		/// they are in the other byte order. Everything else is converted
+		/// a sample at a time.
+		class sample_converter
+		{
+			public:
+				/// Create a converter
+				/// @param source   The sample format to convert from
+				/// @param target   The sample format to convert to
+				/// @param level    The instruction set level of the kernels
+				/// @throws sample_format_exception if the formats have
+				///         different channel counts
+				sample_converter( sample_format const& source, sample_format const& target, simd_level level = detected_simd_level() );
+
+				/// Convert interleaved frames
+				/// @param source   The frames in the source format
+				/// @param frames   The number of frames
+				/// @param target   Buffer for the frames in the target format,
+				///                 which must not overlap the source
+				void convert( void const* source, std::size_t frames, void* target ) const;
+
+				/// @returns `true` if the frames are the same size in both
+				///          formats, and can be converted in place
+				bool converts_in_place() const {
+					return _method != method::pivot;
+				}
+
+				/// Convert interleaved frames within a buffer
+				/// @param buffer   The frames in the source format, which
+				///                 are overwritten in the target format
+				/// @param frames   The number of frames
+				/// @pre converts_in_place()
+				void convert_in_place( void* buffer, std::size_t frames ) const;
+
+				/// @returns The sample format that is converted from
+				sample_format const& source_format() const {
+					return _source;
+				}
+
+				/// @returns The sample format that is converted to
+				sample_format const& target_format() const {
+					return _target;
+				}
+
+			private:
+				/// How samples are converted to and from float
+				enum class codec {
+					/// Float samples, which are copied
+					float32,
+					/// Signed 16 bit samples
+					int16,
+					/// Signed samples in 32 bit containers
+					int32,
+					/// Anything else, a sample at a time
+					generic
+				};
+
+				/// How frames are converted
+				enum class method {
+					/// The formats are the same
+					copy,
+					/// The formats only differ in byte order
+					swap,
+					/// Through float samples
+					pivot
+				};
+
+				/// Convert samples of the source format to float samples
+				void decode( std::uint8_t const* source, float* target, std::size_t count ) const;
+
+				/// Convert float samples to samples of the target format
+				void encode( float const* source, std::uint8_t* target, std::size_t count ) const;
+
+				/// Pick the codec of a format
+				static codec codec_for( sample_format const& format );
+
+				/// Sample format to convert from
+				sample_format _source;
+				/// Sample format to convert to
+				sample_format _target;
+				/// The vector kernels
+				conversion_kernels const* _kernels;
+				/// How frames are converted
+				method _method;
+				/// Codec of the source format
+				codec _decoding;
+				/// Codec of the target format
+				codec _encoding;
+				/// Whether source samples are swapped before decoding
+				bool _swap_source;
+				/// Whether target samples are swapped after encoding
+				bool _swap_target;
+				/// Scale of integer target samples
+				float _scale;
+				/// Inverse of the scale of integer source samples
+				float _inverse_scale;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_SAMPLE_CONVERSION_HPP
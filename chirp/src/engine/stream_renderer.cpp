@@ -0,0 +1,290 @@
+#include "stream_renderer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	/// Weight of the latest callback in the moving average of the load
+	float const LoadSmoothing = 1.0f / 16.0f;
+
+	/// Number of frames that are rendered at a time before conversion to
+	/// the device format
+	std::size_t const ConversionFrames = 1024;
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		// constructor
+		stream_renderer::stream_renderer( audio_format const& format, stream_options const& options ) :
+			_format( format ),
+			_sample_provider( nullptr ),
+			_function_provider( audio_stream::sample_provider_func{} ),
+			_planar_provider( format ),
+			_rendered_frames( 0 ),
+			_quantum_bytes( options.render_quantum() * format.bytes_per_frame() ),
+			_staging( _quantum_bytes, 0 ),
+			_staged_bytes( 0 ),
+			_resample_quality( options.resampler_quality() ),
+			_device_frequency( format.frequency() ),
+			_pending_frames( 0 ),
+			_pending_offset( 0 ),
+			_callbacks( 0 ),
+			_load( 0.0f ),
+			_peak_load( 0.0f ),
+			_over_budget( 0 ),
+			_budget_fraction( 1.0f )
+		{
+			for( auto& bin : _histogram ) {
+				bin = 0;
+			}
+		}
+
+		// set_device_format()
+		void stream_renderer::set_device_format( audio_format const& format ) {
+			_device_frequency = format.frequency();
+			_pending_frames = 0;
+			if( format.frequency() != _format.frequency() ) {
+				// Blocks of the stream are resampled as float samples, and
+				// then converted to the device format
+				auto channels = _format.sample_format().channels();
+				sample_format float_format{ sample_type::floating_point, 32, native_byte_order, channels };
+				_converter = std::make_unique<sample_converter>( float_format, format.sample_format() );
+				_resampler = std::make_unique<resampler>( channels, static_cast<double>( format.frequency() ) / _format.frequency(), _resample_quality );
+				if( _format.sample_format() == float_format ) {
+					_to_float.reset();
+					_conversion.clear();
+				}
+				else {
+					_to_float = std::make_unique<sample_converter>( _format.sample_format(), float_format );
+					_conversion.assign( ConversionFrames * _format.bytes_per_frame(), 0 );
+				}
+				_resample_input.assign( ConversionFrames * channels, 0.0f );
+				_resample_output.assign( ConversionFrames * channels, 0.0f );
+				return;
+			}
+
+			_resampler.reset();
+			_to_float.reset();
+			_resample_input.clear();
+			_resample_output.clear();
+			if( format.sample_format() == _format.sample_format() ) {
+				_converter.reset();
+				_conversion.clear();
+				return;
+			}
+			_converter = std::make_unique<sample_converter>( _format.sample_format(), format.sample_format() );
+			if( _converter->converts_in_place() ) {
+				_conversion.clear();
+			}
+			else {
+				_conversion.assign( ConversionFrames * _format.bytes_per_frame(), 0 );
+			}
+		}
+
+		// render()
+		void stream_renderer::render( void* ptr, byte_count size, time_point presentation ) {
+			if( _resampler ) {
+				render_resampled( ptr, size, presentation );
+				return;
+			}
+			if( !_converter ) {
+				render_native( ptr, size, presentation );
+				return;
+			}
+			if( _converter->converts_in_place() ) {
+				render_native( ptr, size, presentation );
+				_converter->convert_in_place( ptr, size / _format.bytes_per_frame() );
+				return;
+			}
+
+			// Render blocks in the format of the stream, and convert each of
+			// them into the device buffer
+			auto device_bytes_per_frame = _converter->target_format().bytes_per_frame();
+			auto* target = static_cast<std::uint8_t*>( ptr );
+			std::size_t frames = size / device_bytes_per_frame;
+			std::size_t done = 0;
+			while( done < frames ) {
+				auto count = std::min( frames - done, ConversionFrames );
+				render_native( _conversion.data(), static_cast<byte_count>( count * _format.bytes_per_frame() ), presentation_after( presentation, done ) );
+				_converter->convert( _conversion.data(), count, target + done * device_bytes_per_frame );
+				done += count;
+			}
+		}
+
+		// render_resampled()
+		void stream_renderer::render_resampled( void* ptr, byte_count size, time_point presentation ) {
+			auto channels = _format.sample_format().channels();
+			auto device_bytes_per_frame = _converter->target_format().bytes_per_frame();
+			auto* target = static_cast<std::uint8_t*>( ptr );
+			std::size_t frames = size / device_bytes_per_frame;
+			std::size_t done = 0;
+			while( done < frames ) {
+				if( _pending_frames == 0 ) {
+					// The next block reaches the device after the frames that
+					// the resampler still holds
+					auto block_presentation = presentation;
+					if( presentation != time_point{} ) {
+						auto device_offset = std::chrono::nanoseconds( (std::nano::den * static_cast<std::uint64_t>( done )) / _device_frequency );
+						auto delay = std::chrono::nanoseconds( static_cast<std::chrono::nanoseconds::rep>( _resampler->delay() * std::nano::den / _format.frequency() ) );
+						block_presentation += device_offset + delay;
+					}
+					auto bytes = static_cast<byte_count>( ConversionFrames * _format.bytes_per_frame() );
+					if( _to_float ) {
+						render_native( _conversion.data(), bytes, block_presentation );
+						_to_float->convert( _conversion.data(), ConversionFrames, _resample_input.data() );
+					}
+					else {
+						render_native( _resample_input.data(), bytes, block_presentation );
+					}
+					_pending_frames = ConversionFrames;
+					_pending_offset = 0;
+				}
+				auto count = std::min( frames - done, ConversionFrames );
+				auto result = _resampler->process( _resample_input.data() + _pending_offset * channels, _pending_frames, _resample_output.data(), count );
+				_pending_offset += result.input_frames;
+				_pending_frames -= result.input_frames;
+				_converter->convert( _resample_output.data(), result.output_frames, target + done * device_bytes_per_frame );
+				done += result.output_frames;
+			}
+		}
+
+		// render_native()
+		void stream_renderer::render_native( void* ptr, byte_count size, time_point presentation ) {
+			auto bytes_per_frame = _format.bytes_per_frame();
+			_rendered_frames += size / bytes_per_frame;
+			if( _quantum_bytes == 0 ) {
+				produce( ptr, size, presentation );
+				return;
+			}
+
+			// Hand out staged samples, and render a new quantum each time
+			// the staging buffer runs out
+			auto* target = static_cast<std::uint8_t*>( ptr );
+			while( size > 0 ) {
+				if( _staged_bytes == 0 ) {
+					auto offset = static_cast<frame_index>( target - static_cast<std::uint8_t*>( ptr ) ) / bytes_per_frame;
+					produce_quantum( _staging.data(), _quantum_bytes, presentation_after( presentation, offset ) );
+					_staged_bytes = _quantum_bytes;
+				}
+				auto bytes = std::min( size, _staged_bytes );
+				std::memcpy( target, _staging.data() + (_quantum_bytes - _staged_bytes), bytes );
+				target += bytes;
+				size -= bytes;
+				_staged_bytes -= bytes;
+			}
+		}
+
+		// produce()
+		void stream_renderer::produce( void* ptr, byte_count size, time_point presentation ) {
+			auto bytes_per_frame = _format.bytes_per_frame();
+			auto* target = static_cast<std::uint8_t*>( ptr );
+			stream_timeline::frame_type frames = size / bytes_per_frame;
+			auto first = _timeline.position();
+			while( frames > 0 ) {
+				auto position = _timeline.position();
+				_timeline.fire_events( position );
+				auto count = std::min( frames, _timeline.next_boundary( position ) - position );
+				auto bytes = static_cast<byte_count>( count * bytes_per_frame );
+				if( _timeline.is_active( position ) ) {
+					auto result = provide( target, bytes, position, presentation_after( presentation, position - first ) );
+					if( result.end_of_stream ) {
+						_timeline.end( position + result.frames );
+					}
+				}
+				else {
+					std::memset( target, 0, bytes );
+				}
+				_timeline.advance( count );
+				target += bytes;
+				frames -= count;
+			}
+		}
+
+		// produce_quantum()
+		void stream_renderer::produce_quantum( void* ptr, byte_count size, time_point presentation ) {
+			auto bytes_per_frame = _format.bytes_per_frame();
+			auto first = _timeline.position();
+			auto end = first + size / bytes_per_frame;
+			_timeline.fire_events( end - 1 );
+
+			// Let the sample provider render the whole quantum if it plays
+			// any of it, and silence the frames where it doesn't play
+			auto start = std::max( first, _timeline.start_frame() );
+			auto stop = std::min( { end, _timeline.stop_frame(), _timeline.end_frame() } );
+			if( start < stop ) {
+				auto result = provide( ptr, size, first, presentation );
+				if( result.end_of_stream ) {
+					_timeline.end( first + result.frames );
+				}
+				auto* target = static_cast<std::uint8_t*>( ptr );
+				std::memset( target, 0, static_cast<std::size_t>( (start - first) * bytes_per_frame ) );
+				std::memset( target + (stop - first) * bytes_per_frame, 0, static_cast<std::size_t>( (end - stop) * bytes_per_frame ) );
+			}
+			else {
+				std::memset( ptr, 0, size );
+			}
+			_timeline.advance( end - first );
+		}
+
+		// provide()
+		fill_result stream_renderer::provide( void* ptr, byte_count size, frame_index position, time_point presentation ) {
+			// The play time is derived from the exact frame position, so it
+			// doesn't drift no matter how long the stream plays
+			sample_request request{ ptr, size, _format, position, presentation };
+			duration_type play_time = _format.duration_of( position );
+			auto start = clock_type::now();
+			auto result = _sample_provider->fill_samples( play_time, request );
+			auto duration = clock_type::now() - start;
+
+			// Only the frames that weren't written need to be cleared
+			result.frames = std::min( result.frames, request.frames() );
+			filling_sample_provider::clear_tail( request, result );
+
+			auto budget = std::chrono::nanoseconds( (std::nano::den * static_cast<std::uint64_t>(size)) / _format.bytes_per_second() );
+			record( duration, budget );
+			return result;
+		}
+
+		// record()
+		void stream_renderer::record( std::chrono::nanoseconds duration, std::chrono::nanoseconds budget ) {
+			budget_event event{ duration, budget };
+			auto load = event.load();
+
+			// Only the play thread writes the figures, so there is no need
+			// for read-modify-write operations
+			_callbacks.store( _callbacks.load() + 1 );
+			_load.store( _callbacks.load() == 1 ? load : _load.load() + (load - _load.load()) * LoadSmoothing );
+			_peak_load.store( std::max( _peak_load.load(), load ) );
+			if( load > 1.0f ) {
+				_over_budget.store( _over_budget.load() + 1 );
+			}
+
+			auto microseconds = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(duration).count() );
+			std::size_t bin = 0;
+			while( bin + 1 < callback_histogram_size && (microseconds >> (bin + 1)) > 0 ) {
+				++bin;
+			}
+			_histogram[bin].store( _histogram[bin].load() + 1 );
+
+			if( _budget_handler && load > _budget_fraction ) {
+				_budget_handler( event );
+			}
+		}
+
+		// statistics()
+		callback_statistics stream_renderer::statistics() const {
+			callback_statistics result;
+			result.callbacks = _callbacks;
+			result.load = _load;
+			result.peak_load = _peak_load;
+			result.over_budget = _over_budget;
+			for( std::size_t i=0; i<callback_histogram_size; ++i ) {
+				result.histogram[i] = _histogram[i];
+			}
+			return result;
+		}
+	}   // namespace backend
+}   // namespace chirp
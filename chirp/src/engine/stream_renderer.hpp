@@ -0,0 +1,275 @@
+#ifndef IG_CHIRP_SRC_ENGINE_STREAM_RENDERER_HPP
+#define IG_CHIRP_SRC_ENGINE_STREAM_RENDERER_HPP
+
+#include <chirp/audio_format.hpp>
+#include <chirp/backend.hpp>
+#include <chirp/callback_statistics.hpp>
+#include <chirp/resampler.hpp>
+#include <chirp/sample_provider.hpp>
+#include <chirp/sample_request.hpp>
+#include <chirp/stream_options.hpp>
+#include <chirp/stream_timeline.hpp>
+#include "planar_adapter.hpp"
+#include "sample_conversion.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Issues sample requests to the sample provider of an audio stream.
+		///
+		/// The renderer keeps track of the play duration that is passed to
+		/// the sample provider, and times each call against the real-time
+		/// budget of the request. Sample requests are split at the frames
+		/// that are scheduled on the timeline of the stream. With a render
+		/// quantum, the sample provider is always asked for the same number
+		/// of frames, and the rendered quanta are staged and split over the
+		/// regions the device asks for. Quanta are rendered whole, with the
+		/// frames outside of the schedule silenced. When the device plays
+		/// another sample format than the stream, the samples are rendered
+		/// in blocks and converted into the device buffer, or swapped in
+		/// place if only the byte order differs.
+		class stream_renderer
+		{
+			public:
+				/// Clock used for timing the sample provider
+				using clock_type = std::chrono::steady_clock;
+				/// Integral type for byte counts
+				using byte_count = audio_format::byte_count;
+				/// Integral type for frame positions
+				using frame_index = audio_format::frame_index;
+				/// Monotonic time type for presentation times
+				using time_point = sample_request::time_point;
+
+				/// Create a renderer
+				/// @param format    The audio format of the stream
+				/// @param options   The stream options, of which the render
+				///                  quantum and the resampler quality are
+				///                  used
+				explicit stream_renderer( audio_format const& format, stream_options const& options = stream_options{} );
+
+				// Not copy-constructable or copy-assignable
+				stream_renderer( stream_renderer const& ) = delete;
+				stream_renderer& operator=( stream_renderer const& ) = delete;
+
+				/// Set the sample provider
+				/// @param provider   The sample provider, which must outlive
+				///                   the rendering.
+				void set_sample_provider( sample_provider& provider ) {
+					_sample_provider = &provider;
+				}
+
+				/// Keep a function as sample provider within the renderer
+				/// @param f   The function
+				/// @returns The sample provider that calls the function
+				sample_provider& adopt( audio_stream::sample_provider_func f ) {
+					_function_provider.callable() = std::move(f);
+					return _function_provider;
+				}
+
+				/// Keep a planar function as sample provider within the
+				/// renderer. The float32 samples it provides are converted
+				/// to the format of the stream.
+				/// @param f   The function
+				/// @returns The sample provider that calls the function
+				sample_provider& adopt( planar_provider_func f ) {
+					_planar_provider.set_function( std::move(f) );
+					return _planar_provider;
+				}
+
+				/// Start over from a play duration of zero, and drop any
+				/// staged or resampled samples
+				void rewind() {
+					_rendered_frames = 0;
+					_staged_bytes = 0;
+					_timeline.rewind();
+					if( _resampler ) {
+						_resampler->reset();
+					}
+					_pending_frames = 0;
+				}
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() {
+					return _timeline;
+				}
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget. Must not be
+				/// called while samples are rendered on another thread.
+				/// @param fraction   The fraction of the budget
+				/// @param f          The handler
+				void set_budget_handler( float fraction, budget_handler_func f ) {
+					_budget_fraction = fraction;
+					_budget_handler = std::move(f);
+				}
+
+				/// Set the audio format of the device buffers. Must not be
+				/// called while samples are rendered on another thread.
+				/// @param format   The audio format, which must have as many
+				///                 channels as the stream
+				/// @throws sample_format_exception if the channel counts
+				///         differ
+				/// @throws resampler_exception if the frequencies are too
+				///         far apart to resample
+				void set_device_format( audio_format const& format );
+
+				/// Fill a buffer with samples from the sample provider, and
+				/// silence where it has no samples
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to fill, in the
+				///                       sample format of the device
+				/// @param presentation   The time at which the first frame of
+				///                       the buffer reaches the device, or a
+				///                       default constructed time point if
+				///                       unknown
+				void render( void* ptr, byte_count size, time_point presentation = time_point{} );
+
+				/// @returns The number of bytes of each sample request, or
+				///          zero if there is no render quantum
+				byte_count quantum_bytes() const {
+					return _quantum_bytes;
+				}
+
+				/// @returns The amount of time that has been rendered into
+				///          the buffers given to `render()`
+				duration_type play_duration() const {
+					return _format.duration_of( _rendered_frames );
+				}
+
+				/// @returns The number of frames that have been rendered into
+				///          the buffers given to `render()`
+				frame_index rendered_frames() const {
+					return _rendered_frames;
+				}
+
+				/// @returns The callback timing. This may be called from any
+				///          thread.
+				callback_statistics statistics() const;
+
+			private:
+				/// Fill a buffer in the format of the stream
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to fill
+				/// @param presentation   The presentation time of the first
+				///                       frame
+				void render_native( void* ptr, byte_count size, time_point presentation );
+
+				/// Fill a buffer at the frequency of the device, by
+				/// resampling blocks in the format of the stream
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to fill
+				/// @param presentation   The presentation time of the first
+				///                       frame
+				void render_resampled( void* ptr, byte_count size, time_point presentation );
+
+				/// Render frames at the position of the timeline, splitting
+				/// the request at scheduled frames
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to render
+				/// @param presentation   The presentation time of the first
+				///                       frame
+				void produce( void* ptr, byte_count size, time_point presentation );
+
+				/// Render one quantum at the position of the timeline,
+				/// without splitting the request
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to render
+				/// @param presentation   The presentation time of the first
+				///                       frame
+				void produce_quantum( void* ptr, byte_count size, time_point presentation );
+
+				/// Let the sample provider fill a buffer, and clear what it
+				/// didn't write
+				/// @param ptr            Pointer to the buffer
+				/// @param size           The number of bytes to request
+				/// @param position       The position of the first frame
+				/// @param presentation   The presentation time of the first
+				///                       frame
+				/// @returns The outcome of filling the buffer
+				fill_result provide( void* ptr, byte_count size, frame_index position, time_point presentation );
+
+				/// Calculate the presentation time of a later frame
+				/// @param presentation   The presentation time of a frame
+				/// @param frames         The number of frames after it
+				/// @returns The presentation time of the later frame, which
+				///          is unknown if the first one is
+				time_point presentation_after( time_point presentation, frame_index frames ) const {
+					return presentation == time_point{} ? presentation : presentation + _format.duration_of( frames );
+				}
+
+				/// Record the timing of a callback
+				/// @param duration   The time the sample provider took
+				/// @param budget     The duration of the requested samples
+				void record( std::chrono::nanoseconds duration, std::chrono::nanoseconds budget );
+
+				/// Audio format of the stream
+				audio_format _format;
+				/// Current sample provider
+				sample_provider* _sample_provider;
+				/// Sample provider for functions that are adopted
+				callable_sample_provider<audio_stream::sample_provider_func> _function_provider;
+				/// Sample provider for planar functions that are adopted
+				planar_adapter _planar_provider;
+				/// Number of frames that have been rendered
+				frame_index _rendered_frames;
+				/// Number of bytes in each sample request, or zero
+				byte_count _quantum_bytes;
+				/// Staging buffer for one quantum
+				std::vector<std::uint8_t> _staging;
+				/// Number of bytes at the end of the staging buffer that
+				/// haven't been rendered yet
+				byte_count _staged_bytes;
+				/// The frame timeline
+				stream_timeline _timeline;
+				/// Converter to the device format, or null if the device
+				/// plays the format of the stream
+				std::unique_ptr<sample_converter> _converter;
+				/// Buffer for blocks that are rendered before conversion
+				std::vector<std::uint8_t> _conversion;
+				/// Quality of the resampler
+				resample_quality _resample_quality;
+				/// Frequency of the device
+				audio_format::frequency_type _device_frequency;
+				/// Resampler to the frequency of the device, or null if the
+				/// device plays the frequency of the stream
+				std::unique_ptr<resampler> _resampler;
+				/// Converter of rendered blocks to float samples, or null if
+				/// the stream has float samples in native byte order
+				std::unique_ptr<sample_converter> _to_float;
+				/// Float samples of the last rendered block
+				std::vector<float> _resample_input;
+				/// Resampled float samples
+				std::vector<float> _resample_output;
+				/// Number of frames of the last block that haven't been
+				/// resampled yet
+				std::size_t _pending_frames;
+				/// Offset of the first of these frames
+				std::size_t _pending_offset;
+				/// Number of callbacks
+				std::atomic<callback_statistics::counter_type> _callbacks;
+				/// Moving average of the load
+				std::atomic<float> _load;
+				/// Highest load
+				std::atomic<float> _peak_load;
+				/// Number of callbacks over budget
+				std::atomic<callback_statistics::counter_type> _over_budget;
+				/// Histogram of callback durations
+				std::array<std::atomic<callback_statistics::counter_type>, callback_histogram_size> _histogram;
+				/// The fraction of the budget that triggers the budget handler
+				float _budget_fraction;
+				/// Function to call when a callback is over the budget fraction
+				budget_handler_func _budget_handler;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_STREAM_RENDERER_HPP
@@ -0,0 +1,42 @@
+#include "write_ahead_controller.hpp"
+
+#include <algorithm>
+
+namespace chirp
+{
+	namespace backend
+	{
+		// constructor
+		write_ahead_controller::write_ahead_controller( byte_count initial, byte_count minimum, byte_count maximum, byte_count step, byte_count stable_bytes ) :
+			_write_ahead( std::min( std::max( initial, minimum ), maximum ) ),
+			_minimum( std::min( minimum, maximum ) ),
+			_maximum( maximum ),
+			_step( step ),
+			_stable_bytes( stable_bytes ),
+			_stable_played( 0 )
+		{
+		}
+
+		// update()
+		write_ahead_controller::byte_count write_ahead_controller::update( bool underrun, bool late, byte_count played ) {
+			if( underrun ) {
+				// Audible glitch, back off quickly by doubling the limit
+				_write_ahead = std::min( _maximum, _write_ahead + std::max( _write_ahead, _step ) );
+				_stable_played = 0;
+			}
+			else if( late ) {
+				// Close call, grow a little
+				_write_ahead = std::min( _maximum, _write_ahead + _step );
+				_stable_played = 0;
+			}
+			else {
+				_stable_played += played;
+				if( _stable_played >= _stable_bytes ) {
+					_write_ahead = std::max( _minimum, _write_ahead - std::min( _write_ahead, _step ) );
+					_stable_played = 0;
+				}
+			}
+			return _write_ahead;
+		}
+	}   // namespace backend
+}   // namespace chirp
@@ -0,0 +1,68 @@
+#ifndef IG_CHIRP_SRC_ENGINE_WRITE_AHEAD_CONTROLLER_HPP
+#define IG_CHIRP_SRC_ENGINE_WRITE_AHEAD_CONTROLLER_HPP
+
+#include <chirp/audio_format.hpp>
+
+namespace chirp
+{
+	namespace backend
+	{
+		/// Controller that adapts the write-ahead limit of a stream to how
+		/// well the machine keeps up with it.
+		///
+		/// The limit grows quickly when the stream underruns or is serviced
+		/// close to its deadline, and shrinks one step at a time after a
+		/// stretch of stable playback. Time is measured in played bytes, so
+		/// the controller doesn't depend on any clock.
+		class write_ahead_controller
+		{
+			public:
+				/// Integral type for byte counts
+				using byte_count = audio_format::byte_count;
+
+				/// Create a controller
+				/// @param initial         The initial write-ahead limit
+				/// @param minimum         The smallest write-ahead limit
+				/// @param maximum         The largest write-ahead limit
+				/// @param step            The amount to grow or shrink the
+				///                        limit by, which should be a whole
+				///                        number of frames.
+				/// @param stable_bytes    The amount of samples that have to
+				///                        be played without problems before
+				///                        the limit is shrunk.
+				write_ahead_controller( byte_count initial, byte_count minimum, byte_count maximum, byte_count step, byte_count stable_bytes );
+
+				/// @returns The current write-ahead limit
+				byte_count write_ahead() const {
+					return _write_ahead;
+				}
+
+				/// Update the limit after a service of the stream
+				/// @param underrun   Whether the device ran out of samples
+				///                   since the last service
+				/// @param late       Whether the service happened close to
+				///                   the point where the device would have
+				///                   run out of samples.
+				/// @param played     The number of bytes played since the
+				///                   last service
+				/// @returns The new write-ahead limit
+				byte_count update( bool underrun, bool late, byte_count played );
+
+			private:
+				/// Current write-ahead limit
+				byte_count _write_ahead;
+				/// Smallest write-ahead limit
+				byte_count _minimum;
+				/// Largest write-ahead limit
+				byte_count _maximum;
+				/// Amount to grow or shrink the limit by
+				byte_count _step;
+				/// Amount of stable playback required for shrinking the limit
+				byte_count _stable_bytes;
+				/// Amount of stable playback since the limit last changed
+				byte_count _stable_played;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // IG_CHIRP_SRC_ENGINE_WRITE_AHEAD_CONTROLLER_HPP
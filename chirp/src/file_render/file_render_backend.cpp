@@ -0,0 +1,340 @@
+#include "file_render_backend.hpp"
+
+#if defined(CHIRP_WITH_FILE_RENDER)
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	/// Number of frames rendered at each sample request. Latency doesn't
+	/// matter when rendering offline, so stream options are ignored and
+	/// large blocks are used to keep the overhead per request low.
+	std::uint32_t const BlockSize_frames = 4096;
+
+	/// Size of the canonical wave header, in bytes
+	std::uint32_t const WaveHeader_bytes = 44;
+
+	/// Wave format tag of integer samples
+	std::uint16_t const WaveFormat_pcm = 1;
+
+	/// Wave format tag of floating point samples
+	std::uint16_t const WaveFormat_float = 3;
+
+	/// Find the wave format tag of a sample format. Integer samples in
+	/// wave files are unsigned if they are eight bits and signed if they
+	/// are wider, and can't be padded without the extensible format.
+	/// @returns The format tag, or zero if there is none
+	std::uint16_t wave_format_tag( chirp::audio_format const& format ) {
+		switch( format.type() ) {
+			case chirp::sample_type::floating_point:
+				return WaveFormat_float;
+			case chirp::sample_type::unsigned_integer:
+				return format.bits_per_sample() == 8 ? WaveFormat_pcm : 0;
+			case chirp::sample_type::signed_integer:
+				return format.bits_per_sample() > 8 && format.bits_per_sample() == format.bytes_per_sample() * 8 ? WaveFormat_pcm : 0;
+		}
+		return 0;
+	}
+
+	/// Write an unsigned integer in little endian byte order
+	template <class T>
+	void write_little_endian( std::ostream& stream, T value ) {
+		for( std::size_t i=0; i<sizeof(T); ++i ) {
+			stream.put( static_cast<char>( (value >> (8*i)) & 0xff ) );
+		}
+	}
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		//-----------------------------------------------------------------
+		// file_render_platform implementation
+		//-----------------------------------------------------------------
+
+		// file_render_platform constructor
+		file_render_platform::file_render_platform( std::string const& path, std::chrono::nanoseconds length ) :
+			_output_device( std::make_shared<file_render_output_device>( path, length ) )
+		{
+		}
+
+		// file_render_platform destructor
+		file_render_platform::~file_render_platform() {
+		}
+
+		// file_render_platform::default_ouput_device()
+		file_render_platform::output_device_ptr file_render_platform::default_output_device() const {
+			return _output_device;
+		}
+
+		// file_render_platform::get_output_devices()
+		file_render_platform::output_device_collection file_render_platform::get_output_devices() const {
+			return output_device_collection{ _output_device };
+		}
+
+		//-----------------------------------------------------------------
+		// file_render_output_device implementation
+		//-----------------------------------------------------------------
+
+		// file_render_output_device::create_audio_stream()
+		std::unique_ptr<audio_stream> file_render_output_device::create_audio_stream( audio_format const& format, stream_options const& options ) {
+			if( !supports( format ) ) {
+				throw sample_format_exception{};
+			}
+			return std::make_unique<file_render_audio_stream>( next_stream_path(), _length, format, options );
+		}
+
+		// file_render_output_device::supports()
+		bool file_render_output_device::supports( audio_format const& format ) const {
+			return wave_format_tag( format ) != 0;
+		}
+
+		// operator==()
+		bool file_render_output_device::operator==(chirp::backend::output_device const& other ) const {
+			auto ptr = dynamic_cast<file_render_output_device const*>(&other);
+			return ptr != nullptr && ptr->_path == _path;
+		}
+
+		// next_stream_path()
+		std::string file_render_output_device::next_stream_path() {
+			// The first stream renders to the device path, the following
+			// streams get a sequence number appended to the file name.
+			auto index = _stream_count++;
+			if( index == 0 ) {
+				return _path;
+			}
+			auto separator = _path.find_last_of( "/\\" );
+			auto extension = _path.find_last_of( '.' );
+			if( extension == std::string::npos || (separator != std::string::npos && extension < separator) ) {
+				extension = _path.size();
+			}
+			return _path.substr( 0, extension ) + "-" + std::to_string( index ) + _path.substr( extension );
+		}
+
+		//-----------------------------------------------------------------
+		// wave_file_writer implementation
+		//-----------------------------------------------------------------
+
+		constexpr std::uint64_t wave_file_writer::maximum_data_bytes;
+
+		// wave_file_writer constructor
+		wave_file_writer::wave_file_writer( std::string const& path, audio_format const& format, std::uint64_t maximum_bytes ) :
+			_file( path, std::ios::binary | std::ios::trunc ),
+			_format( format ),
+			_data_bytes( 0 ),
+			_maximum_bytes( std::min( maximum_bytes, maximum_data_bytes ) / format.bytes_per_frame() * format.bytes_per_frame() )
+		{
+			if( !_file ) {
+				throw file_render_exception{};
+			}
+			write_header();
+		}
+
+		// wave_file_writer destructor
+		wave_file_writer::~wave_file_writer() {
+			close();
+		}
+
+		// wave_file_writer::write()
+		bool wave_file_writer::write( void const* ptr, std::uint32_t size ) {
+			// Whole frames are written up to the size that the header can
+			// tell, and the file is kept valid after that
+			auto room = _maximum_bytes - _data_bytes;
+			auto bytes = static_cast<std::uint32_t>( std::min<std::uint64_t>( size, room ) );
+			if( !_file || bytes == 0 ) {
+				return false;
+			}
+			_file.write( static_cast<char const*>(ptr), bytes );
+			if( !_file ) {
+				return false;
+			}
+			_data_bytes += bytes;
+			return bytes == size;
+		}
+
+		// wave_file_writer::close()
+		void wave_file_writer::close() {
+			if( !_file.is_open() ) {
+				return;
+			}
+			_file.seekp( 0 );
+			write_header();
+			_file.close();
+		}
+
+		// wave_file_writer::write_header()
+		void wave_file_writer::write_header() {
+			auto data_bytes = static_cast<std::uint32_t>( _data_bytes );
+			_file.write( "RIFF", 4 );
+			write_little_endian<std::uint32_t>( _file, WaveHeader_bytes - 8 + data_bytes );
+			_file.write( "WAVE", 4 );
+			_file.write( "fmt ", 4 );
+			write_little_endian<std::uint32_t>( _file, 16 );
+			write_little_endian<std::uint16_t>( _file, wave_format_tag( _format ) );
+			write_little_endian<std::uint16_t>( _file, _format.channels() );
+			write_little_endian<std::uint32_t>( _file, _format.frequency() );
+			write_little_endian<std::uint32_t>( _file, _format.bytes_per_second() );
+			write_little_endian<std::uint16_t>( _file, static_cast<std::uint16_t>(_format.bytes_per_frame()) );
+			write_little_endian<std::uint16_t>( _file, _format.bits_per_sample() );
+			_file.write( "data", 4 );
+			write_little_endian<std::uint32_t>( _file, data_bytes );
+		}
+
+		//-----------------------------------------------------------------
+		// file_render_audio_stream implementation
+		//-----------------------------------------------------------------
+
+		// file_render_audio_stream constructor
+		file_render_audio_stream::file_render_audio_stream( std::string const& path, std::chrono::nanoseconds length, audio_format const& format, stream_options const& options ) :
+			_format( format ),
+			_writer( path, format ),
+			_scheduler( format, 2 * BlockSize_frames * format.bytes_per_frame(), BlockSize_frames * format.bytes_per_frame(), BlockSize_frames * format.bytes_per_frame() ),
+			_block( _scheduler.buffer_bytes() ),
+			_length_frames(
+				static_cast<std::uint64_t>( length.count() / std::nano::den ) * format.frequency() +
+				static_cast<std::uint64_t>( length.count() % std::nano::den ) * format.frequency() / std::nano::den ),
+			_rendered_frames( 0 ),
+			_state( audio_stream_state::ready ),
+			_abort_render_thread( false ),
+			_render_thread_id( std::thread::id{} ),
+			_renderer( format, options )
+		{
+			// Wave files are always little endian
+			_renderer.set_device_format( { format.frequency(), format.sample_format().in_byte_order( byte_order::little_endian ) } );
+		}
+
+		// render()
+		void file_render_audio_stream::render() {
+			// Set before the sample provider is called, which may stop the
+			// stream from this thread
+			_render_thread_id = std::this_thread::get_id();
+			while( !_abort_render_thread ) {
+				if( _length_frames > 0 && _rendered_frames >= _length_frames ) {
+					break;
+				}
+				auto schedule = _scheduler.plan_consumed();
+				bool written = true;
+				for( std::size_t i=0; i<schedule.count && written && !_abort_render_thread; ++i ) {
+					auto size = schedule.regions[i].size;
+					if( _length_frames > 0 ) {
+						auto remaining = (_length_frames - _rendered_frames) * _format.bytes_per_frame();
+						size = static_cast<std::uint32_t>( std::min<std::uint64_t>( size, remaining ) );
+					}
+					if( size > 0 ) {
+						written = issue_sample_request( schedule.regions[i].offset, size );
+					}
+				}
+				// The file is full or can't be written to
+				if( !written ) {
+					break;
+				}
+			}
+
+			// The wave file is complete, and can't be rendered to again
+			_writer.close();
+			_state = audio_stream_state::invalid;
+			_render_thread_id = std::thread::id{};
+		}
+
+		// issue_sample_request()
+		bool file_render_audio_stream::issue_sample_request( std::uint32_t offset, std::uint32_t size ) {
+			auto* ptr = _block.data() + offset;
+			_renderer.render( ptr, size );
+			_rendered_frames += size / _format.bytes_per_frame();
+			_scheduler.commit( size );
+			return _writer.write( ptr, size );
+		}
+
+		// play_async()
+		void file_render_audio_stream::play_async( sample_provider_func f ) {
+			// Don't replace the function while the render thread may call it
+			if( _state != audio_stream_state::ready ) {
+				throw file_render_exception{};
+			}
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void file_render_audio_stream::play_async( planar_provider_func f ) {
+			// Don't replace the function while the render thread may call it
+			if( _state != audio_stream_state::ready ) {
+				throw file_render_exception{};
+			}
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void file_render_audio_stream::play_async( sample_provider& provider ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			if( _state != audio_stream_state::ready ) {
+				throw file_render_exception{};
+			}
+			_renderer.set_sample_provider( provider );
+			_abort_render_thread = false;
+			_state = audio_stream_state::playing;
+			_render_thread = std::thread{ &file_render_audio_stream::render, this };
+		}
+
+		// stop()
+		void file_render_audio_stream::stop() {
+			_abort_render_thread = true;
+			// The sample provider may stop the stream from the render thread,
+			// which then finishes the file by itself.
+			if( _render_thread_id.load() == std::this_thread::get_id() ) {
+				return;
+			}
+			std::unique_lock<std::mutex> lock{_mutex};
+			if( _render_thread.joinable() ) {
+				_render_thread.join();
+			}
+			_writer.close();
+			_state = audio_stream_state::invalid;
+		}
+
+		// state()
+		audio_stream_state file_render_audio_stream::state() const {
+			return _state;
+		}
+
+		// configuration()
+		stream_configuration file_render_audio_stream::configuration() const {
+			return _scheduler.configuration();
+		}
+
+		// statistics()
+		stream_statistics file_render_audio_stream::statistics() const {
+			return _scheduler.statistics();
+		}
+
+		// set_underrun_handler()
+		void file_render_audio_stream::set_underrun_handler( underrun_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_scheduler.set_underrun_handler( std::move(f) );
+		}
+
+		// callback_timing()
+		callback_statistics file_render_audio_stream::callback_timing() const {
+			return _renderer.statistics();
+		}
+
+		// set_budget_handler()
+		void file_render_audio_stream::set_budget_handler( float fraction, budget_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_renderer.set_budget_handler( fraction, std::move(f) );
+		}
+
+		// timeline()
+		stream_timeline& file_render_audio_stream::timeline() {
+			return _renderer.timeline();
+		}
+
+		// latency()
+		std::chrono::nanoseconds file_render_audio_stream::latency() const {
+			return std::chrono::nanoseconds::zero();
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_FILE_RENDER)
@@ -0,0 +1,274 @@
+#ifndef IG_CHIRP_SRC_FILE_RENDER_BACKEND_HPP
+#define IG_CHIRP_SRC_FILE_RENDER_BACKEND_HPP
+
+#include <chirp/static_config.hpp>
+
+#if defined(CHIRP_WITH_FILE_RENDER)
+
+#include <chirp/backend.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_request.hpp>
+
+#include "../engine/ring_buffer_scheduler.hpp"
+#include "../engine/stream_renderer.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace chirp
+{
+	namespace backend
+	{
+		// Exceptions
+
+		/// Root exceptions for all exceptional events within the file render
+		/// backend.
+		struct file_render_exception :
+			chirp::backend_exception
+		{};
+
+		/// Writer of streaming wave files.
+		///
+		/// The header is written with empty sizes when the file is opened,
+		/// and patched with the real sizes when the file is closed, which
+		/// means that the samples can be appended as they are produced.
+		/// The sizes in the header are 32 bits, so no more samples are
+		/// written once they would overflow.
+		class wave_file_writer
+		{
+			public:
+				/// The largest number of sample bytes in a wave file
+				static constexpr std::uint64_t maximum_data_bytes = 0xffffffffu - 36;
+
+				/// Open a wave file for writing
+				/// @param path            The path of the file
+				/// @param format          The audio format of the samples
+				///                        that will be written to the file.
+				/// @param maximum_bytes   The number of sample bytes that
+				///                        the file may hold, up to
+				///                        `maximum_data_bytes`
+				/// @throws file_render_exception if the file cannot be opened
+				wave_file_writer( std::string const& path, audio_format const& format, std::uint64_t maximum_bytes = maximum_data_bytes );
+
+				/// Destructor, closes the file if it is open
+				~wave_file_writer();
+
+				/// Append samples to the file, as far as they fit
+				/// @param ptr    Pointer to the samples, in the audio format
+				///               of the file.
+				/// @param size   The number of bytes to write
+				/// @returns `false` if the file is full or couldn't be
+				///          written to, so that not all samples were written
+				bool write( void const* ptr, std::uint32_t size );
+
+				/// Write the final sizes to the header and close the file
+				void close();
+
+			private:
+				/// Write the wave header to the current position of the file
+				void write_header();
+
+				/// The output file
+				std::ofstream _file;
+				/// Audio format of the samples
+				audio_format _format;
+				/// Number of sample bytes written
+				std::uint64_t _data_bytes;
+				/// Number of sample bytes that the file may hold, in whole
+				/// frames
+				std::uint64_t _maximum_bytes;
+		};
+
+		/// Audio device implementation for the file render backend.
+		///
+		/// Each audio stream created from the device renders its samples
+		/// into a wave file, on a thread of its own and without any pacing.
+		class file_render_output_device :
+			public backend::output_device
+		{
+			public:
+				/// Parameterized constructor
+				/// @param path     The path of the wave file to render to
+				/// @param length   The amount of audio that each stream will
+				///                 render before it stops by itself. A zero
+				///                 length renders until the stream is stopped.
+				file_render_output_device( std::string const& path, std::chrono::nanoseconds length ) :
+					_path( path ),
+					_length( length ),
+					_stream_count( 0 )
+				{}
+
+				/// @returns The device name, which is the path of the file
+				std::string name() const override {
+					return _path;
+				}
+
+				/// @returns The amount of audio each stream renders
+				std::chrono::nanoseconds length() const {
+					return _length;
+				}
+
+				/// Create a new audio stream instance with a given format.
+				/// @throws sample_format_exception if the format can't be
+				///                                 stored in a wave file
+				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format, stream_options const& options ) override;
+
+				/// @returns `true` if the format can be stored in a wave file
+				bool supports( audio_format const& format ) const override;
+
+				/// Check for equality
+				bool operator==(output_device const& other) const override;
+
+			private:
+				/// @returns The path of the file for the next audio stream
+				std::string next_stream_path();
+
+				/// The path of the file to render to
+				std::string _path;
+				/// The amount of audio each stream renders
+				std::chrono::nanoseconds _length;
+				/// The number of streams that have been created
+				std::uint32_t _stream_count;
+		};
+
+		/// Audio stream implementation for the file render backend.
+		class file_render_audio_stream :
+			public backend::audio_stream
+		{
+			public:
+				/// Create a file render audio stream instance.
+				/// @param path     The path of the wave file to render to
+				/// @param length   The amount of audio to render, or zero to
+				///                 render until the stream is stopped.
+				/// @param format   The requested format of the audio stream
+				/// @param options  The requested stream options. The buffer
+				///                 configuration is fixed, so only the
+				///                 render quantum is used.
+				/// @throws file_render_exception if the file cannot be created
+				file_render_audio_stream( std::string const& path, std::chrono::nanoseconds length, audio_format const& format, stream_options const& options );
+
+				/// Destroy the audio stream.
+				~file_render_audio_stream() {
+					stop();
+				}
+
+				/// @returns the state of the audio stream
+				audio_stream_state state() const override;
+
+				/// Start rendering the audio stream asyncronously
+				/// @throws file_render_exception if the stream is already
+				///         rendering, or if its file has been finished.
+				void play_async( sample_provider_func f ) override;
+
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				void play_async( sample_provider& provider ) override;
+
+				/// Start playing the audio stream with a planar provider function
+				/// @param f   The function
+				void play_async( planar_provider_func f ) override;
+
+				/// Stop rendering the audio stream if it is rendering, and
+				/// finish the wave file. The stream can't be played again
+				/// once the file is finished. The render also ends by itself
+				/// when the file is full, or can't be written to.
+				void stop() override;
+
+				/// @returns The buffer configuration that the stream uses
+				stream_configuration configuration() const override;
+
+				/// @returns The underrun counters of the stream
+				stream_statistics statistics() const override;
+
+				/// Set the function that is called when an underrun is detected
+				void set_underrun_handler( underrun_handler_func f ) override;
+
+				/// @returns The timing of the sample provider
+				callback_statistics callback_timing() const override;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget
+				void set_budget_handler( float fraction, budget_handler_func f ) override;
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() override;
+
+				/// @returns Zero, as the stream isn't played in real time
+				std::chrono::nanoseconds latency() const override;
+
+			private:
+				/// Render thread entry point
+				void render();
+
+				/// Create a sample request, call the current sample provider
+				/// and write the result to the file
+				/// @param offset   Position in the block buffer to render to
+				/// @param size     The number of bytes to request
+				/// @returns `false` if the file is full or couldn't be
+				///          written to, which ends the render
+				bool issue_sample_request( std::uint32_t offset, std::uint32_t size );
+
+				/// Audio format
+				audio_format _format;
+				/// The wave file
+				wave_file_writer _writer;
+				/// Scheduler for the block buffer. The file consumes each
+				/// block as soon as it has been rendered, so the read cursor
+				/// is always at the write position.
+				ring_buffer_scheduler _scheduler;
+				/// Blocks that samples are rendered into before being written
+				std::vector<std::uint8_t> _block;
+				/// The number of frames to render, or zero to render until stopped
+				std::uint64_t _length_frames;
+				/// The number of frames that have been rendered
+				std::uint64_t _rendered_frames;
+				/// Current audio state
+				std::atomic<audio_stream_state> _state;
+				/// Atomic flag for aborting the render thread
+				std::atomic<bool> _abort_render_thread;
+				/// Render thread
+				std::thread _render_thread;
+				/// The id of the render thread while it renders, which the
+				/// render thread can read without racing on `_render_thread`
+				std::atomic<std::thread::id> _render_thread_id;
+				/// Mutex for syncronizing the internal state
+				std::mutex _mutex;
+				/// Issues sample requests to the sample provider
+				stream_renderer _renderer;
+		};
+
+		/// Implementation of the file render platform
+		class file_render_platform :
+			public backend::platform
+		{
+			public:
+				/// Parameterized constructor
+				/// @param path     The path of the wave file to render to
+				/// @param length   The amount of audio that each stream will
+				///                 render before it stops by itself. A zero
+				///                 length renders until the stream is stopped.
+				file_render_platform( std::string const& path, std::chrono::nanoseconds length );
+				/// Destructor
+				~file_render_platform();
+
+				/// Create an instance of the default outout device
+				output_device_ptr default_output_device() const override;
+
+				/// @returns collection of output devices
+				output_device_collection get_output_devices() const override;
+
+			private:
+				/// The only output device of the platform
+				std::shared_ptr<file_render_output_device> _output_device;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_FILE_RENDER)
+#endif   // IG_CHIRP_SRC_FILE_RENDER_BACKEND_HPP
@@ -0,0 +1,32 @@
+#include <chirp/mixer.hpp>
+#include "engine/mixer_engine.hpp"
+
+namespace chirp
+{
+	// constructor
+	mixer::mixer( output_device& device, audio_format::frequency_type frequency, channel_count channels, stream_options const& options ) :
+		_engine( std::make_shared<backend::mixer_engine>( frequency, channels ) )
+	{
+		_engine->set_device_stream( device.create_audio_stream( _engine->format(), options ) );
+	}
+
+	// create_audio_stream()
+	audio_stream mixer::create_audio_stream( audio_format const& format, stream_options const& options ) {
+		return audio_stream{ format, std::make_shared<backend::mixer_stream>( _engine, format, options ) };
+	}
+
+	// format()
+	audio_format const& mixer::format() const {
+		return _engine->format();
+	}
+
+	// playing_streams()
+	std::size_t mixer::playing_streams() const {
+		return _engine->playing_streams();
+	}
+
+	// device_stream()
+	audio_stream const& mixer::device_stream() const {
+		return *_engine->device_stream();
+	}
+}   // namespace chirp
@@ -0,0 +1,221 @@
+#include "null_backend.hpp"
+
+#if defined(CHIRP_WITH_NULL)
+
+namespace
+{
+	/// The longest time the play thread sleeps while streams are playing.
+	/// Streams arm the play thread timer themselves, so this is only a
+	/// safety net.
+	auto const FallbackInterval = std::chrono::milliseconds{100};
+}   // anonymous namespace
+
+namespace chirp
+{
+	namespace backend
+	{
+		//-----------------------------------------------------------------
+		// null_platform implementation
+		//-----------------------------------------------------------------
+
+		// null_platform default constructor
+		null_platform::null_platform() :
+			_output_device( std::make_shared<null_output_device>( "null" ) )
+		{
+		}
+
+		// null_platform destructor
+		null_platform::~null_platform() {
+		}
+
+		// null_platform::default_ouput_device()
+		null_platform::output_device_ptr null_platform::default_output_device() const {
+			return _output_device;
+		}
+
+		// null_platform::get_output_devices()
+		null_platform::output_device_collection null_platform::get_output_devices() const {
+			return output_device_collection{ _output_device };
+		}
+
+		//-----------------------------------------------------------------
+		// null_output_device implementation
+		//-----------------------------------------------------------------
+
+		// null_output_device constructor
+		null_output_device::null_output_device( std::string const& name ) :
+			_name( name ),
+			_play_thread( FallbackInterval )
+		{
+		}
+
+		// null_output_device::create_audio_stream()
+		std::unique_ptr<audio_stream> null_output_device::create_audio_stream( audio_format const& format, stream_options const& options ) {
+			return std::make_unique<null_audio_stream>( *this, format, options );
+		}
+
+		// operator==()
+		bool null_output_device::operator==(chirp::backend::output_device const& other ) const {
+			auto ptr = dynamic_cast<null_output_device const*>(&other);
+			return ptr != nullptr && ptr->_name == _name;
+		}
+
+		//-----------------------------------------------------------------
+		// null_audio_stream implementation
+		//-----------------------------------------------------------------
+
+		// null_audio_stream constructor
+		null_audio_stream::null_audio_stream( null_output_device& device, audio_format const& format, stream_options const& options, clock_func clock ) :
+			_device( device ),
+			_format( format ),
+			_buffer( ring_buffer_scheduler::bytes_for( format, options.buffer_duration() ), 0 ),
+			_state( audio_stream_state::ready ),
+			_device_started( false ),
+			_clock( std::move(clock) ),
+			_scheduler( format, options ),
+			_renderer( format, options )
+		{
+		}
+
+		// read_cursor()
+		std::uint32_t null_audio_stream::read_cursor( clock_type::time_point now ) const {
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>( now - _play_start ).count();
+			auto const ns_per_second = std::nano::den;
+			auto frames =
+				static_cast<std::uint64_t>( elapsed / ns_per_second ) * _format.frequency() +
+				static_cast<std::uint64_t>( elapsed % ns_per_second ) * _format.frequency() / ns_per_second;
+			auto buffer_frames = _buffer.size() / _format.bytes_per_frame();
+			return static_cast<std::uint32_t>( (frames % buffer_frames) * _format.bytes_per_frame() );
+		}
+
+		// update()
+		void null_audio_stream::update( duration_type const& ) {
+			// A stream that is stopped from the play thread is updated
+			// until the loop drops its connection
+			if( _state != audio_stream_state::playing ) {
+				return;
+			}
+
+			// The simulated device starts reading from the buffer when the
+			// first samples have been written to it. It has no unsafe region,
+			// its write cursor is always the same as its read cursor.
+			auto now = _clock();
+			auto wakeup_base = render_loop::clock_type::now();
+			if( !_device_started ) {
+				_play_start = now;
+				_last_update = now;
+				_device_started = true;
+			}
+			auto read_cursor = this->read_cursor( now );
+
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>( now - _last_update );
+			_last_update = now;
+			auto schedule = _scheduler.plan( read_cursor, elapsed );
+			for( std::size_t i=0; i<schedule.count && _state == audio_stream_state::playing; ++i ) {
+				issue_sample_request( _buffer.data() + schedule.regions[i].offset, schedule.regions[i].size, now );
+			}
+
+			// The simulated device signals that a period has elapsed when
+			// there is room for another period of samples in the buffer
+			_device.play_thread().wake_at( wakeup_base + _scheduler.refill_delay( read_cursor ) );
+		}
+
+		// issue_sample_request()
+		void null_audio_stream::issue_sample_request( void* ptr, std::uint32_t size, clock_type::time_point now ) {
+			// The write starts where the samples that are queued ahead of
+			// the read cursor end
+			_renderer.render( ptr, size, now + _scheduler.latency() );
+			_scheduler.commit( size );
+		}
+
+		// play_async()
+		void null_audio_stream::play_async( sample_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void null_audio_stream::play_async( planar_provider_func f ) {
+			play_async( _renderer.adopt( std::move(f) ) );
+		}
+
+		// play_async()
+		void null_audio_stream::play_async( sample_provider& provider ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			// A stream that was stopped from the play thread may still
+			// be updated
+			_device.play_thread().wait_for_update();
+			_renderer.set_sample_provider( provider );
+			_device_started = false;
+			_renderer.rewind();
+			_scheduler.reset();
+			_device.play_thread().ensure_running();
+			_connection = _device.play_thread().on_update.connect( [this]( duration_type const& delta ) { update( delta ); } );
+			_state = audio_stream_state::playing;
+			_device.play_thread().notify();
+		}
+
+		// stop()
+		void null_audio_stream::stop() {
+			// The play thread holds the lock of the update signal, which
+			// play_async() takes while holding ours, so it doesn't take
+			// ours. The signal lock keeps it from racing play_async().
+			std::unique_lock<std::mutex> lock{_mutex, std::defer_lock};
+			if( !_device.play_thread().on_loop_thread() ) {
+				lock.lock();
+			}
+			auto state = audio_stream_state::playing;
+			if( _state.compare_exchange_strong( state, audio_stream_state::ready ) ) {
+				_device.play_thread().disconnect( _connection.release() );
+			}
+			else {
+				// The stream may have been stopped from the play thread,
+				// which may still be updating it
+				_device.play_thread().wait_for_update();
+			}
+		}
+
+		// state()
+		audio_stream_state null_audio_stream::state() const {
+			return _state;
+		}
+
+		// configuration()
+		stream_configuration null_audio_stream::configuration() const {
+			return _scheduler.configuration();
+		}
+
+		// statistics()
+		stream_statistics null_audio_stream::statistics() const {
+			return _scheduler.statistics();
+		}
+
+		// set_underrun_handler()
+		void null_audio_stream::set_underrun_handler( underrun_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_scheduler.set_underrun_handler( std::move(f) );
+		}
+
+		// callback_timing()
+		callback_statistics null_audio_stream::callback_timing() const {
+			return _renderer.statistics();
+		}
+
+		// set_budget_handler()
+		void null_audio_stream::set_budget_handler( float fraction, budget_handler_func f ) {
+			std::unique_lock<std::mutex> lock{_mutex};
+			_renderer.set_budget_handler( fraction, std::move(f) );
+		}
+
+		// timeline()
+		stream_timeline& null_audio_stream::timeline() {
+			return _renderer.timeline();
+		}
+
+		// latency()
+		std::chrono::nanoseconds null_audio_stream::latency() const {
+			return _scheduler.latency();
+		}
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_NULL)
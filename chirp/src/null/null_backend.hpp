@@ -0,0 +1,223 @@
+#ifndef IG_CHIRP_SRC_NULL_BACKEND_HPP
+#define IG_CHIRP_SRC_NULL_BACKEND_HPP
+
+#include <chirp/static_config.hpp>
+
+#if defined(CHIRP_WITH_NULL)
+
+#include <chirp/backend.hpp>
+#include <chirp/exceptions.hpp>
+#include <chirp/sample_request.hpp>
+#include <nod/nod.hpp>
+
+#include "../engine/render_loop.hpp"
+#include "../engine/ring_buffer_scheduler.hpp"
+#include "../engine/stream_renderer.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace chirp
+{
+	namespace backend
+	{
+		// Exceptions
+
+		/// Root exceptions for all exceptional events within the null
+		/// backend.
+		struct null_exception :
+			chirp::backend_exception
+		{};
+
+		/// Audio device implementation for the null backend.
+		///
+		/// The null output device doesn't output any audio, but it drives
+		/// its audio streams at the same pace as a real device would, by
+		/// simulating a hardware read cursor with a monotonic clock.
+		class null_output_device :
+			public backend::output_device
+		{
+			public:
+				/// Parameterized constructor
+				/// @param name   The name of the device
+				null_output_device( std::string const& name );
+
+				/// @returns The device name
+				std::string name() const override {
+					return _name;
+				}
+
+				/// Create a new audio stream instance with a given format.
+				std::unique_ptr<audio_stream> create_audio_stream( audio_format const& format, stream_options const& options ) override;
+
+				/// @returns `true`, as the null device plays any format
+				bool supports( audio_format const& ) const override {
+					return true;
+				}
+
+				/// Check for equality
+				bool operator==(output_device const& other) const override;
+
+				/// @returns The play thread of the device
+				render_loop& play_thread() {
+					return _play_thread;
+				}
+
+			private:
+				/// The device name
+				std::string _name;
+				/// Play thread
+				render_loop _play_thread;
+		};
+
+		/// Audio stream implementation for the null backend.
+		class null_audio_stream :
+			public backend::audio_stream
+		{
+			public:
+				/// Clock used for simulating the hardware read cursor
+				using clock_type = std::chrono::steady_clock;
+				/// Function that tells the time of the simulated device
+				using clock_func = std::function<clock_type::time_point()>;
+
+				/// Create a null audio stream instance.
+				/// @param device   The null audio device that is to
+				///                 play the audio stream.
+				/// @param format    The requested format of the audio stream
+				/// @param options   The requested buffer configuration
+				/// @param clock     The clock that the simulated device plays
+				///                  by. Tests may pass a clock that they
+				///                  advance themselves, the play thread still
+				///                  sleeps in real time.
+				null_audio_stream( null_output_device& device, audio_format const& format, stream_options const& options, clock_func clock = &clock_type::now );
+
+				/// Destroy the audio stream.
+				~null_audio_stream() {
+					stop();
+				}
+
+				/// @returns the state of the audio stream
+				audio_stream_state state() const override;
+
+				/// Start playing the audio stream asyncronously
+				void play_async( sample_provider_func f ) override;
+
+				/// Start playing the audio stream asyncronously, without
+				/// taking ownership of the sample provider
+				void play_async( sample_provider& provider ) override;
+
+				/// Start playing the audio stream with a planar provider function
+				/// @param f   The function
+				void play_async( planar_provider_func f ) override;
+
+				/// Stop playing the audio stream if it is playing
+				void stop() override;
+
+				/// @returns The buffer configuration that the stream uses
+				stream_configuration configuration() const override;
+
+				/// @returns The underrun counters of the stream
+				stream_statistics statistics() const override;
+
+				/// Set the function that is called when an underrun is detected
+				void set_underrun_handler( underrun_handler_func f ) override;
+
+				/// @returns The timing of the sample provider
+				callback_statistics callback_timing() const override;
+
+				/// Set the function that is called when the sample provider
+				/// uses more than a fraction of its budget
+				void set_budget_handler( float fraction, budget_handler_func f ) override;
+
+				/// @returns The frame timeline of the stream
+				stream_timeline& timeline() override;
+
+				/// @returns The time until a frame that is rendered now is
+				///          played
+				std::chrono::nanoseconds latency() const override;
+
+				/// Update function that will be called by the play thread
+				/// at each update tick while the audio stream is playing.
+				/// This function is responsible for requesting new samples
+				/// to "send" to the device, and for arming the play thread
+				/// timer for when the next period has been played.
+				/// @param delta   The time duration since the last time the
+				///                update function was called for this audio
+				///                stream instance. The elapsed time is
+				///                measured on the clock of the stream instead.
+				void update( duration_type const& delta );
+
+			private:
+				/// Simulate the hardware read cursor of the buffer
+				/// @param now   The current time
+				/// @returns The buffer position (in bytes) that the simulated
+				///          device is currently reading from.
+				std::uint32_t read_cursor( clock_type::time_point now ) const;
+
+				/// Create a sample request and call the current sample provider
+				/// @param ptr            Pointer into the buffer where samples
+				///                       should be written.
+				/// @param size           The number of bytes of the memory
+				///                       buffer that should be filled with
+				///                       samples.
+				/// @param now            The current time, from which the
+				///                       presentation time is derived.
+				void issue_sample_request( void* ptr, std::uint32_t size, clock_type::time_point now );
+
+				/// Device reference
+				null_output_device& _device;
+				/// Audio format
+				audio_format _format;
+				/// The simulated device buffer
+				std::vector<std::uint8_t> _buffer;
+				/// Current audio state
+				std::atomic<audio_stream_state> _state;
+				/// Connection to the device update callback
+				nod::scoped_connection _connection;
+				/// Flag telling if the simulated device has started reading
+				bool _device_started;
+				/// The point in time when the simulated device started reading
+				clock_type::time_point _play_start;
+				/// The point in time of the last update
+				clock_type::time_point _last_update;
+				/// The clock of the simulated device
+				clock_func _clock;
+				/// Mutex for syncronizing the internal state
+				std::mutex _mutex;
+				/// Scheduler for writing ahead of the simulated read cursor
+				ring_buffer_scheduler _scheduler;
+				/// Issues sample requests to the sample provider
+				stream_renderer _renderer;
+		};
+
+		/// Implementation of the null platform
+		class null_platform :
+			public backend::platform
+		{
+			public:
+				/// Default constructor
+				null_platform();
+				/// Destructor
+				~null_platform();
+
+				/// Create an instance of the default outout device
+				output_device_ptr default_output_device() const override;
+
+				/// @returns collection of output devices
+				output_device_collection get_output_devices() const override;
+
+			private:
+				/// The only output device of the platform
+				std::shared_ptr<null_output_device> _output_device;
+		};
+	}   // namespace backend
+}   // namespace chirp
+
+#endif   // defined(CHIRP_WITH_NULL)
+#endif   // IG_CHIRP_SRC_NULL_BACKEND_HPP
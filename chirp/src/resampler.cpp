@@ -0,0 +1,211 @@
+#include <chirp/resampler.hpp>
+#include "engine/conversion_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	/// The filter parameters of a quality tier
+	struct quality_tier
+	{
+		/// Number of taps when the frequency isn't lowered, a multiple
+		/// of sixteen so that the vector kernels have no tails
+		std::size_t taps;
+		/// Number of phases between two input frames
+		std::size_t phases;
+		/// Cut-off frequency as a fraction of the lower Nyquist frequency
+		double rolloff;
+		/// Shape parameter of the Kaiser window, which trades the width of
+		/// the transition band against the suppression of the stop band
+		double beta;
+	};
+
+	/// The tiers, in the order of `chirp::resample_quality`
+	quality_tier const QualityTiers[] = {
+		{ 16, 128, 0.80, 6.0 },
+		{ 32, 512, 0.90, 9.0 },
+		{ 64, 1024, 0.94, 12.0 }
+	};
+
+	/// Number of input frames that are added to the history at a time
+	std::size_t const BlockFrames = 1024;
+
+	/// How far the ratio can be lowered by default, relative to the ratio
+	/// that a resampler is created with. The filter isn't made longer for
+	/// a change this small, as it barely widens the transition band.
+	double const DriftTolerance = 0.01;
+
+	/// Pi
+	double const Pi = 3.14159265358979323846;
+
+	/// Modified Bessel function of the first kind and order zero
+	double bessel_i0( double x ) {
+		double sum = 1.0;
+		double term = 1.0;
+		for( int k=1; k<50 && term > sum * 1e-12; ++k ) {
+			auto factor = x / (2.0 * k);
+			term *= factor * factor;
+			sum += term;
+		}
+		return sum;
+	}
+
+	/// @returns The parameters of a quality tier
+	quality_tier const& tier_of( chirp::resample_quality quality ) {
+		return QualityTiers[static_cast<std::size_t>( quality )];
+	}
+
+	/// Calculate the number of taps for a ratio. Lowering the frequency
+	/// lowers the cut-off, and the filter has to be longer by the same
+	/// factor to keep its transition band as steep.
+	std::size_t taps_for( chirp::resample_quality quality, double ratio ) {
+		auto taps = static_cast<std::size_t>( std::ceil( static_cast<double>( tier_of( quality ).taps ) / std::min( 1.0, ratio ) ) );
+		return (taps + 15) / 16 * 16;
+	}
+
+	/// @returns The lowest ratio of a resampler
+	double lowest_for( double ratio, double lowest ) {
+		if( lowest == 0.0 ) {
+			return std::max( chirp::resampler::minimum_ratio, ratio * (1.0 - DriftTolerance) );
+		}
+		if( !(lowest <= ratio) ) {
+			throw chirp::resampler_exception{};
+		}
+		return lowest;
+	}
+}   // anonymous namespace
+
+namespace chirp
+{
+	// constructor
+	resampler::resampler( channel_count channels, double ratio, resample_quality quality, double lowest ) :
+		_channels( channels ),
+		_quality( quality ),
+		_ratio( check( ratio ) ),
+		_lowest( check( lowest_for( ratio, lowest ) ) ),
+		_step( 1.0 / ratio ),
+		_taps( taps_for( quality, lowest == 0.0 ? ratio : _lowest ) ),
+		_phases( tier_of( quality ).phases ),
+		_coefficients( (_phases + 1) * _taps, 0.0f ),
+		_history(),
+		_capacity( _taps + BlockFrames ),
+		_filled( 0 ),
+		_time( 0.0 ),
+		_kernels( &backend::kernels_for( backend::detected_simd_level() ) )
+	{
+		if( channels == 0 ) {
+			throw resampler_exception{};
+		}
+		_history.assign( _capacity * channels, 0.0f );
+		design();
+		reset();
+	}
+
+	// set_ratio()
+	void resampler::set_ratio( double ratio ) {
+		// The filter already suppresses everything above the Nyquist
+		// frequency of the lowest ratio
+		if( check( ratio ) < _lowest ) {
+			throw resampler_exception{};
+		}
+		_ratio = ratio;
+		_step = 1.0 / ratio;
+	}
+
+	// process()
+	resampler::result resampler::process( float const* input, std::size_t input_frames, float* output, std::size_t output_frames ) {
+		result done{ 0, 0 };
+		while( done.output_frames < output_frames ) {
+			auto start = static_cast<std::size_t>( _time );
+			if( start + _taps > _filled ) {
+				if( done.input_frames == input_frames ) {
+					break;
+				}
+
+				// Drop the frames that no output frame is filtered from any
+				// more, and append input frames to each channel
+				if( start > 0 ) {
+					for( std::size_t c=0; c<_channels; ++c ) {
+						auto* history = _history.data() + c * _capacity;
+						std::memmove( history, history + start, (_filled - start) * sizeof(float) );
+					}
+					_filled -= start;
+					_time -= static_cast<double>( start );
+				}
+				auto count = std::min( input_frames - done.input_frames, _capacity - _filled );
+				auto const* frames = input + done.input_frames * _channels;
+				for( std::size_t c=0; c<_channels; ++c ) {
+					auto* history = _history.data() + c * _capacity + _filled;
+					for( std::size_t i=0; i<count; ++i ) {
+						history[i] = frames[i * _channels + c];
+					}
+				}
+				_filled += count;
+				done.input_frames += count;
+				continue;
+			}
+
+			// The fraction selects the two phases to interpolate between
+			auto position = (_time - static_cast<double>( start )) * static_cast<double>( _phases );
+			auto phase = std::min( static_cast<std::size_t>( position ), _phases - 1 );
+			auto fraction = static_cast<float>( position - static_cast<double>( phase ) );
+			auto const* coefficients = _coefficients.data() + phase * _taps;
+			auto* frame = output + done.output_frames * _channels;
+			for( std::size_t c=0; c<_channels; ++c ) {
+				frame[c] = _kernels->fir( _history.data() + c * _capacity + start, coefficients, coefficients + _taps, fraction, _taps );
+			}
+			_time += _step;
+			++done.output_frames;
+		}
+		return done;
+	}
+
+	// reset()
+	void resampler::reset() {
+		// The history starts with silence up to the center of the filter,
+		// so that the first output frame is filtered around the first
+		// input frame
+		std::fill( _history.begin(), _history.end(), 0.0f );
+		_filled = _taps / 2 - 1;
+		_time = 0.0;
+	}
+
+	// design()
+	void resampler::design() {
+		auto const& tier = tier_of( _quality );
+		auto cutoff = tier.rolloff * std::min( 1.0, _lowest );
+		auto half = static_cast<double>( _taps / 2 );
+		auto center = half - 1.0;
+		auto window_scale = 1.0 / bessel_i0( tier.beta );
+		for( std::size_t p=0; p<=_phases; ++p ) {
+			// Each phase is the windowed sinc shifted by a fraction of a
+			// frame, and is normalized so that it passes DC unchanged
+			auto shift = static_cast<double>( p ) / static_cast<double>( _phases );
+			auto* coefficients = _coefficients.data() + p * _taps;
+			double sum = 0.0;
+			for( std::size_t k=0; k<_taps; ++k ) {
+				auto x = static_cast<double>( k ) - center - shift;
+				auto y = cutoff * x;
+				auto sinc = std::abs( y ) < 1e-9 ? 1.0 : std::sin( Pi * y ) / (Pi * y);
+				auto r = x / half;
+				auto window = r * r < 1.0 ? bessel_i0( tier.beta * std::sqrt( 1.0 - r * r ) ) * window_scale : 0.0;
+				auto value = cutoff * sinc * window;
+				coefficients[k] = static_cast<float>( value );
+				sum += value;
+			}
+			for( std::size_t k=0; k<_taps; ++k ) {
+				coefficients[k] = static_cast<float>( coefficients[k] / sum );
+			}
+		}
+	}
+
+	// check()
+	double resampler::check( double ratio ) {
+		if( !(ratio >= minimum_ratio && ratio <= maximum_ratio) ) {
+			throw resampler_exception{};
+		}
+		return ratio;
+	}
+}   // namespace chirp
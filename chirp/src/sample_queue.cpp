@@ -0,0 +1,110 @@
+#include <chirp/sample_queue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	/// The shortest time that a blocking write waits before it checks for
+	/// room in the queue again
+	auto const MinimumWait = std::chrono::milliseconds{1};
+
+	/// The longest time that a blocking write waits before it checks for
+	/// room again, which is how long it may take to notice that the queue
+	/// has been closed
+	auto const MaximumWait = std::chrono::milliseconds{10};
+}   // anonymous namespace
+
+namespace chirp
+{
+	// constructor
+	sample_queue::sample_queue( audio_format const& format, frame_count capacity_frames, frame_count high_water_frames ) :
+		_format( format ),
+		_capacity( capacity_frames ),
+		_high_water( high_water_frames == 0 ? capacity_frames : high_water_frames ),
+		_buffer( capacity_frames * format.bytes_per_frame(), 0 ),
+		_write_index( 0 ),
+		_read_index( 0 ),
+		_closed( false )
+	{
+		if( _capacity == 0 || _high_water > _capacity ) {
+			throw push_mode_exception{};
+		}
+	}
+
+	// try_write()
+	sample_queue::frame_count sample_queue::try_write( void const* ptr, frame_count frames ) {
+		if( closed() ) {
+			return 0;
+		}
+		auto write_index = _write_index.load( std::memory_order_relaxed );
+		auto queued = static_cast<frame_count>( write_index - _read_index.load( std::memory_order_acquire ) );
+		auto count = std::min( frames, _high_water - std::min( queued, _high_water ) );
+		if( count == 0 ) {
+			return 0;
+		}
+
+		// Copy in at most two parts, as the frames may wrap around the end
+		// of the ring buffer
+		auto bytes_per_frame = _format.bytes_per_frame();
+		auto position = static_cast<frame_count>( write_index % _capacity );
+		auto first = std::min( count, _capacity - position );
+		auto const* source = static_cast<std::uint8_t const*>( ptr );
+		std::memcpy( _buffer.data() + position * bytes_per_frame, source, first * bytes_per_frame );
+		std::memcpy( _buffer.data(), source + first * bytes_per_frame, (count - first) * bytes_per_frame );
+
+		_write_index.store( write_index + count, std::memory_order_release );
+		return count;
+	}
+
+	// write()
+	sample_queue::frame_count sample_queue::write( void const* ptr, frame_count frames ) {
+		return write( ptr, frames, std::chrono::nanoseconds::max() );
+	}
+
+	// write()
+	sample_queue::frame_count sample_queue::write( void const* ptr, frame_count frames, std::chrono::nanoseconds timeout ) {
+		auto const* source = static_cast<std::uint8_t const*>( ptr );
+		auto start = std::chrono::steady_clock::now();
+		frame_count written = 0;
+		while( true ) {
+			written += try_write( source + written * _format.bytes_per_frame(), frames - written );
+			if( written == frames || closed() ) {
+				return written;
+			}
+			auto waited = std::chrono::steady_clock::now() - start;
+			if( waited >= timeout ) {
+				return written;
+			}
+
+			// The play thread never signals the producer, so wait for about
+			// as long as it takes to play the frames that don't fit
+			auto missing = std::min( frames - written, _high_water );
+			std::chrono::nanoseconds wait( (static_cast<std::uint64_t>(missing) * std::nano::den) / _format.frequency() );
+			wait = std::min<std::chrono::nanoseconds>( std::max<std::chrono::nanoseconds>( wait, MinimumWait ), MaximumWait );
+			std::this_thread::sleep_for( std::min( wait, timeout - std::chrono::duration_cast<std::chrono::nanoseconds>( waited ) ) );
+		}
+	}
+
+	// fill_samples()
+	fill_result sample_queue::fill_samples( duration_type const&, sample_request const& request ) {
+		auto read_index = _read_index.load( std::memory_order_relaxed );
+		auto available = static_cast<frame_count>( _write_index.load( std::memory_order_acquire ) - read_index );
+		auto count = std::min<frame_count>( request.frames(), available );
+		if( count == 0 ) {
+			return fill_result{ 0, false };
+		}
+
+		auto bytes_per_frame = _format.bytes_per_frame();
+		auto position = static_cast<frame_count>( read_index % _capacity );
+		auto first = std::min( count, _capacity - position );
+		auto* target = static_cast<std::uint8_t*>( request.buffer_start() );
+		std::memcpy( target, _buffer.data() + position * bytes_per_frame, first * bytes_per_frame );
+		std::memcpy( target + first * bytes_per_frame, _buffer.data(), (count - first) * bytes_per_frame );
+
+		_read_index.store( read_index + count, std::memory_order_release );
+		return fill_result{ static_cast<sample_request::sample_count>( count ), false };
+	}
+}   // namespace chirp
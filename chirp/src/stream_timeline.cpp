@@ -0,0 +1,92 @@
+#include <chirp/stream_timeline.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace chirp
+{
+	// Definitions of the constants, which are needed before C++17
+	constexpr stream_timeline::frame_type stream_timeline::never;
+	constexpr std::size_t stream_timeline::max_events;
+
+	// constructor
+	stream_timeline::stream_timeline() :
+		_position( 0 ),
+		_start_frame( 0 ),
+		_stop_frame( never ),
+		_end_frame( never ),
+		_incoming_write( 0 ),
+		_incoming_read( 0 ),
+		_event_count( 0 )
+	{
+	}
+
+	// schedule_event()
+	void stream_timeline::schedule_event( frame_type frame, timeline_event_func f ) {
+		std::unique_lock<std::mutex> lock{_schedule_mutex};
+		auto write = _incoming_write.load( std::memory_order_relaxed );
+		if( write - _incoming_read.load( std::memory_order_acquire ) == max_events ) {
+			throw stream_timeline_exception{};
+		}
+		_incoming[write % max_events] = event{ frame, std::move(f) };
+		_incoming_write.store( write + 1, std::memory_order_release );
+	}
+
+	// rewind()
+	void stream_timeline::rewind() {
+		_position.store( 0, std::memory_order_release );
+		_end_frame.store( never, std::memory_order_release );
+	}
+
+	// collect_events()
+	void stream_timeline::collect_events() {
+		auto read = _incoming_read.load( std::memory_order_relaxed );
+		auto write = _incoming_write.load( std::memory_order_acquire );
+		while( read != write && _event_count < max_events ) {
+			// Insert the event in frame order, after events at the same frame
+			auto& incoming = _incoming[read % max_events];
+			auto index = _event_count;
+			while( index > 0 && _events[index - 1].frame > incoming.frame ) {
+				_events[index] = std::move( _events[index - 1] );
+				--index;
+			}
+			_events[index] = std::move( incoming );
+			++_event_count;
+			++read;
+		}
+		_incoming_read.store( read, std::memory_order_release );
+	}
+
+	// fire_events()
+	void stream_timeline::fire_events( frame_type frame ) {
+		collect_events();
+		std::size_t fired = 0;
+		while( fired < _event_count && _events[fired].frame <= frame ) {
+			auto& due = _events[fired];
+			if( due.func ) {
+				due.func( due.frame );
+			}
+			due.func = nullptr;
+			++fired;
+		}
+		if( fired > 0 ) {
+			std::move( _events.begin() + fired, _events.begin() + _event_count, _events.begin() );
+			_event_count -= fired;
+		}
+	}
+
+	// next_boundary()
+	stream_timeline::frame_type stream_timeline::next_boundary( frame_type frame ) const {
+		auto result = never;
+		for( auto boundary : { start_frame(), stop_frame(), end_frame() } ) {
+			if( boundary > frame ) {
+				result = std::min( result, boundary );
+			}
+		}
+		// Events at or before the frame have been fired already
+		if( _event_count > 0 ) {
+			result = std::min( result, std::max( _events[0].frame, frame + 1 ) );
+		}
+		return result;
+	}
+}   // namespace chirp
@@ -0,0 +1,384 @@
+#include <chirp/voice_engine.hpp>
+#include "engine/conversion_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	/// Number of frames that the voices are swept in at a time
+	std::size_t const BlockFrames = 256;
+
+	/// The smallest number of requests that the ring holds
+	std::size_t const MinimumCommands = 64;
+
+	/// @returns The number of requests that the ring of a voice engine
+	///          holds, a power of two so that positions wrap around
+	std::size_t command_capacity( std::size_t voices ) {
+		std::size_t capacity = MinimumCommands;
+		while( capacity < 2 * voices ) {
+			capacity *= 2;
+		}
+		return capacity;
+	}
+
+	/// A quarter turn, for the constant power pan law
+	float const QuarterPi = 0.785398163f;
+}   // anonymous namespace
+
+namespace chirp
+{
+	constexpr float voice_engine::maximum_pitch;
+
+	// constructor
+	voice_engine::voice_engine( audio_format const& format, std::size_t voices ) :
+		_format( format ),
+		_kernels( &backend::kernels_for( backend::detected_simd_level() ) ),
+		_sources( voices, nullptr ),
+		_lengths( voices, 0 ),
+		_positions( voices, 0.0 ),
+		_pitches( voices, 1.0f ),
+		_gains( voices, 1.0f ),
+		_pans( voices, 0.0f ),
+		_left_gains( voices, 0.0f ),
+		_right_gains( voices, 0.0f ),
+		_priorities( voices, 0 ),
+		_serials( voices ),
+		_scratch( BlockFrames, 0.0f ),
+		_playing_voices( 0 ),
+		_commands( command_capacity( voices ) ),
+		_placements( _commands.size() ),
+		_enqueued( 0 ),
+		_applied( 0 ),
+		_played( 0 ),
+		_stolen( 0 ),
+		_rejected( 0 )
+	{
+		auto const& samples = format.sample_format();
+		if( samples.type() != sample_type::floating_point || samples.bits_per_sample() != 32
+			|| samples.endianness() != native_byte_order || samples.channels() < 1 || samples.channels() > 2 ) {
+			throw sample_format_exception{};
+		}
+		if( voices == 0 || voices > 0xffffffffu ) {
+			throw voice_exception{};
+		}
+		_playing.reserve( voices );
+		_free.reserve( voices );
+		for( auto index = voices; index > 0; --index ) {
+			_free.push_back( static_cast<std::uint32_t>( index - 1 ) );
+		}
+		for( std::size_t position=0; position<_commands.size(); ++position ) {
+			_commands[position].sequence.store( position );
+			_placements[position].store( static_cast<std::uint32_t>( voices ) );
+		}
+	}
+
+	// play()
+	voice_handle voice_engine::play( float const* samples, frame_count frames, voice_parameters const& parameters ) {
+		if( samples == nullptr || frames == 0 ) {
+			throw voice_exception{};
+		}
+		command request{ command_type::play, 0, samples, frames, parameters, 0.0f };
+		request.parameters.pitch = check_pitch( parameters.pitch );
+		auto serial = post( request );
+		if( serial == 0 ) {
+			++_rejected;
+		}
+		return voice_handle{ serial };
+	}
+
+	// stop()
+	void voice_engine::stop( voice_handle voice ) {
+		if( voice ) {
+			post( command{ command_type::stop, voice.serial, nullptr, 0, voice_parameters{}, 0.0f } );
+		}
+	}
+
+	// stop_all()
+	void voice_engine::stop_all() {
+		post( command{ command_type::stop_all, 0, nullptr, 0, voice_parameters{}, 0.0f } );
+	}
+
+	// set_gain()
+	void voice_engine::set_gain( voice_handle voice, float gain ) {
+		if( voice ) {
+			post( command{ command_type::set_gain, voice.serial, nullptr, 0, voice_parameters{}, gain } );
+		}
+	}
+
+	// set_pan()
+	void voice_engine::set_pan( voice_handle voice, float pan ) {
+		if( voice ) {
+			post( command{ command_type::set_pan, voice.serial, nullptr, 0, voice_parameters{}, pan } );
+		}
+	}
+
+	// set_pitch()
+	void voice_engine::set_pitch( voice_handle voice, float pitch ) {
+		pitch = check_pitch( pitch );
+		if( voice ) {
+			post( command{ command_type::set_pitch, voice.serial, nullptr, 0, voice_parameters{}, pitch } );
+		}
+	}
+
+	// is_playing()
+	bool voice_engine::is_playing( voice_handle voice ) const {
+		if( !voice ) {
+			return false;
+		}
+		// Requests that haven't been applied yet are still to play
+		return voice.serial > _applied.load() || find( voice.serial ) < _serials.size();
+	}
+
+	// statistics()
+	voice_statistics voice_engine::statistics() const {
+		return voice_statistics{ _played, _stolen, _rejected };
+	}
+
+	// fill_samples()
+	fill_result voice_engine::fill_samples( duration_type const&, sample_request const& request ) {
+		auto channels = _format.channels();
+		auto* target = static_cast<float*>( request.buffer_start() );
+		std::size_t frames = request.frames();
+		std::size_t done = 0;
+		while( done < frames ) {
+			apply_commands();
+			if( _playing.empty() ) {
+				break;
+			}
+			auto count = std::min( frames - done, BlockFrames );
+			auto* block = target + done * channels;
+			std::fill( block, block + count * channels, 0.0f );
+			for( auto index : _playing ) {
+				render_voice( index, block, count );
+			}
+			// Release the voices that have ended or were stopped
+			for( std::size_t i=0; i<_playing.size(); ) {
+				auto index = _playing[i];
+				if( _positions[index] >= static_cast<double>( _lengths[index] ) ) {
+					_lengths[index] = 0;
+					_sources[index] = nullptr;
+					_serials[index] = 0;
+					_free.push_back( index );
+					_playing[i] = _playing.back();
+					_playing.pop_back();
+				}
+				else {
+					++i;
+				}
+			}
+			done += count;
+		}
+		_playing_voices = _playing.size();
+		_kernels->clip( target, done * channels );
+		return fill_result{ static_cast<sample_request::sample_count>( done ), false };
+	}
+
+	// post()
+	std::uint64_t voice_engine::post( command const& request ) {
+		// Each cell tells the position that can be written next, so
+		// producers claim a position and the play thread knows which cells
+		// are complete
+		auto mask = _commands.size() - 1;
+		auto position = _enqueued.load( std::memory_order_relaxed );
+		command_cell* cell;
+		while( true ) {
+			cell = &_commands[position & mask];
+			auto sequence = cell->sequence.load( std::memory_order_acquire );
+			if( sequence == position ) {
+				if( _enqueued.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+					break;
+				}
+			}
+			else if( sequence < position ) {
+				return 0;
+			}
+			else {
+				position = _enqueued.load( std::memory_order_relaxed );
+			}
+		}
+		cell->request = request;
+		cell->sequence.store( position + 1, std::memory_order_release );
+		return position + 1;
+	}
+
+	// apply_commands()
+	void voice_engine::apply_commands() {
+		auto mask = _commands.size() - 1;
+		auto position = _applied.load( std::memory_order_relaxed );
+		while( true ) {
+			auto& cell = _commands[position & mask];
+			if( cell.sequence.load( std::memory_order_acquire ) != position + 1 ) {
+				break;
+			}
+			auto const& request = cell.request;
+			auto serial = position + 1;
+			if( request.type == command_type::play ) {
+				start_voice( serial, request );
+			}
+			else if( request.type == command_type::stop_all ) {
+				for( auto index : _playing ) {
+					_lengths[index] = 0;
+					_serials[index] = 0;
+				}
+			}
+			else {
+				auto index = find( request.serial );
+				if( index < _serials.size() ) {
+					switch( request.type ) {
+						case command_type::stop:
+							// The voice is released by the next sweep
+							_lengths[index] = 0;
+							_serials[index] = 0;
+							break;
+						case command_type::set_gain:
+							_gains[index] = request.value;
+							update_gains( index );
+							break;
+						case command_type::set_pan:
+							_pans[index] = request.value;
+							update_gains( index );
+							break;
+						default:
+							_pitches[index] = request.value;
+							break;
+					}
+				}
+			}
+			cell.sequence.store( position + _commands.size(), std::memory_order_release );
+			++position;
+			_applied.store( position, std::memory_order_release );
+		}
+	}
+
+	// start_voice()
+	void voice_engine::start_voice( std::uint64_t serial, command const& request ) {
+		auto const& parameters = request.parameters;
+		std::uint32_t index;
+		if( !_free.empty() ) {
+			index = _free.back();
+			_free.pop_back();
+			_playing.push_back( index );
+		}
+		else {
+			// Take over a voice that was stopped, or else the oldest voice
+			// of the lowest priority
+			auto victim = *std::min_element( _playing.begin(), _playing.end(), [this]( std::uint32_t a, std::uint32_t b ) {
+				if( (_lengths[a] == 0) != (_lengths[b] == 0) ) {
+					return _lengths[a] == 0;
+				}
+				if( _priorities[a] != _priorities[b] ) {
+					return _priorities[a] < _priorities[b];
+				}
+				return _serials[a].load( std::memory_order_relaxed ) < _serials[b].load( std::memory_order_relaxed );
+			});
+			if( _lengths[victim] != 0 ) {
+				if( _priorities[victim] > parameters.priority ) {
+					++_rejected;
+					return;
+				}
+				++_stolen;
+			}
+			index = victim;
+		}
+
+		_sources[index] = request.samples;
+		_lengths[index] = request.frames;
+		_positions[index] = 0.0;
+		_pitches[index] = parameters.pitch;
+		_gains[index] = parameters.gain;
+		_pans[index] = parameters.pan;
+		_priorities[index] = parameters.priority;
+		_serials[index] = serial;
+		_placements[serial & (_commands.size() - 1)] = index;
+		update_gains( index );
+		++_played;
+	}
+
+	// find()
+	std::size_t voice_engine::find( std::uint64_t serial ) const {
+		// The slot is remembered at the position of the request, until
+		// the ring wraps around and another sound is played there
+		std::size_t index = _placements[serial & (_commands.size() - 1)];
+		if( index < _serials.size() && _serials[index] == serial ) {
+			return index;
+		}
+		if( serial + _commands.size() > _applied.load() ) {
+			return _serials.size();
+		}
+		for( index=0; index<_serials.size(); ++index ) {
+			if( _serials[index] == serial ) {
+				return index;
+			}
+		}
+		return _serials.size();
+	}
+
+	// update_gains()
+	void voice_engine::update_gains( std::size_t index ) {
+		auto gain = _gains[index];
+		if( _format.channels() == 1 ) {
+			_left_gains[index] = gain;
+			_right_gains[index] = 0.0f;
+		}
+		else {
+			auto angle = (std::min( std::max( _pans[index], -1.0f ), 1.0f ) + 1.0f) * QuarterPi;
+			_left_gains[index] = gain * std::cos( angle );
+			_right_gains[index] = gain * std::sin( angle );
+		}
+	}
+
+	// render_voice()
+	void voice_engine::render_voice( std::size_t index, float* target, std::size_t frames ) {
+		auto const* source = _sources[index];
+		auto length = _lengths[index];
+		auto position = _positions[index];
+		auto pitch = static_cast<double>( _pitches[index] );
+		bool mono = _format.channels() == 1;
+		auto* scratch = _scratch.data();
+
+		// The kernel reads the frames that are clear of the last two
+		// samples, so that rounding the positions to float never reads
+		// past the end
+		std::size_t fast = 0;
+		auto end = static_cast<double>( length ) - 2.0;
+		if( position < end ) {
+			fast = std::min( frames, static_cast<std::size_t>( std::ceil( (end - position) / pitch ) ) );
+			auto first = std::floor( position );
+			_kernels->interpolate( source + static_cast<std::size_t>( first ), scratch, fast,
+				static_cast<float>( position - first ), static_cast<float>( pitch ), mono ? _left_gains[index] : 1.0f );
+		}
+		// The rest fades to silence after the last sample
+		auto rendered = fast;
+		auto gain = mono ? _left_gains[index] : 1.0f;
+		for( ; rendered < frames; ++rendered ) {
+			auto at = position + static_cast<double>( rendered ) * pitch;
+			if( at >= static_cast<double>( length ) ) {
+				break;
+			}
+			auto sample = static_cast<std::size_t>( at );
+			auto fraction = static_cast<float>( at - static_cast<double>( sample ) );
+			auto a = source[sample];
+			auto b = sample + 1 < length ? source[sample + 1] : 0.0f;
+			scratch[rendered] = gain * (a + fraction * (b - a));
+		}
+
+		if( mono ) {
+			_kernels->mix( scratch, target, rendered );
+		}
+		else {
+			_kernels->pan( scratch, target, rendered, _left_gains[index], _right_gains[index] );
+		}
+		_positions[index] = position + static_cast<double>( frames ) * pitch;
+	}
+
+	// check_pitch()
+	float voice_engine::check_pitch( float pitch ) {
+		if( !(pitch > 0.0f && pitch <= maximum_pitch) ) {
+			throw voice_exception{};
+		}
+		return pitch;
+	}
+}   // namespace chirp
@@ -0,0 +1,143 @@
+#include <chirp/chirp.hpp>
+#include <chirp/sample_provider.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/// Number of allocations made by the program
+std::atomic<std::size_t> allocation_count{ 0 };
+
+/// Count all allocations
+void* operator new( std::size_t size ) {
+	++allocation_count;
+	if( void* ptr = std::malloc( size ? size : 1 ) ) {
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+
+/// Matching deallocation for the counting `operator new`
+void operator delete( void* ptr ) noexcept {
+	std::free( ptr );
+}
+
+/// Matching sized deallocation for the counting `operator new`
+void operator delete( void* ptr, std::size_t ) noexcept {
+	std::free( ptr );
+}
+
+/// Default number of calls to time, if none is specified on the command line
+const int default_iterations = 10000000;
+
+/// Sample provider state, large enough to never fit in the small buffer
+/// of a `std::function`
+struct provider_state
+{
+	/// Some filter state that a real provider could have
+	std::array<float, 256> history;
+	/// Number of bytes that have been requested
+	std::uint64_t sink;
+};
+
+/// Count the allocations made while starting a stream
+/// @param start   Function that starts the stream
+/// @returns The number of allocations
+template <class F>
+std::size_t allocations_while( F start ) {
+	auto before = allocation_count.load();
+	start();
+	return allocation_count.load() - before;
+}
+
+/// Time calls to a sample provider
+/// @param iterations   Number of calls
+/// @param call         Function making one call
+/// @returns Nanoseconds per call
+template <class F>
+double time_calls( int iterations, F call ) {
+	auto start = std::chrono::steady_clock::now();
+	for( int i=0; i<iterations; ++i ) {
+		call();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>( std::chrono::steady_clock::now() - start );
+	return elapsed.count() / iterations;
+}
+
+///
+/// Main entry point
+///
+int main( int argc, char const* argv[] ) {
+	try {
+		if( argc == 2 && std::string{argv[1]} == "--help" ) {
+			std::cerr << "usage: dispatch_benchmark.exe <iterations>" << std::endl;
+			return 0;
+		}
+		int iterations = argc > 1 ? std::atoi( argv[1] ) : default_iterations;
+
+		provider_state state{};
+		auto generate = [state]( chirp::duration_type, chirp::sample_request const& request ) mutable {
+			state.history[state.sink % state.history.size()] += 1.0f;
+			state.sink += request.buffer_size();
+		};
+
+		// Allocations when starting a stream with each kind of provider. The
+		// first stream also starts the play thread of the device, so let's
+		// get that out of the way first.
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto device = platform.default_output_device();
+		chirp::audio_format format{ 44100, chirp::sixteen_bits_little_endian_stereo };
+		{
+			auto warmup = device.create_audio_stream( format );
+			warmup.play_async( []( chirp::duration_type, chirp::sample_request const& ) {} );
+			warmup.stop();
+		}
+
+		auto function_stream = device.create_audio_stream( format );
+		auto function_allocations = allocations_while( [&]() { function_stream.play_async( generate ); } );
+		function_stream.stop();
+
+		auto provider = chirp::make_sample_provider( generate );
+		auto provider_stream = device.create_audio_stream( format );
+		auto provider_allocations = allocations_while( [&]() { provider_stream.play_async( provider ); } );
+		provider_stream.stop();
+
+		std::cout << "Allocations when starting a stream\n"
+		          << "\tstd::function:   " << function_allocations << "\n"
+		          << "\tsample_provider: " << provider_allocations << "\n";
+
+		// Cost of a call through each kind of dispatch, with a request of
+		// 256 frames. The pointers are volatile so that the compiler can't
+		// see through them, and the providers update their state so that
+		// the calls can't be optimized away.
+		std::vector<std::uint8_t> buffer( 256 * format.bytes_per_frame() );
+		chirp::sample_request request{ buffer.data(), static_cast<chirp::sample_request::byte_count>( buffer.size() ), format };
+		chirp::duration_type play_time{ 0.0f };
+
+		std::function<void(chirp::duration_type const&, chirp::sample_request const&)> function{ generate };
+		auto* volatile function_ptr = &function;
+		auto function_ns = time_calls( iterations, [&]() { (*function_ptr)( play_time, request ); } );
+
+		chirp::sample_provider* volatile provider_ptr = &provider;
+		auto provider_ns = time_calls( iterations, [&]() { provider_ptr->provide_samples( play_time, request ); } );
+
+		std::cout << "Time per call over " << iterations << " calls\n"
+		          << "\tstd::function:   " << function_ns << " ns\n"
+		          << "\tsample_provider: " << provider_ns << " ns" << std::endl;
+	}
+	catch( std::exception& e ) {
+		std::cerr << "Exception:\n"
+		          << "\tType:   " << typeid(e).name() << "\n"
+		          << "\tMessage:" << e.what() << std::endl;
+	}
+	return 0;
+}
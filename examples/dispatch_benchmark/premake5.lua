@@ -0,0 +1,26 @@
+-- The test project definition
+project "dispatch_benchmark"
+	language    "C++"
+	kind        "ConsoleApp"
+	uuid        "222ed52b-934b-4a72-840e-5eafa4871302"
+	includedirs { ".", "../../chirp/include" }
+	links       { "chirp" }
+	files {
+		"**.hpp",
+		"**.cpp"
+	}
+
+	-- Visual studio builds needs directsound library
+	filter { "action:vs*" }
+		links   { "dsound", "dxguid" }
+	filter {}
+
+	-- Debug configuration
+	filter { "debug" }
+		targetdir( "../../bin/" .. action .. "/debug/examples" )
+	filter {}
+
+	-- Release configuration
+	filter { "release" }
+		targetdir( "../../bin/" .. action .. "/release/examples" )
+	filter {}
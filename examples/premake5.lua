@@ -1,3 +1,5 @@
 -- Include example projects
 include "sinewave"
 include "devices"
+include "dispatch_benchmark"
+include "resampler_benchmark"
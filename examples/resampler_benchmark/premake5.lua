@@ -0,0 +1,26 @@
+-- The test project definition
+project "resampler_benchmark"
+	language    "C++"
+	kind        "ConsoleApp"
+	uuid        "7c1f40d9-52e3-4a8b-9d61-0b3e6a5f2c84"
+	includedirs { ".", "../../chirp/include" }
+	links       { "chirp" }
+	files {
+		"**.hpp",
+		"**.cpp"
+	}
+
+	-- Visual studio builds needs directsound library
+	filter { "action:vs*" }
+		links   { "dsound", "dxguid" }
+	filter {}
+
+	-- Debug configuration
+	filter { "debug" }
+		targetdir( "../../bin/" .. action .. "/debug/examples" )
+	filter {}
+
+	-- Release configuration
+	filter { "release" }
+		targetdir( "../../bin/" .. action .. "/release/examples" )
+	filter {}
@@ -0,0 +1,153 @@
+#include <chirp/resampler.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/// Default number of seconds of stereo samples to time, if none is
+/// specified on the command line
+const int default_seconds = 60;
+
+/// Pi
+const double pi = 3.14159265358979323846;
+
+/// A conversion between two common frequencies
+struct conversion
+{
+	/// Frequency of the input
+	double input_rate;
+	/// Frequency of the output
+	double output_rate;
+};
+
+/// Generate a sine wave at half of full scale
+/// @param frequency     Frequency of the sine wave
+/// @param sample_rate   Frequency of the samples
+/// @param frames        Number of samples
+/// @returns The samples
+std::vector<float> sine( double frequency, double sample_rate, std::size_t frames ) {
+	std::vector<float> samples( frames );
+	for( std::size_t i=0; i<frames; ++i ) {
+		samples[i] = static_cast<float>( 0.5 * std::sin( 2.0 * pi * frequency * static_cast<double>( i ) / sample_rate ) );
+	}
+	return samples;
+}
+
+/// Resample a second of a sine wave, without the ends where the filter
+/// fades in and out
+/// @returns The resampled sine wave
+std::vector<float> resample_sine( chirp::resample_quality quality, conversion const& rates, double frequency ) {
+	chirp::resampler resampler{ 1, rates.output_rate / rates.input_rate, quality };
+	auto input = sine( frequency, rates.input_rate, static_cast<std::size_t>( rates.input_rate ) );
+	std::vector<float> output( static_cast<std::size_t>( rates.output_rate ) );
+	auto result = resampler.process( input.data(), input.size(), output.data(), output.size() );
+	output.resize( result.output_frames - resampler.taps() );
+	output.erase( output.begin(), output.begin() + static_cast<std::ptrdiff_t>( resampler.taps() ) );
+	return output;
+}
+
+/// Measure the accuracy of resampling a sine wave in the pass band
+/// @returns The signal to noise ratio in decibels
+double signal_to_noise( chirp::resample_quality quality, conversion const& rates ) {
+	auto taps = chirp::resampler( 1, rates.output_rate / rates.input_rate, quality ).taps();
+	auto frequency = 1000.0;
+	auto output = resample_sine( quality, rates, frequency );
+	double signal = 0.0;
+	double noise = 0.0;
+	for( std::size_t i=0; i<output.size(); ++i ) {
+		auto expected = 0.5 * std::sin( 2.0 * pi * frequency * static_cast<double>( i + taps ) / rates.output_rate );
+		signal += expected * expected;
+		noise += (output[i] - expected) * (output[i] - expected);
+	}
+	return 10.0 * std::log10( signal / noise );
+}
+
+/// Measure the suppression of a sine wave that would alias, halfway
+/// between the Nyquist frequencies of the output and the input
+/// @returns The level of the alias in decibels
+double aliasing( chirp::resample_quality quality, conversion const& rates ) {
+	auto output = resample_sine( quality, rates, (rates.input_rate + rates.output_rate) / 4.0 );
+	double power = 0.0;
+	for( auto sample : output ) {
+		power += static_cast<double>( sample ) * sample;
+	}
+	return 10.0 * std::log10( power / static_cast<double>( output.size() ) / 0.125 );
+}
+
+/// Time the resampling of stereo samples in blocks of the size of a
+/// typical device period
+/// @returns Output frames per second
+double throughput( chirp::resample_quality quality, conversion const& rates, int seconds ) {
+	std::size_t const block = 480;
+	chirp::resampler resampler{ 2, rates.output_rate / rates.input_rate, quality };
+	std::vector<float> input( 2 * block, 0.25f );
+	std::vector<float> output( 2 * block );
+	auto total = static_cast<std::size_t>( rates.output_rate ) * static_cast<std::size_t>( seconds );
+	std::size_t done = 0;
+	auto start = std::chrono::steady_clock::now();
+	while( done < total ) {
+		auto result = resampler.process( input.data(), block, output.data(), block );
+		done += result.output_frames;
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>( std::chrono::steady_clock::now() - start );
+	return static_cast<double>( done ) / elapsed.count();
+}
+
+///
+/// Main entry point
+///
+int main( int argc, char const* argv[] ) {
+	try {
+		if( argc == 2 && std::string{argv[1]} == "--help" ) {
+			std::cerr << "usage: resampler_benchmark.exe <seconds>" << std::endl;
+			return 0;
+		}
+		int seconds = argc > 1 ? std::atoi( argv[1] ) : default_seconds;
+
+		struct tier
+		{
+			chirp::resample_quality quality;
+			char const* name;
+		};
+		tier const tiers[] = {
+			{ chirp::resample_quality::fast, "fast" },
+			{ chirp::resample_quality::balanced, "balanced" },
+			{ chirp::resample_quality::best, "best" }
+		};
+		conversion const conversions[] = {
+			{ 44100.0, 48000.0 },
+			{ 48000.0, 44100.0 },
+			{ 96000.0, 48000.0 },
+			{ 22050.0, 48000.0 }
+		};
+
+		std::cout << std::fixed << std::setprecision( 1 );
+		for( auto const& rates : conversions ) {
+			std::cout << rates.input_rate << " Hz to " << rates.output_rate << " Hz\n";
+			for( auto const& t : tiers ) {
+				auto taps = chirp::resampler( 2, rates.output_rate / rates.input_rate, t.quality ).taps();
+				auto speed = throughput( t.quality, rates, seconds );
+				std::cout << "\t" << std::setw( 8 ) << t.name
+				          << "  taps: " << std::setw( 3 ) << taps
+				          << "  SNR: " << std::setw( 6 ) << signal_to_noise( t.quality, rates ) << " dB";
+				// Only lowering the frequency can alias
+				if( rates.output_rate < rates.input_rate ) {
+					std::cout << "  aliasing: " << std::setw( 6 ) << aliasing( t.quality, rates ) << " dB";
+				}
+				std::cout << "  speed: " << std::setw( 7 ) << speed / rates.output_rate << "x real-time (stereo)\n";
+			}
+		}
+		std::cout << std::flush;
+	}
+	catch( std::exception& e ) {
+		std::cerr << "Exception:\n"
+		          << "\tType:   " << typeid(e).name() << "\n"
+		          << "\tMessage:" << e.what() << std::endl;
+	}
+	return 0;
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include <chirp/chirp.hpp>
+#include <chirp/sample_view.hpp>
 #include <thread>
 #include <iostream>
 #include <limits>
@@ -49,11 +50,14 @@ class arguments
 
 /// Generate a sample of a sinewave
 /// @param frequency   The frequency of the sinewave to generate (in hertz)
-/// @param time        The samples location on the time axis of sinewave
-std::int16_t sinewave_sample( int frequency, chirp::duration_type time )
+/// @param format      The audio format of the stream
+/// @param frame       The samples position on the timeline of the stream
+std::int16_t sinewave_sample( int frequency, chirp::audio_format const& format, std::uint64_t frame )
 {
-	auto seconds = std::chrono::duration_cast< std::chrono::duration<float> >(time).count();
-	auto value = std::sin( frequency * two_pi * seconds );
+	// Keep the phase exact by wrapping it in whole frames, so the sine
+	// doesn't lose precision however long the stream plays
+	auto phase = (frame * static_cast<std::uint64_t>(frequency)) % format.frequency();
+	auto value = std::sin( two_pi * phase / format.frequency() );
 	return static_cast<std::int16_t>( std::numeric_limits<std::int16_t>::max() * value );
 }
 
@@ -76,10 +80,10 @@ int main( int argc, char const* argv[] ) {
 
 		// Let's start playing (and generating) the audio 
 		stream.play_async(
-			[&args]( chirp::duration_type play_time, chirp::sample_request const& request ) {
-				auto* ptr = static_cast<std::int16_t*>(request.buffer_start());
-				for( std::uint32_t i=0; i<request.frames(); ++i ) {
-					*(ptr++) = sinewave_sample( args.frequency(), play_time + (i*request.format().duration_per_frame() ) );
+			[&args]( chirp::duration_type, chirp::sample_request const& request ) {
+				chirp::frames<std::int16_t, 1> frames{ request };
+				for( std::size_t i=0; i<frames.size(); ++i ) {
+					frames(i, 0) = sinewave_sample( args.frequency(), request.format(), request.frame_position() + i );
 				}
 			});
 
@@ -14,17 +14,42 @@ newoption {
 	}
 }
 
+-- New option to control if the ALSA backend should be built, which
+-- requires the ALSA development files (libasound)
+newoption {
+	trigger       = "alsa",
+	description   = "Build the ALSA backend (default: no)",
+	value         = "yes/no",
+	allowed = {
+		{ "yes",   "Build the ALSA backend" },
+		{ "no",    "Don't build the ALSA backend" }
+	}
+}
+
+-- New option to select the C++ standard. The library only needs C++14,
+-- but coroutine sample generators require C++20
+newoption {
+	trigger       = "cppdialect",
+	description   = "C++ standard to build with (default: C++14)",
+	value         = "C++14/C++20",
+	allowed = {
+		{ "C++14",   "C++14" },
+		{ "C++20",   "C++20, with coroutine sample generators" }
+	}
+}
+
 -- The test solution
 solution "chirp"
 	location             ( "build/" .. action )
 	configurations       { "debug", "release" }
 	warnings             "Extra"
 	flags                { "FatalWarnings" }
-	cppdialect           "C++14"
+	cppdialect           ( _OPTIONS["cppdialect"] or "C++14" )
 
 	-- Add some flags for gmake builds
 	if _ACTION == "gmake" then
-		buildoptions     { "-Wall" }
+		buildoptions     { "-Wall", "-pthread" }
+		linkoptions      { "-pthread" }
 	end
 
 	-- Provide a default for the "shared" option
@@ -32,6 +57,17 @@ solution "chirp"
 	   _OPTIONS["shared"] = "no"
 	end	
 
+	-- Provide a default for the "alsa" option
+	if not _OPTIONS["alsa"] then
+	   _OPTIONS["alsa"] = "no"
+	end
+
+	-- ALSA builds needs the asound library
+	filter { "options:alsa=yes" }
+		defines          { "CHIRP_WITH_ALSA" }
+		links            { "asound" }
+	filter {}
+
 	-- Since premake doesn't implement the clean command
 	-- on all platforms, we define our own
 	if action == "clean" then
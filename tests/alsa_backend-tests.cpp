@@ -0,0 +1,56 @@
+#include <catch.hpp>
+#include <chirp/static_config.hpp>
+
+#if defined(CHIRP_WITH_ALSA)
+
+#include <chirp/chirp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+SCENARIO( "the ALSA backend enumerates output devices" ) {
+	GIVEN( "an audio platform using the ALSA backend" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::alsa };
+		THEN( "the default device is one of the output devices" ) {
+			auto devices = platform.get_output_devices();
+			auto default_device = platform.default_output_device();
+			REQUIRE( std::any_of( std::begin(devices), std::end(devices),
+				[&]( auto const& device ){ return device == default_device; } ) );
+		}
+	}
+}
+
+SCENARIO( "audio streams of the ALSA null device requests samples" ) {
+	GIVEN( "the ALSA null device" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::alsa };
+		auto devices = platform.get_output_devices();
+		auto it = std::find_if( std::begin(devices), std::end(devices),
+			[]( auto const& device ){ return device.name() == "null"; } );
+		REQUIRE( it != std::end(devices) );
+		auto device = *it;
+		WHEN( "we play an audio stream through it" ) {
+			chirp::audio_format format{ 48000, chirp::sixteen_bits_little_endian_stereo };
+			auto stream = device.create_audio_stream( format );
+			std::atomic<int> requests{ 0 };
+			std::atomic<bool> whole_frames{ true };
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& request ) {
+					whole_frames = whole_frames && (request.buffer_size() % format.bytes_per_frame()) == 0;
+					++requests;
+				});
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+			while( requests == 0 && std::chrono::steady_clock::now() < deadline ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+			stream.stop();
+			THEN( "the sample provider is called with whole frames" ) {
+				REQUIRE( requests > 0 );
+				REQUIRE( whole_frames == true );
+			}
+		}
+	}
+}
+
+#endif   // defined(CHIRP_WITH_ALSA)
@@ -90,6 +90,28 @@ SCENARIO( "audio_formats can report duration per frame" ) {
 	}
 }
 
+SCENARIO( "audio formats convert between frame counts and durations exactly" ) {
+	GIVEN( "a 44100 Hz audio format" ) {
+		chirp::audio_format format{ 44100, chirp::sixteen_bits_little_endian_stereo };
+		THEN( "frame counts are converted to durations" ) {
+			REQUIRE( format.duration_of( 44100 ) == std::chrono::seconds{1} );
+			REQUIRE( format.duration_of( 441 ) == std::chrono::milliseconds{10} );
+			REQUIRE( format.duration_of( 1 ).count() == 22675 );
+		}
+		THEN( "durations are converted to frame counts" ) {
+			REQUIRE( format.frames_in( std::chrono::seconds{1} ) == 44100u );
+			REQUIRE( format.frames_in( std::chrono::milliseconds{10} ) == 441u );
+			REQUIRE( format.frames_in( std::chrono::nanoseconds{22675} ) == 0u );
+		}
+		THEN( "a year of frames is converted without overflow or drift" ) {
+			chirp::audio_format::frame_index year = 44100ull * 60 * 60 * 24 * 365;
+			REQUIRE( format.duration_of( year ) == std::chrono::hours{24 * 365} );
+			REQUIRE( format.frames_in( format.duration_of( year + 1 ) ) == year );
+			REQUIRE( format.frames_in( format.duration_of( year + 1 ) + std::chrono::nanoseconds{1} ) == year + 1 );
+		}
+	}
+}
+
 SCENARIO( "audio formats can be compared with operator ==" ) {
 	GIVEN( "two equivalent sample formats" ) {
 		chirp::audio_format format1{ 44100, chirp::sixteen_bits_little_endian_stereo };
@@ -0,0 +1,276 @@
+#include <catch.hpp>
+#include <engine/conversion_kernels.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+	/// Random float samples beyond full scale, with the special values
+	/// mixed in, and a length that leaves a tail for every vector width
+	std::vector<float> test_samples() {
+		std::mt19937 engine{ 1234 };
+		std::uniform_real_distribution<float> distribution{ -2.0f, 2.0f };
+		std::vector<float> samples( 1037 );
+		for( auto& sample : samples ) {
+			sample = distribution( engine );
+		}
+		samples[3] = std::numeric_limits<float>::quiet_NaN();
+		samples[5] = std::numeric_limits<float>::infinity();
+		samples[7] = -std::numeric_limits<float>::infinity();
+		samples[11] = 1.0f;
+		samples[13] = -1.0f;
+		samples[1036] = std::numeric_limits<float>::quiet_NaN();
+		return samples;
+	}
+
+	/// Compare float buffers bit for bit
+	bool identical( std::vector<float> const& a, std::vector<float> const& b ) {
+		return a.size() == b.size() && std::memcmp( a.data(), b.data(), a.size() * sizeof(float) ) == 0;
+	}
+}   // anonymous namespace
+
+SCENARIO( "the vector conversion kernels give the same results as the scalar kernels" ) {
+	using chirp::backend::simd_level;
+	GIVEN( "random float samples beyond full scale, with NaN and infinities" ) {
+		auto samples = test_samples();
+		auto const& scalar = chirp::backend::scalar_kernels();
+		std::vector<simd_level> levels;
+		for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+			if( level <= chirp::backend::detected_simd_level() ) {
+				levels.push_back( level );
+			}
+		}
+		WHEN( "they are converted to 16 bit samples and back" ) {
+			std::vector<std::int16_t> expected( samples.size() );
+			scalar.encode_int16( samples.data(), expected.data(), samples.size() );
+			std::vector<float> expected_floats( samples.size() );
+			scalar.decode_int16( expected.data(), expected_floats.data(), expected.size() );
+			THEN( "the kernels of each level that the CPU supports give identical samples" ) {
+				for( auto level : levels ) {
+					auto const& kernels = chirp::backend::kernels_for( level );
+					std::vector<std::int16_t> actual( samples.size() );
+					kernels.encode_int16( samples.data(), actual.data(), samples.size() );
+					std::vector<float> actual_floats( samples.size() );
+					kernels.decode_int16( expected.data(), actual_floats.data(), expected.size() );
+					REQUIRE( actual == expected );
+					REQUIRE( identical( actual_floats, expected_floats ) );
+				}
+			}
+			THEN( "NaN becomes negative full scale and infinities are clamped" ) {
+				REQUIRE( expected[3] == -32767 );
+				REQUIRE( expected[1036] == -32767 );
+				REQUIRE( expected[5] == 32767 );
+				REQUIRE( expected[7] == -32767 );
+			}
+		}
+		WHEN( "they are converted to 32 bit and 24 bit samples and back" ) {
+			THEN( "the kernels of each level that the CPU supports give identical samples" ) {
+				for( auto scale : { 2147483520.0f, 8388607.0f } ) {
+					std::vector<std::int32_t> expected( samples.size() );
+					scalar.encode_int32( samples.data(), expected.data(), samples.size(), scale );
+					std::vector<float> expected_floats( samples.size() );
+					scalar.decode_int32( expected.data(), expected_floats.data(), expected.size(), 1.0f / scale );
+					REQUIRE( expected[3] == -static_cast<std::int32_t>( scale ) );
+					REQUIRE( expected[5] == static_cast<std::int32_t>( scale ) );
+					for( auto level : levels ) {
+						auto const& kernels = chirp::backend::kernels_for( level );
+						std::vector<std::int32_t> actual( samples.size() );
+						kernels.encode_int32( samples.data(), actual.data(), samples.size(), scale );
+						std::vector<float> actual_floats( samples.size() );
+						kernels.decode_int32( expected.data(), actual_floats.data(), expected.size(), 1.0f / scale );
+						REQUIRE( actual == expected );
+						REQUIRE( identical( actual_floats, expected_floats ) );
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "the vector kernels reverse the byte order of samples in place" ) {
+	using chirp::backend::simd_level;
+	GIVEN( "a buffer of counting bytes, with a length that leaves a tail for every vector width" ) {
+		std::vector<std::uint8_t> bytes( 8 * 67 );
+		for( std::size_t i=0; i<bytes.size(); ++i ) {
+			bytes[i] = static_cast<std::uint8_t>( i );
+		}
+		auto const& scalar = chirp::backend::scalar_kernels();
+		std::vector<simd_level> levels;
+		for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+			if( level <= chirp::backend::detected_simd_level() ) {
+				levels.push_back( level );
+			}
+		}
+		WHEN( "it is swapped as 2, 4 and 8 byte samples by the scalar kernels" ) {
+			auto swapped16 = bytes;
+			scalar.swap16( swapped16.data(), bytes.size() / 2 );
+			auto swapped32 = bytes;
+			scalar.swap32( swapped32.data(), bytes.size() / 4 );
+			auto swapped64 = bytes;
+			scalar.swap64( swapped64.data(), bytes.size() / 8 );
+			THEN( "the bytes of each sample are reversed" ) {
+				REQUIRE( swapped16[0] == 1 );
+				REQUIRE( swapped16[1] == 0 );
+				REQUIRE( swapped32[4] == 7 );
+				REQUIRE( swapped32[7] == 4 );
+				REQUIRE( swapped64[8] == 15 );
+				REQUIRE( swapped64[15] == 8 );
+			}
+			THEN( "the kernels of each level that the CPU supports give identical bytes" ) {
+				for( auto level : levels ) {
+					auto const& kernels = chirp::backend::kernels_for( level );
+					auto actual16 = bytes;
+					kernels.swap16( actual16.data(), bytes.size() / 2 );
+					auto actual32 = bytes;
+					kernels.swap32( actual32.data(), bytes.size() / 4 );
+					auto actual64 = bytes;
+					kernels.swap64( actual64.data(), bytes.size() / 8 );
+					REQUIRE( actual16 == swapped16 );
+					REQUIRE( actual32 == swapped32 );
+					REQUIRE( actual64 == swapped64 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "the vector kernels filter samples with interpolated coefficients" ) {
+	using chirp::backend::simd_level;
+	GIVEN( "random samples and two phases of coefficients, with a length that leaves a tail for every vector width" ) {
+		std::mt19937 engine{ 4321 };
+		std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+		std::vector<float> samples( 83 ), phase( 83 ), next_phase( 83 );
+		for( std::size_t i=0; i<samples.size(); ++i ) {
+			samples[i] = distribution( engine );
+			phase[i] = distribution( engine ) / 16.0f;
+			next_phase[i] = distribution( engine ) / 16.0f;
+		}
+		auto const& scalar = chirp::backend::scalar_kernels();
+		WHEN( "they are filtered by the scalar kernel" ) {
+			auto sum = scalar.fir( samples.data(), phase.data(), next_phase.data(), 0.25f, samples.size() );
+			THEN( "the coefficients are interpolated between the phases" ) {
+				double expected = 0.0;
+				for( std::size_t i=0; i<samples.size(); ++i ) {
+					expected += samples[i] * (0.75 * phase[i] + 0.25 * next_phase[i]);
+				}
+				REQUIRE( sum == Approx( expected ).margin( 1e-5 ) );
+			}
+			THEN( "the kernels of each level that the CPU supports give the same sum, up to rounding" ) {
+				for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+					if( level <= chirp::backend::detected_simd_level() ) {
+						auto const& kernels = chirp::backend::kernels_for( level );
+						REQUIRE( kernels.fir( samples.data(), phase.data(), next_phase.data(), 0.25f, samples.size() ) == Approx( sum ).margin( 1e-5 ) );
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "the vector kernels add up and clip the samples of a mix" ) {
+	using chirp::backend::simd_level;
+	GIVEN( "random float samples beyond full scale, with NaN and infinities" ) {
+		auto samples = test_samples();
+		std::vector<float> mix( samples.size() );
+		for( std::size_t i=0; i<mix.size(); ++i ) {
+			mix[i] = static_cast<float>( i % 7 ) * 0.125f - 0.375f;
+		}
+		auto const& scalar = chirp::backend::scalar_kernels();
+		WHEN( "they are added to a mix and clipped by the scalar kernels" ) {
+			auto expected = mix;
+			scalar.mix( samples.data(), expected.data(), samples.size() );
+			scalar.clip( expected.data(), expected.size() );
+			THEN( "the sums are clamped to full scale, and NaN becomes negative full scale" ) {
+				REQUIRE( expected[3] == -1.0f );
+				REQUIRE( expected[5] == 1.0f );
+				REQUIRE( expected[7] == -1.0f );
+				for( auto sample : expected ) {
+					REQUIRE( sample >= -1.0f );
+					REQUIRE( sample <= 1.0f );
+				}
+			}
+			THEN( "the kernels of each level that the CPU supports give identical samples" ) {
+				for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+					if( level <= chirp::backend::detected_simd_level() ) {
+						auto const& kernels = chirp::backend::kernels_for( level );
+						auto actual = mix;
+						kernels.mix( samples.data(), actual.data(), samples.size() );
+						kernels.clip( actual.data(), actual.size() );
+						REQUIRE( identical( actual, expected ) );
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "the vector kernels read voices at a pitch and pan them" ) {
+	using chirp::backend::simd_level;
+	GIVEN( "random samples, and a length of frames that leaves a tail for every vector width" ) {
+		std::mt19937 engine{ 5678 };
+		std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+		std::vector<float> samples( 400 );
+		for( auto& sample : samples ) {
+			sample = distribution( engine );
+		}
+		std::size_t const frames = 93;
+		auto const& scalar = chirp::backend::scalar_kernels();
+		WHEN( "they are read at a fractional pitch by the scalar kernel" ) {
+			std::vector<float> expected( frames );
+			scalar.interpolate( samples.data(), expected.data(), frames, 0.25f, 1.75f, 0.5f );
+			THEN( "each frame is interpolated between its neighbouring samples" ) {
+				for( std::size_t i=0; i<frames; ++i ) {
+					auto position = 0.25 + 1.75 * static_cast<double>( i );
+					auto index = static_cast<std::size_t>( position );
+					auto fraction = position - static_cast<double>( index );
+					auto sample = samples[index] + fraction * (samples[index + 1] - samples[index]);
+					REQUIRE( expected[i] == Approx( 0.5 * sample ).margin( 1e-5 ) );
+				}
+			}
+			THEN( "the kernels of each level that the CPU supports give the same samples, up to rounding" ) {
+				for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+					if( level <= chirp::backend::detected_simd_level() ) {
+						auto const& kernels = chirp::backend::kernels_for( level );
+						std::vector<float> actual( frames );
+						kernels.interpolate( samples.data(), actual.data(), frames, 0.25f, 1.75f, 0.5f );
+						for( std::size_t i=0; i<frames; ++i ) {
+							REQUIRE( actual[i] == Approx( expected[i] ).margin( 1e-5 ) );
+						}
+					}
+				}
+			}
+		}
+		WHEN( "they are panned into stereo samples by the scalar kernel" ) {
+			std::vector<float> expected( frames * 2, 0.125f );
+			scalar.pan( samples.data(), expected.data(), frames, 0.75f, -0.5f );
+			THEN( "each channel gets the samples at its gain" ) {
+				REQUIRE( expected[0] == 0.125f + samples[0] * 0.75f );
+				REQUIRE( expected[185] == 0.125f + samples[92] * -0.5f );
+			}
+			THEN( "the kernels of each level that the CPU supports give the same samples, up to rounding" ) {
+				for( auto level : { simd_level::sse2, simd_level::avx2, simd_level::avx512 } ) {
+					if( level <= chirp::backend::detected_simd_level() ) {
+						auto const& kernels = chirp::backend::kernels_for( level );
+						std::vector<float> actual( frames * 2, 0.125f );
+						kernels.pan( samples.data(), actual.data(), frames, 0.75f, -0.5f );
+						for( std::size_t i=0; i<actual.size(); ++i ) {
+							REQUIRE( actual[i] == Approx( expected[i] ).margin( 1e-6 ) );
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "the scalar kernels are used where no vector kernels are available" ) {
+	GIVEN( "the scalar level" ) {
+		THEN( "its kernels are the scalar kernels" ) {
+			REQUIRE( &chirp::backend::kernels_for( chirp::backend::simd_level::scalar ) == &chirp::backend::scalar_kernels() );
+		}
+	}
+}
@@ -0,0 +1,221 @@
+#include <catch.hpp>
+#include <chirp/chirp.hpp>
+#include <chirp/backend_factory.hpp>
+#include <chirp/sample_view.hpp>
+#include <file_render/file_render_backend.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// Read an entire file into memory
+	std::vector<std::uint8_t> read_file( char const* path ) {
+		std::ifstream file{ path, std::ios::binary };
+		return std::vector<std::uint8_t>{ std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{} };
+	}
+
+	/// Read a little endian 32 bit integer
+	std::uint32_t read_uint32( std::vector<std::uint8_t> const& data, std::size_t offset ) {
+		return data[offset] | (data[offset+1] << 8) | (data[offset+2] << 16) | (static_cast<std::uint32_t>(data[offset+3]) << 24);
+	}
+
+	/// Wait for a stream to finish playing
+	void wait_until_finished( chirp::audio_stream const& stream ) {
+		while( stream.is_playing() ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+		}
+	}
+}   // anonymous namespace
+
+SCENARIO( "the file render backend renders audio streams into wave files" ) {
+	GIVEN( "a file render platform that renders ten minutes of audio per stream" ) {
+		char const* path = "chirp_file_render_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path, std::chrono::minutes{10} ) };
+		WHEN( "we render an audio stream" ) {
+			chirp::audio_format format{ 8000, chirp::sixteen_bits_big_endian_mono };
+			auto stream = platform.default_output_device().create_audio_stream( format );
+			std::uint16_t counter = 0;
+			auto start = std::chrono::steady_clock::now();
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& request ) {
+					auto* ptr = static_cast<std::uint8_t*>(request.buffer_start());
+					for( std::uint32_t i=0; i<request.frames(); ++i, ++counter ) {
+						*(ptr++) = static_cast<std::uint8_t>(counter >> 8);
+						*(ptr++) = static_cast<std::uint8_t>(counter & 0xff);
+					}
+				});
+			wait_until_finished( stream );
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			auto data = read_file( path );
+
+			THEN( "it is rendered faster than real time" ) {
+				REQUIRE( elapsed < std::chrono::minutes{1} );
+			}
+			AND_THEN( "the file has a wave header with the audio format" ) {
+				REQUIRE( data.size() == 44 + 10*60*8000*2 );
+				REQUIRE( std::string( data.begin(), data.begin()+4 ) == "RIFF" );
+				REQUIRE( read_uint32( data, 4 ) == data.size() - 8 );
+				REQUIRE( std::string( data.begin()+8, data.begin()+16 ) == "WAVEfmt " );
+				REQUIRE( read_uint32( data, 24 ) == 8000 );
+				REQUIRE( read_uint32( data, 40 ) == data.size() - 44 );
+			}
+			AND_THEN( "the samples are stored in little endian byte order" ) {
+				REQUIRE( data[44+2*1000] == (1000 & 0xff) );
+				REQUIRE( data[44+2*1000+1] == (1000 >> 8) );
+			}
+			AND_THEN( "the stream can't be played again" ) {
+				REQUIRE_THROWS_AS( stream.play_async( []( chirp::duration_type, chirp::sample_request const& ){} ), chirp::backend_exception );
+			}
+		}
+		std::remove( path );
+	}
+}
+
+SCENARIO( "file render streams without a length render until they are stopped" ) {
+	GIVEN( "a file render platform without a render length" ) {
+		char const* path = "chirp_file_render_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path ) };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		WHEN( "the stream is stopped by its sample provider" ) {
+			std::uint32_t frames = 0;
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& request ) {
+					frames += request.frames();
+					if( frames >= 8000 ) {
+						stream.stop();
+					}
+				});
+			wait_until_finished( stream );
+			THEN( "the file contains everything that was rendered" ) {
+				REQUIRE( read_file( path ).size() == 44 + frames );
+			}
+		}
+		std::remove( path );
+	}
+}
+
+SCENARIO( "file render streams never underrun" ) {
+	GIVEN( "a file render platform that renders a second of audio per stream" ) {
+		char const* path = "chirp_file_render_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path, std::chrono::seconds{1} ) };
+		auto stream = platform.default_output_device().create_audio_stream( { 48000, chirp::float32_stereo } );
+		WHEN( "a stream with an underrun handler is rendered" ) {
+			std::uint32_t notified = 0;
+			stream.on_underrun( [&]( chirp::stream_statistics const& ) { ++notified; } );
+			stream.play_async( []( chirp::duration_type, chirp::sample_request const& ) {} );
+			wait_until_finished( stream );
+			THEN( "no underruns are counted or reported" ) {
+				REQUIRE( stream.statistics().underruns == 0 );
+				REQUIRE( stream.statistics().late_callbacks == 0 );
+				REQUIRE( notified == 0 );
+				REQUIRE( read_file( path ).size() == 44 + 48000 * 8 );
+			}
+		}
+		std::remove( path );
+	}
+}
+
+SCENARIO( "file render streams in push mode end writes when the render is finished" ) {
+	GIVEN( "a file render platform that renders 10 ms of audio per stream" ) {
+		char const* path = "chirp_file_render_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path, std::chrono::milliseconds{10} ) };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		WHEN( "more samples are written than are rendered" ) {
+			std::vector<std::uint8_t> samples( 8000, 1 );
+			stream.play_push_async( 400 );
+			auto written = stream.write( samples.data(), samples.size() );
+			THEN( "the write returns once the render is finished" ) {
+				REQUIRE( written < samples.size() );
+				REQUIRE_FALSE( stream.is_playing() );
+			}
+		}
+		std::remove( path );
+	}
+}
+
+SCENARIO( "wave files stop growing once their header can't tell their size" ) {
+	GIVEN( "a wave file of 16 bit mono samples that may hold 10 bytes" ) {
+		char const* path = "chirp_file_render_test.wav";
+		std::vector<std::uint8_t> samples( 8, 1 );
+		{
+			chirp::backend::wave_file_writer writer{ path, { 8000, chirp::sixteen_bits_little_endian_mono }, 11 };
+			WHEN( "more samples are written than it may hold" ) {
+				auto first = writer.write( samples.data(), 8 );
+				auto second = writer.write( samples.data(), 8 );
+				auto third = writer.write( samples.data(), 8 );
+				writer.close();
+				THEN( "the whole frames that fit are written, and the rest is refused" ) {
+					REQUIRE( first );
+					REQUIRE_FALSE( second );
+					REQUIRE_FALSE( third );
+					auto data = read_file( path );
+					REQUIRE( data.size() == 44 + 10 );
+					REQUIRE( read_uint32( data, 4 ) == 36 + 10 );
+					REQUIRE( read_uint32( data, 40 ) == 10 );
+				}
+			}
+		}
+		std::remove( path );
+	}
+	GIVEN( "the largest wave file" ) {
+		THEN( "its sizes fit into the 32 bits of the header" ) {
+			REQUIRE( chirp::backend::wave_file_writer::maximum_data_bytes + 36 == 0xffffffffu );
+		}
+	}
+}
+
+SCENARIO( "additional file render streams get numbered files" ) {
+	GIVEN( "a file render platform" ) {
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( "chirp_file_render_test.wav", std::chrono::milliseconds{10} ) };
+		auto device = platform.default_output_device();
+		WHEN( "we create two audio streams" ) {
+			{
+				auto first = device.create_audio_stream( { 8000, chirp::eight_bits_mono } );
+				auto second = device.create_audio_stream( { 8000, chirp::eight_bits_mono } );
+			}
+			THEN( "the second stream renders to a numbered file" ) {
+				REQUIRE( read_file( "chirp_file_render_test.wav" ).size() == 44 );
+				REQUIRE( read_file( "chirp_file_render_test-1.wav" ).size() == 44 );
+			}
+			std::remove( "chirp_file_render_test.wav" );
+			std::remove( "chirp_file_render_test-1.wav" );
+		}
+	}
+}
+
+SCENARIO( "the file render backend negotiates sample formats that wave files can hold" ) {
+	GIVEN( "a file render platform" ) {
+		char const* path = "chirp_file_render_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path, std::chrono::milliseconds{10} ) };
+		auto device = platform.default_output_device();
+		chirp::audio_format padded{ 8000, chirp::twenty_four_in_thirty_two_bits_little_endian_stereo };
+		chirp::audio_format floating{ 8000, chirp::float32_stereo };
+		THEN( "padded samples aren't supported, and streams of them can't be created" ) {
+			REQUIRE( device.supports( padded ) == false );
+			REQUIRE_THROWS_AS( device.create_audio_stream( padded ), chirp::sample_format_exception );
+			REQUIRE_THROWS_AS( device.negotiate( { padded } ), chirp::sample_format_exception );
+		}
+		WHEN( "a stream is rendered with the first supported of padded and floating point samples" ) {
+			auto stream = device.create_audio_stream( device.negotiate( { padded, floating } ) );
+			stream.play_async(
+				[]( chirp::duration_type, chirp::sample_request const& request ) {
+					chirp::frames<float, 2> view{ request };
+					std::fill( view.data(), view.data() + view.samples(), 0.5f );
+				});
+			wait_until_finished( stream );
+			auto data = read_file( path );
+			THEN( "the file holds floating point samples" ) {
+				REQUIRE( (data[20] | (data[21] << 8)) == 3 );
+				REQUIRE( (data[34] | (data[35] << 8)) == 32 );
+				REQUIRE( data.size() == 44 + 80*8 );
+			}
+		}
+		std::remove( path );
+	}
+}
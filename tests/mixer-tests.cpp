@@ -0,0 +1,269 @@
+#include <catch.hpp>
+#include <chirp/chirp.hpp>
+#include <chirp/backend_factory.hpp>
+#include <chirp/mixer.hpp>
+#include <engine/mixer_engine.hpp>
+#include <null/null_backend.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// Sample provider that fills every sample with the same value
+	/// @tparam T   The sample type
+	template <class T>
+	class constant_provider :
+		public chirp::sample_provider
+	{
+		public:
+			/// Create the provider
+			/// @param value   The value of every sample
+			explicit constant_provider( T value ) :
+				_value( value )
+			{}
+
+			/// Fill the request with the value
+			void provide_samples( chirp::duration_type const&, chirp::sample_request const& request ) override {
+				auto* samples = static_cast<T*>( request.buffer_start() );
+				auto count = request.frames() * request.format().channels();
+				for( std::size_t i=0; i<count; ++i ) {
+					samples[i] = _value;
+				}
+				times.push_back( request.presentation_time() );
+			}
+
+			/// The presentation time of each request
+			std::vector<chirp::sample_request::time_point> times;
+
+		private:
+			/// The value of every sample
+			T _value;
+	};
+
+	/// Mix a number of frames
+	std::vector<float> mix( chirp::backend::mixer_engine& engine, std::size_t frames, chirp::sample_request::time_point presentation = {} ) {
+		std::vector<float> samples( frames * engine.format().channels(), 1234.0f );
+		chirp::sample_request request{ samples.data(), static_cast<chirp::sample_request::byte_count>( samples.size() * sizeof(float) ), engine.format(), 0, presentation };
+		engine.provide_samples( chirp::duration_type{ 0.0f }, request );
+		return samples;
+	}
+}   // anonymous namespace
+
+SCENARIO( "the mixer adds up the streams that play" ) {
+	GIVEN( "a stereo mixer at 8000 Hz with a float stream and a 16 bit stream" ) {
+		auto engine = std::make_shared<chirp::backend::mixer_engine>( 8000, 2 );
+		chirp::backend::mixer_stream floats{ engine, { 8000, chirp::float32_stereo }, chirp::stream_options{} };
+		chirp::backend::mixer_stream integers{ engine, { 8000, { 16, chirp::native_byte_order, 2 } }, chirp::stream_options{} };
+		constant_provider<float> float_provider{ 0.25f };
+		constant_provider<std::int16_t> integer_provider{ 16384 };
+		REQUIRE( engine->format().sample_format() == chirp::float32_stereo );
+		WHEN( "nothing plays" ) {
+			auto samples = mix( *engine, 100 );
+			THEN( "the mix is silent" ) {
+				REQUIRE( engine->playing_streams() == 0 );
+				for( auto sample : samples ) {
+					REQUIRE( sample == 0.0f );
+				}
+			}
+		}
+		WHEN( "both streams play, over more frames than are mixed at a time" ) {
+			floats.play_async( float_provider );
+			integers.play_async( integer_provider );
+			auto now = std::chrono::steady_clock::now();
+			auto samples = mix( *engine, 3000, now );
+			THEN( "the mix is the sum of the streams" ) {
+				REQUIRE( engine->playing_streams() == 2 );
+				for( auto sample : samples ) {
+					REQUIRE( sample == Approx( 0.25f + 16384.0f / 32767.0f ) );
+				}
+			}
+			THEN( "each block of a stream is presented when its first frame is played" ) {
+				REQUIRE( float_provider.times.size() == 3 );
+				REQUIRE( float_provider.times[0] == now );
+				REQUIRE( float_provider.times[1] == now + engine->format().duration_of( 1024 ) );
+			}
+			THEN( "each stream keeps its own callback timing" ) {
+				REQUIRE( floats.callback_timing().callbacks == 3 );
+				REQUIRE( integers.callback_timing().callbacks == 3 );
+			}
+			AND_WHEN( "a stream is stopped" ) {
+				integers.stop();
+				auto next = mix( *engine, 100 );
+				THEN( "it is left out of the mix" ) {
+					REQUIRE( engine->playing_streams() == 1 );
+					for( auto sample : next ) {
+						REQUIRE( sample == 0.25f );
+					}
+				}
+			}
+		}
+		WHEN( "the streams add up to more than full scale" ) {
+			chirp::backend::mixer_stream loud{ engine, { 8000, chirp::float32_stereo }, chirp::stream_options{} };
+			constant_provider<float> loud_provider{ -2.0f };
+			floats.play_async( float_provider );
+			integers.play_async( integer_provider );
+			auto samples = mix( *engine, 100 );
+			loud.play_async( loud_provider );
+			auto clipped = mix( *engine, 100 );
+			THEN( "the mix is clipped" ) {
+				for( std::size_t i=0; i<samples.size(); ++i ) {
+					REQUIRE( samples[i] == Approx( 0.25f + 16384.0f / 32767.0f ) );
+					REQUIRE( clipped[i] == -1.0f );
+				}
+			}
+		}
+		WHEN( "a stream is stopped while another thread mixes it" ) {
+			std::atomic<bool> providing{ false };
+			std::atomic<bool> returned{ false };
+			floats.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) {
+				providing = true;
+				std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+				returned = true;
+			});
+			std::thread player{ [&]() { mix( *engine, 100 ); } };
+			while( !providing ) {
+				std::this_thread::yield();
+			}
+			floats.stop();
+			auto stopped_after_return = returned.load();
+			player.join();
+			THEN( "the stop waits until the sample provider has returned" ) {
+				REQUIRE( stopped_after_return );
+			}
+		}
+		WHEN( "a stream with a budget handler takes longer than a fraction of its budget" ) {
+			std::vector<float> loads;
+			floats.set_budget_handler( 0.001f, [&]( chirp::budget_event const& event ) { loads.push_back( event.load() ); } );
+			floats.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			});
+			mix( *engine, 100 );
+			THEN( "the handler is called" ) {
+				REQUIRE( loads.size() == 1 );
+				REQUIRE( loads[0] > 0.001f );
+			}
+		}
+		WHEN( "a stream with another number of channels is created" ) {
+			THEN( "it is rejected" ) {
+				REQUIRE_THROWS_AS( chirp::backend::mixer_stream( engine, { 8000, chirp::float32_mono }, chirp::stream_options{} ), chirp::sample_format_exception );
+				REQUIRE_THROWS_AS( chirp::backend::mixer_stream( engine, { 8000, chirp::sixteen_bits_little_endian_mono }, chirp::stream_options{} ), chirp::sample_format_exception );
+			}
+		}
+	}
+	GIVEN( "a mono mixer at 8000 Hz with a stream at 16000 Hz" ) {
+		auto engine = std::make_shared<chirp::backend::mixer_engine>( 8000, 1 );
+		chirp::backend::mixer_stream stream{ engine, { 16000, chirp::float32_mono }, chirp::stream_options{} };
+		constant_provider<float> provider{ 0.5f };
+		stream.play_async( provider );
+		WHEN( "it is mixed" ) {
+			auto samples = mix( *engine, 2000 );
+			THEN( "it is resampled to the frequency of the mix" ) {
+				for( std::size_t i=100; i<samples.size(); ++i ) {
+					REQUIRE( samples[i] == Approx( 0.5f ).margin( 0.001f ) );
+				}
+			}
+		}
+	}
+	GIVEN( "a mixer with hundreds of quiet streams" ) {
+		auto engine = std::make_shared<chirp::backend::mixer_engine>( 48000, 2 );
+		std::vector<std::unique_ptr<chirp::backend::mixer_stream>> streams;
+		constant_provider<float> provider{ 0.001f };
+		for( int i=0; i<300; ++i ) {
+			streams.push_back( std::make_unique<chirp::backend::mixer_stream>( engine, chirp::audio_format{ 48000, chirp::float32_stereo }, chirp::stream_options{} ) );
+			streams.back()->play_async( provider );
+		}
+		WHEN( "they are mixed" ) {
+			auto samples = mix( *engine, 480 );
+			THEN( "the mix is their sum" ) {
+				REQUIRE( engine->playing_streams() == 300 );
+				REQUIRE( samples[0] == Approx( 0.3f ).margin( 1e-4f ) );
+				REQUIRE( samples[959] == Approx( 0.3f ).margin( 1e-4f ) );
+			}
+			AND_WHEN( "the streams are destroyed" ) {
+				streams.clear();
+				THEN( "they are removed from the mixer" ) {
+					REQUIRE( engine->playing_streams() == 0 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "mixed streams are notified when the device stream underruns" ) {
+	GIVEN( "a mixer on a low latency stream of a null device, with a stream that has an underrun handler" ) {
+		chirp::backend::null_output_device device{ "null" };
+		auto engine = std::make_shared<chirp::backend::mixer_engine>( 8000, 1 );
+		engine->set_device_stream( chirp::audio_stream{ engine->format(), std::make_shared<chirp::backend::null_audio_stream>( device, engine->format(), chirp::latency_profile::ultra_low ) } );
+		chirp::backend::mixer_stream stream{ engine, { 8000, chirp::float32_mono }, chirp::stream_options{} };
+		std::atomic<std::uint64_t> notified{ 0 };
+		stream.set_underrun_handler( [&]( chirp::stream_statistics const& statistics ) { notified = statistics.underruns; } );
+		WHEN( "the provider of the stream takes much longer than the device buffer the first time" ) {
+			std::atomic<bool> slept{ false };
+			stream.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) {
+				if( !slept.exchange( true ) ) {
+					std::this_thread::sleep_for( std::chrono::milliseconds{50} );
+				}
+			});
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+			while( notified == 0 && std::chrono::steady_clock::now() < deadline ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+			stream.stop();
+			THEN( "the handler of the stream is notified" ) {
+				REQUIRE( notified > 0u );
+			}
+		}
+	}
+}
+
+SCENARIO( "mixers play their streams through one stream of an output device" ) {
+	GIVEN( "a mixer on a file render device that renders a second" ) {
+		char const* path = "chirp_mixer_test.wav";
+		chirp::audio_platform platform{ chirp::backend::factory{}.create_file_render_platform( path, std::chrono::seconds{1} ) };
+		auto device = platform.default_output_device();
+		chirp::mixer mixer{ device, 8000, 1 };
+		auto stream = mixer.create_audio_stream( { 8000, chirp::sixteen_bits_little_endian_mono } );
+		WHEN( "no stream has played" ) {
+			THEN( "the device stream doesn't play" ) {
+				REQUIRE_FALSE( mixer.device_stream().is_playing() );
+				REQUIRE( mixer.format().sample_format() == chirp::float32_mono );
+			}
+		}
+		WHEN( "a 16 bit stream is played until the device stream has rendered the file" ) {
+			stream.play_async( []( chirp::duration_type, chirp::sample_request const& request ) {
+				auto* samples = static_cast<std::int16_t*>( request.buffer_start() );
+				for( std::size_t i=0; i<request.frames(); ++i ) {
+					samples[i] = -16384;
+				}
+			});
+			while( mixer.device_stream().is_playing() ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+			std::ifstream file{ path, std::ios::binary };
+			std::vector<char> data{ std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{} };
+			THEN( "the stream shares the configuration of the device stream" ) {
+				REQUIRE( stream.is_playing() );
+				REQUIRE( mixer.playing_streams() == 1 );
+				REQUIRE( stream.configuration().frequency == 8000 );
+				REQUIRE( stream.configuration().buffer_frames == mixer.device_stream().configuration().buffer_frames );
+			}
+			THEN( "the file holds the float samples of the mix" ) {
+				REQUIRE( data.size() == 44 + 8000 * sizeof(float) );
+				float sample = 0.0f;
+				std::memcpy( &sample, data.data() + 44 + 100 * sizeof(float), sizeof(float) );
+				REQUIRE( sample == Approx( -16384.0f / 32767.0f ) );
+			}
+			stream.stop();
+		}
+		std::remove( path );
+	}
+}
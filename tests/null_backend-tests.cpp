@@ -0,0 +1,419 @@
+#include <catch.hpp>
+#include <chirp/chirp.hpp>
+#include <chirp/backend_factory.hpp>
+#include <null/null_backend.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// Clock for the simulated device of a null stream, which only moves
+	/// when it is advanced
+	class simulated_clock
+	{
+		public:
+			/// Clock type of the null backend
+			using clock_type = chirp::backend::null_audio_stream::clock_type;
+
+			/// @returns The current time
+			clock_type::time_point now() const {
+				return _start + std::chrono::nanoseconds{ _elapsed.load() };
+			}
+
+			/// @returns The time when the clock was created
+			clock_type::time_point start() const {
+				return _start;
+			}
+
+			/// Move the clock forward
+			/// @param duration   The duration
+			void advance( std::chrono::nanoseconds duration ) {
+				_elapsed += duration.count();
+			}
+
+		private:
+			/// The time when the clock was created
+			clock_type::time_point _start = clock_type::now();
+			/// The time that the clock has been advanced by
+			std::atomic<std::int64_t> _elapsed{ 0 };
+	};
+
+	/// Wait for the play thread to make a condition true. Only gives up
+	/// after a long time, so that a loaded machine doesn't fail the test.
+	/// @param condition   The condition
+	/// @returns `true` if the condition became true
+	template <class F>
+	bool eventually( F condition ) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+		while( !condition() ) {
+			if( std::chrono::steady_clock::now() > deadline ) {
+				return false;
+			}
+			std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+		}
+		return true;
+	}
+
+	/// Create a stream of the null backend that plays by a simulated clock
+	chirp::audio_stream simulated_stream( chirp::backend::null_output_device& device, chirp::audio_format const& format, chirp::stream_options const& options, simulated_clock& clock ) {
+		return chirp::audio_stream{ format, std::make_shared<chirp::backend::null_audio_stream>( device, format, options, [&clock]() { return clock.now(); } ) };
+	}
+}   // anonymous namespace
+
+SCENARIO( "the null backend can be created" ) {
+	GIVEN( "an audio platform using the null backend" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		THEN( "it has exactly one output device" ) {
+			REQUIRE( platform.get_output_devices().size() == 1 );
+		}
+		AND_THEN( "the only device is the default output device" ) {
+			auto devices = platform.get_output_devices();
+			REQUIRE( (*devices.begin() == platform.default_output_device()) == true );
+		}
+	}
+}
+
+SCENARIO( "the null backend is the default backend when no other backend is available" ) {
+#if !defined(CHIRP_WITH_DIRECTSOUND)
+	REQUIRE( chirp::backend::default_backend() == chirp::backend_identity::null );
+#endif
+}
+
+SCENARIO( "audio streams of the null backend requests samples" ) {
+	GIVEN( "an audio stream created from the null output device" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto device = platform.default_output_device();
+		chirp::audio_format format{ 44100, chirp::sixteen_bits_little_endian_stereo };
+		auto stream = device.create_audio_stream( format );
+		THEN( "it is not playing" ) {
+			REQUIRE( stream.is_playing() == false );
+		}
+		WHEN( "we start playing the stream" ) {
+			std::atomic<int> requests{ 0 };
+			std::atomic<bool> format_matches{ true };
+			std::atomic<bool> whole_frames{ true };
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& request ) {
+					format_matches = format_matches && request.format() == format;
+					whole_frames = whole_frames && (request.buffer_size() % format.bytes_per_frame()) == 0;
+					++requests;
+				});
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+			while( requests == 0 && std::chrono::steady_clock::now() < deadline ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+			THEN( "the stream is playing and the sample provider is called" ) {
+				REQUIRE( stream.is_playing() == true );
+				REQUIRE( requests > 0 );
+				REQUIRE( format_matches == true );
+				REQUIRE( whole_frames == true );
+			}
+			AND_WHEN( "we stop the stream" ) {
+				stream.stop();
+				THEN( "it is no longer playing, and no more samples are requested" ) {
+					REQUIRE( stream.is_playing() == false );
+					int count = requests;
+					std::this_thread::sleep_for( std::chrono::milliseconds{30} );
+					REQUIRE( requests == count );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend are paced by the clock of the simulated device" ) {
+	GIVEN( "an audio stream of the null backend with a simulated clock, and 100 ms write-ahead" ) {
+		chirp::backend::null_output_device device{ "null" };
+		simulated_clock clock;
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		auto stream = simulated_stream( device, format, chirp::stream_options{}, clock );
+		std::atomic<std::uint32_t> frames{ 0 };
+		WHEN( "it plays while the clock stands still" ) {
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& request ) {
+					frames += request.frames();
+				});
+			REQUIRE( eventually( [&]() { return frames > 0u; } ) );
+			std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+			THEN( "only the write-ahead is requested" ) {
+				REQUIRE( stream.configuration().write_ahead_frames == 800u );
+				REQUIRE( frames == 800u );
+			}
+			AND_WHEN( "the clock is advanced by a quarter of a second" ) {
+				for( std::uint32_t i=1; i<=5; ++i ) {
+					clock.advance( std::chrono::milliseconds{50} );
+					device.play_thread().notify();
+					REQUIRE( eventually( [&]() { return frames >= 800u + i * 400u; } ) );
+				}
+				std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+				THEN( "the frames that were played are refilled, and no more" ) {
+					REQUIRE( frames == 2800u );
+					REQUIRE( stream.statistics().underruns == 0u );
+				}
+			}
+			stream.stop();
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend use the requested buffer configuration" ) {
+	GIVEN( "the null output device" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto device = platform.default_output_device();
+		chirp::audio_format format{ 48000, chirp::sixteen_bits_little_endian_stereo };
+		WHEN( "a stream is created with the ultra low latency profile" ) {
+			auto stream = device.create_audio_stream( format, chirp::latency_profile::ultra_low );
+			THEN( "the stream reports a latency suitable for interactive audio" ) {
+				auto configuration = stream.configuration();
+				REQUIRE( configuration.frequency == 48000u );
+				REQUIRE( configuration.latency() <= std::chrono::milliseconds{20} );
+				REQUIRE( configuration.period() < configuration.latency() );
+			}
+		}
+		WHEN( "a stream is created with explicit buffer sizes" ) {
+			auto options = chirp::stream_options{ chirp::latency_profile::low }
+				.with_buffer_duration( std::chrono::milliseconds{250} )
+				.with_period( std::chrono::milliseconds{4} )
+				.with_write_ahead( std::chrono::milliseconds{12} );
+			auto stream = device.create_audio_stream( format, options );
+			THEN( "the sizes are used as requested" ) {
+				auto configuration = stream.configuration();
+				REQUIRE( configuration.buffer_frames == 12000u );
+				REQUIRE( configuration.period_frames == 192u );
+				REQUIRE( configuration.write_ahead_frames == 576u );
+				REQUIRE( configuration.latency() == std::chrono::milliseconds{12} );
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend count underruns" ) {
+	GIVEN( "a low latency audio stream of the null backend with a simulated clock" ) {
+		chirp::backend::null_output_device device{ "null" };
+		simulated_clock clock;
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		auto stream = simulated_stream( device, format, chirp::latency_profile::ultra_low, clock );
+		std::atomic<std::uint64_t> notified{ 0 };
+		stream.on_underrun( [&]( chirp::stream_statistics const& statistics ) { notified = statistics.underruns; } );
+		THEN( "there are no underruns before it is played" ) {
+			REQUIRE( stream.statistics().underruns == 0u );
+			REQUIRE( stream.statistics().silence_frames == 0u );
+		}
+		WHEN( "the simulated device plays 20 ms past the 8 ms that were written ahead" ) {
+			std::atomic<int> requests{ 0 };
+			stream.play_async(
+				[&]( chirp::duration_type, chirp::sample_request const& ) {
+					++requests;
+				});
+			REQUIRE( eventually( [&]() { return requests > 0; } ) );
+			clock.advance( std::chrono::milliseconds{28} );
+			device.play_thread().notify();
+			REQUIRE( eventually( [&]() { return stream.statistics().underruns > 0u; } ) );
+			THEN( "the underrun handler can't be changed while playing" ) {
+				REQUIRE_THROWS_AS( stream.on_underrun( nullptr ), chirp::stream_is_playing_exception );
+			}
+			stream.stop();
+			THEN( "the underrun is counted and notified, with the frames played without samples" ) {
+				auto statistics = stream.statistics();
+				REQUIRE( statistics.underruns == 1u );
+				REQUIRE( statistics.silence_frames == 160u );
+				REQUIRE( notified == 1u );
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend can play sample providers by reference" ) {
+	GIVEN( "a sample provider with a large state, and an audio stream of the null backend" ) {
+		struct counting_provider : chirp::sample_provider {
+			void provide_samples( chirp::duration_type const&, chirp::sample_request const& request ) override {
+				frames += request.frames();
+			}
+			std::atomic<std::uint32_t> frames{ 0 };
+			std::array<float, 1024> state{};
+		} provider;
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		WHEN( "the stream plays the provider for a while" ) {
+			stream.play_async( provider );
+			eventually( [&]() { return provider.frames > 0u; } );
+			stream.stop();
+			THEN( "the provider has been asked for samples" ) {
+				REQUIRE( provider.frames > 0u );
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend can play planar provider functions" ) {
+	GIVEN( "an audio stream of the null backend with 16 bit stereo samples" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::sixteen_bits_little_endian_stereo } );
+		WHEN( "the stream plays a function that takes planar requests for a while" ) {
+			std::atomic<std::uint32_t> frames{ 0 };
+			std::atomic<bool> planar{ true };
+			stream.play_async(
+				[&]( chirp::duration_type const&, chirp::planar_request const& request ) {
+					planar = planar && request.channels() == 2 && request.channel(1) != nullptr;
+					frames += static_cast<std::uint32_t>( request.frames() );
+				});
+			eventually( [&]() { return frames > 0u; } );
+			stream.stop();
+			THEN( "the function has been asked for float samples of each channel" ) {
+				REQUIRE( frames > 0u );
+				REQUIRE( planar == true );
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend can be played in push mode" ) {
+	GIVEN( "an audio stream of the null backend" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		std::vector<std::uint8_t> samples( 800, 1 );
+		THEN( "samples can't be written before push mode is started" ) {
+			REQUIRE_THROWS_AS( stream.write( samples.data(), samples.size() ), chirp::push_mode_exception );
+		}
+		WHEN( "push mode is started and more samples are written than the queue holds" ) {
+			stream.play_push_async( 400 );
+			auto written = stream.write( samples.data(), samples.size() );
+			THEN( "the write waits until the stream has played enough samples" ) {
+				REQUIRE( stream.is_playing() );
+				REQUIRE( written == samples.size() );
+				REQUIRE( stream.queued_frames() <= 400 );
+			}
+			stream.stop();
+		}
+		WHEN( "a write waits for room and the stream is stopped" ) {
+			stream.play_push_async( 400 );
+			std::vector<std::uint8_t> second( 8000, 1 );
+			std::size_t written = 0;
+			std::thread writer{ [&]() {
+				written = stream.write( second.data(), second.size() );
+			}};
+			eventually( [&]() { return stream.queued_frames() > 0; } );
+			stream.stop();
+			writer.join();
+			THEN( "the write returns, and the stream is no longer in push mode" ) {
+				REQUIRE( written < second.size() );
+				REQUIRE_FALSE( stream.is_playing() );
+				REQUIRE_THROWS_AS( stream.write( samples.data(), samples.size() ), chirp::push_mode_exception );
+				REQUIRE_THROWS_AS( stream.queued_frames(), chirp::push_mode_exception );
+			}
+		}
+		WHEN( "a stream in push mode plays a function" ) {
+			stream.play_push_async( 400 );
+			stream.play_async( []( chirp::duration_type const&, chirp::sample_request const& ) {} );
+			THEN( "samples can't be written" ) {
+				REQUIRE( stream.is_playing() );
+				REQUIRE_THROWS_AS( stream.write( samples.data(), samples.size() ), chirp::push_mode_exception );
+			}
+			stream.stop();
+		}
+		WHEN( "push mode is started again" ) {
+			stream.play_push_async( 400 );
+			stream.play_push_async( 200 );
+			auto written = stream.write( samples.data(), samples.size() );
+			THEN( "the new queue is played" ) {
+				REQUIRE( stream.is_playing() );
+				REQUIRE( written == samples.size() );
+				REQUIRE( stream.queued_frames() <= 200 );
+			}
+			stream.stop();
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend stop after the provider has returned" ) {
+	GIVEN( "an audio stream of the null backend that plays a slow provider" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		std::atomic<bool> providing{ false };
+		std::atomic<bool> returned{ false };
+		stream.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) {
+			if( !returned ) {
+				providing = true;
+				std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+				returned = true;
+			}
+		});
+		WHEN( "the stream is stopped while the provider is called" ) {
+			eventually( [&]() { return providing.load(); } );
+			stream.stop();
+			THEN( "the provider has returned" ) {
+				REQUIRE( returned == true );
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend can be stopped from their provider" ) {
+	GIVEN( "an audio stream of the null backend that stops itself the first time its provider is called" ) {
+		chirp::audio_platform platform{ chirp::backend_identity::null };
+		auto stream = platform.default_output_device().create_audio_stream( { 8000, chirp::eight_bits_mono } );
+		std::atomic<int> requests{ 0 };
+		stream.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) {
+			++requests;
+			stream.stop();
+		});
+		WHEN( "the provider has been called" ) {
+			REQUIRE( eventually( [&]() { return requests > 0; } ) );
+			THEN( "the stream stops, and the provider isn't called again" ) {
+				REQUIRE( eventually( [&]() { return !stream.is_playing(); } ) );
+				std::this_thread::sleep_for( std::chrono::milliseconds{30} );
+				REQUIRE( requests == 1 );
+			}
+			AND_WHEN( "the stream is played again" ) {
+				std::atomic<int> replayed{ 0 };
+				stream.play_async( [&]( chirp::duration_type const&, chirp::sample_request const& ) { ++replayed; } );
+				THEN( "the new provider is called" ) {
+					REQUIRE( eventually( [&]() { return replayed > 0; } ) );
+					REQUIRE( requests == 1 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "audio streams of the null backend report their latency" ) {
+	GIVEN( "an audio stream of the null backend with a simulated clock, and 100 ms write-ahead" ) {
+		chirp::backend::null_output_device device{ "null" };
+		simulated_clock clock;
+		auto stream = simulated_stream( device, { 8000, chirp::eight_bits_mono }, chirp::stream_options{}, clock );
+		THEN( "it has no latency before it plays" ) {
+			REQUIRE( stream.latency() == std::chrono::nanoseconds::zero() );
+		}
+		WHEN( "the stream has filled its write-ahead, and the clock is advanced by 30 ms" ) {
+			std::mutex mutex;
+			std::vector<chirp::sample_request::time_point> presentations;
+			stream.play_async(
+				[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+					std::unique_lock<std::mutex> lock{mutex};
+					presentations.push_back( request.presentation_time() );
+				});
+			REQUIRE( eventually( [&]() { return stream.latency() > std::chrono::nanoseconds::zero(); } ) );
+			auto latency = stream.latency();
+			clock.advance( std::chrono::milliseconds{30} );
+			device.play_thread().notify();
+			REQUIRE( eventually( [&]() { std::unique_lock<std::mutex> lock{mutex}; return presentations.size() >= 2; } ) );
+			stream.stop();
+			THEN( "the latency is the write-ahead" ) {
+				REQUIRE( latency == std::chrono::milliseconds{100} );
+				REQUIRE( latency <= stream.configuration().latency() );
+			}
+			THEN( "the first samples are presented when the device starts, and the refill follows on from them" ) {
+				std::unique_lock<std::mutex> lock{mutex};
+				REQUIRE( presentations[0] == clock.start() );
+				REQUIRE( presentations[1] == clock.start() + std::chrono::milliseconds{100} );
+			}
+		}
+	}
+}
@@ -3,7 +3,7 @@ project "chirp_tests"
 	language      "C++"
 	kind          "ConsoleApp"
 	uuid          "0e85239e-24f0-43ce-8507-363507b2b166"
-	includedirs   { ".", "../chirp/include" }
+	includedirs   { ".", "../chirp/include", "../chirp/src", "../chirp/src/nod" }
 	links         { "chirp" }
 	files {
 		"**.hpp",
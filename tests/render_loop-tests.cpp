@@ -0,0 +1,43 @@
+#include <catch.hpp>
+#include <engine/render_loop.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+SCENARIO( "render loops only wake up when streams needs to be serviced" ) {
+	GIVEN( "a running render loop with a long fallback interval" ) {
+		chirp::backend::render_loop loop{ std::chrono::seconds{10} };
+		loop.ensure_running();
+		std::atomic<int> updates{ 0 };
+		WHEN( "nothing is connected to the loop" ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+			THEN( "there are no updates" ) {
+				REQUIRE( updates == 0 );
+			}
+		}
+		WHEN( "a stream connects and notifies the loop" ) {
+			nod::scoped_connection connection = loop.on_update.connect( [&]( chirp::duration_type const& ) { ++updates; } );
+			loop.notify();
+			std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+			THEN( "it is updated once, and then the loop waits for the fallback interval" ) {
+				REQUIRE( updates == 1 );
+			}
+		}
+		WHEN( "a stream arms the timer at each update" ) {
+			auto period = std::chrono::milliseconds{5};
+			nod::scoped_connection connection = loop.on_update.connect(
+				[&]( chirp::duration_type const& ) {
+					++updates;
+					loop.wake_at( chirp::backend::render_loop::clock_type::now() + period );
+				});
+			loop.notify();
+			std::this_thread::sleep_for( std::chrono::milliseconds{100} );
+			connection.disconnect();
+			THEN( "it is updated at the pace of the timer" ) {
+				REQUIRE( updates >= 5 );
+				REQUIRE( updates <= 21 );
+			}
+		}
+	}
+}
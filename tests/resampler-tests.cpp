@@ -0,0 +1,215 @@
+#include <catch.hpp>
+#include <chirp/resampler.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+	double const Pi = 3.14159265358979323846;
+
+	/// A sine wave at half of full scale
+	std::vector<float> sine( double frequency, double sample_rate, std::size_t frames ) {
+		std::vector<float> samples( frames );
+		for( std::size_t i=0; i<frames; ++i ) {
+			samples[i] = static_cast<float>( 0.5 * std::sin( 2.0 * Pi * frequency * static_cast<double>( i ) / sample_rate ) );
+		}
+		return samples;
+	}
+
+	/// Resample a second of a sine wave
+	std::vector<float> resample_sine( chirp::resample_quality quality, double input_rate, double output_rate, double frequency ) {
+		chirp::resampler resampler{ 1, output_rate / input_rate, quality };
+		auto input = sine( frequency, input_rate, static_cast<std::size_t>( input_rate ) );
+		std::vector<float> output( static_cast<std::size_t>( output_rate ) );
+		auto result = resampler.process( input.data(), input.size(), output.data(), output.size() );
+		output.resize( result.output_frames );
+
+		// The filter fades in and out at the ends
+		output.erase( output.begin(), output.begin() + static_cast<std::ptrdiff_t>( resampler.taps() ) );
+		output.resize( output.size() - resampler.taps() );
+		return output;
+	}
+
+	/// @returns The ratio of the power of a sine wave to the power of the
+	///          difference to the ideally resampled sine wave, in decibels
+	double signal_to_noise( chirp::resample_quality quality, double input_rate, double output_rate, double frequency ) {
+		chirp::resampler resampler{ 1, output_rate / input_rate, quality };
+		auto output = resample_sine( quality, input_rate, output_rate, frequency );
+		double signal = 0.0;
+		double noise = 0.0;
+		for( std::size_t i=0; i<output.size(); ++i ) {
+			auto expected = 0.5 * std::sin( 2.0 * Pi * frequency * static_cast<double>( i + resampler.taps() ) / output_rate );
+			signal += expected * expected;
+			noise += (output[i] - expected) * (output[i] - expected);
+		}
+		return 10.0 * std::log10( signal / noise );
+	}
+
+	/// @returns The power of a resampled sine wave relative to its input,
+	///          in decibels
+	double level( std::vector<float> const& output ) {
+		double power = 0.0;
+		for( auto sample : output ) {
+			power += static_cast<double>( sample ) * sample;
+		}
+		return 10.0 * std::log10( power / static_cast<double>( output.size() ) / 0.125 );
+	}
+
+	/// @returns The power of a resampled sine wave relative to its input,
+	///          in decibels
+	double gain( chirp::resample_quality quality, double input_rate, double output_rate, double frequency ) {
+		return level( resample_sine( quality, input_rate, output_rate, frequency ) );
+	}
+}   // anonymous namespace
+
+SCENARIO( "resamplers convert the frequency of interleaved samples" ) {
+	GIVEN( "a stereo resampler from 48000 Hz to 24000 Hz" ) {
+		chirp::resampler resampler{ 2, 0.5 };
+		REQUIRE( resampler.taps() % 16 == 0 );
+		WHEN( "a constant level is resampled" ) {
+			std::vector<float> input( 2 * 4800 );
+			for( std::size_t i=0; i<4800; ++i ) {
+				input[2 * i] = 0.5f;
+				input[2 * i + 1] = -0.25f;
+			}
+			std::vector<float> output( 2 * 4800, 1.0f );
+			auto result = resampler.process( input.data(), 4800, output.data(), 4800 );
+			THEN( "all input frames are consumed, and half as many frames are written" ) {
+				REQUIRE( result.input_frames == 4800 );
+				REQUIRE( result.output_frames <= 2400 );
+				REQUIRE( result.output_frames + resampler.taps() >= 2400 );
+			}
+			THEN( "the level of each channel passes unchanged once the filter has filled" ) {
+				for( std::size_t i=resampler.taps(); i<result.output_frames; ++i ) {
+					REQUIRE( output[2 * i] == Approx( 0.5f ).margin( 1e-4f ) );
+					REQUIRE( output[2 * i + 1] == Approx( -0.25f ).margin( 1e-4f ) );
+				}
+			}
+			THEN( "the frames that are held back are reported as delay" ) {
+				REQUIRE( resampler.delay() >= 0.0 );
+				REQUIRE( resampler.delay() < 4800.0 - 2.0 * result.output_frames + 2.0 );
+			}
+		}
+		WHEN( "the output buffer is smaller than the input" ) {
+			std::vector<float> input( 2 * 4800, 0.0f );
+			std::vector<float> output( 2 * 100 );
+			auto result = resampler.process( input.data(), 4800, output.data(), 100 );
+			THEN( "the output buffer is filled, and the remaining input isn't consumed" ) {
+				REQUIRE( result.output_frames == 100 );
+				REQUIRE( result.input_frames < 4800 );
+			}
+		}
+	}
+	GIVEN( "invalid parameters" ) {
+		THEN( "no resampler is created" ) {
+			REQUIRE_THROWS_AS( chirp::resampler( 0, 1.0 ), chirp::resampler_exception );
+			REQUIRE_THROWS_AS( chirp::resampler( 2, 0.0 ), chirp::resampler_exception );
+			REQUIRE_THROWS_AS( chirp::resampler( 2, 100.0 ), chirp::resampler_exception );
+			REQUIRE_THROWS_AS( chirp::resampler( 2, std::nan( "" ) ), chirp::resampler_exception );
+		}
+	}
+}
+
+SCENARIO( "the quality tiers of the resampler trade accuracy against filter length" ) {
+	using chirp::resample_quality;
+	GIVEN( "the quality tiers" ) {
+		THEN( "better tiers use longer filters" ) {
+			REQUIRE( chirp::resampler( 1, 1.0, resample_quality::fast ).taps() < chirp::resampler( 1, 1.0, resample_quality::balanced ).taps() );
+			REQUIRE( chirp::resampler( 1, 1.0, resample_quality::balanced ).taps() < chirp::resampler( 1, 1.0, resample_quality::best ).taps() );
+		}
+		THEN( "lowering the frequency uses longer filters" ) {
+			REQUIRE( chirp::resampler( 1, 0.5 ).taps() > chirp::resampler( 1, 2.0 ).taps() );
+		}
+		THEN( "sine waves are resampled with a tier's signal to noise ratio" ) {
+			REQUIRE( signal_to_noise( resample_quality::fast, 44100, 48000, 1000 ) > 60.0 );
+			REQUIRE( signal_to_noise( resample_quality::balanced, 44100, 48000, 1000 ) > 85.0 );
+			REQUIRE( signal_to_noise( resample_quality::best, 44100, 48000, 1000 ) > 110.0 );
+			REQUIRE( signal_to_noise( resample_quality::balanced, 48000, 44100, 10000 ) > 85.0 );
+		}
+		THEN( "frequencies above the output Nyquist frequency are suppressed" ) {
+			REQUIRE( gain( resample_quality::fast, 48000, 32000, 20000 ) < -60.0 );
+			REQUIRE( gain( resample_quality::balanced, 48000, 32000, 20000 ) < -85.0 );
+			REQUIRE( gain( resample_quality::best, 48000, 32000, 20000 ) < -110.0 );
+		}
+		THEN( "frequencies in the pass band keep their level" ) {
+			REQUIRE( gain( resample_quality::fast, 48000, 32000, 10000 ) == Approx( 0.0 ).margin( 0.1 ) );
+			REQUIRE( gain( resample_quality::best, 48000, 32000, 12000 ) == Approx( 0.0 ).margin( 0.1 ) );
+		}
+	}
+}
+
+SCENARIO( "the ratio of a resampler can change while it resamples" ) {
+	GIVEN( "a resampler from 44100 Hz to 48000 Hz that has resampled a sine wave" ) {
+		chirp::resampler resampler{ 1, 48000.0 / 44100.0 };
+		auto input = sine( 441.0, 44100.0, 44100 );
+		std::vector<float> output( 96000 );
+		auto first = resampler.process( input.data(), 22050, output.data(), output.size() );
+		REQUIRE( first.input_frames == 22050 );
+		WHEN( "the ratio follows a drifting clock" ) {
+			resampler.set_ratio( 48010.0 / 44100.0 );
+			auto second = resampler.process( input.data() + 22050, 22050, output.data() + first.output_frames, output.size() - first.output_frames );
+			THEN( "the ratio is changed" ) {
+				REQUIRE( resampler.ratio() == Approx( 48010.0 / 44100.0 ) );
+			}
+			THEN( "the sine wave continues without a jump" ) {
+				auto total = first.output_frames + second.output_frames;
+				for( std::size_t i=resampler.taps(); i<total; ++i ) {
+					REQUIRE( std::abs( output[i] - output[i - 1] ) < 0.03f );
+				}
+			}
+			THEN( "the output frames follow the ratio" ) {
+				REQUIRE( static_cast<double>( second.output_frames ) == Approx( 22050.0 * 48010.0 / 44100.0 ).margin( 2.0 ) );
+			}
+		}
+		WHEN( "the ratio is lowered by more than the drift of a clock" ) {
+			THEN( "it is rejected, as the filter isn't designed for it" ) {
+				REQUIRE_NOTHROW( resampler.set_ratio( 48000.0 / 44100.0 * 0.995 ) );
+				REQUIRE_THROWS_AS( resampler.set_ratio( 0.25 ), chirp::resampler_exception );
+				REQUIRE( resampler.ratio() == Approx( 48000.0 / 44100.0 * 0.995 ) );
+			}
+		}
+		WHEN( "the resampler is reset" ) {
+			resampler.reset();
+			std::vector<float> silence( 1000, 0.0f );
+			auto result = resampler.process( silence.data(), silence.size(), output.data(), output.size() );
+			THEN( "it resamples silence to silence" ) {
+				for( std::size_t i=0; i<result.output_frames; ++i ) {
+					REQUIRE( output[i] == 0.0f );
+				}
+			}
+		}
+		WHEN( "the ratio is out of range" ) {
+			THEN( "it is rejected and the ratio is kept" ) {
+				REQUIRE_THROWS_AS( resampler.set_ratio( 0.01 ), chirp::resampler_exception );
+				REQUIRE( resampler.ratio() == Approx( 48000.0 / 44100.0 ) );
+			}
+		}
+	}
+	GIVEN( "resamplers from 48000 Hz to 48000 Hz that may be lowered to 32000 Hz" ) {
+		using chirp::resample_quality;
+		WHEN( "the ratio is lowered to 32000 Hz, and a sine wave above 16000 Hz is resampled" ) {
+			auto resample = []( resample_quality quality ) {
+				chirp::resampler resampler{ 1, 1.0, quality, 32000.0 / 48000.0 };
+				resampler.set_ratio( 32000.0 / 48000.0 );
+				auto input = sine( 20000.0, 48000.0, 48000 );
+				std::vector<float> output( 32000 );
+				auto result = resampler.process( input.data(), input.size(), output.data(), output.size() );
+				output.resize( result.output_frames - resampler.taps() );
+				output.erase( output.begin(), output.begin() + static_cast<std::ptrdiff_t>( resampler.taps() ) );
+				return output;
+			};
+			THEN( "it is suppressed as well as by resamplers created for that ratio" ) {
+				REQUIRE( level( resample( resample_quality::fast ) ) < -60.0 );
+				REQUIRE( level( resample( resample_quality::balanced ) ) < -85.0 );
+				REQUIRE( level( resample( resample_quality::best ) ) < -110.0 );
+			}
+		}
+		THEN( "the filters are as long as those of resamplers created for that ratio" ) {
+			REQUIRE( chirp::resampler( 1, 1.0, resample_quality::balanced, 32000.0 / 48000.0 ).taps() == chirp::resampler( 1, 32000.0 / 48000.0 ).taps() );
+			REQUIRE( chirp::resampler( 1, 1.0, resample_quality::balanced, 32000.0 / 48000.0 ).lowest_ratio() == Approx( 32000.0 / 48000.0 ) );
+			REQUIRE_THROWS_AS( chirp::resampler( 1, 1.0, resample_quality::balanced, 2.0 ), chirp::resampler_exception );
+		}
+	}
+}
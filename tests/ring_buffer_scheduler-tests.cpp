@@ -0,0 +1,195 @@
+#include <catch.hpp>
+#include <engine/ring_buffer_scheduler.hpp>
+
+#include <chirp/sample_format.hpp>
+
+#include <chrono>
+
+SCENARIO( "ring buffer schedulers fill up to the write-ahead limit" ) {
+	GIVEN( "a one second buffer with a 500 ms write-ahead limit and 100 ms periods" ) {
+		// 1000 Hz, 4 bytes per frame, 4000 bytes per second
+		chirp::audio_format format{ 1000, chirp::sixteen_bits_little_endian_stereo };
+		chirp::backend::ring_buffer_scheduler scheduler{ format, 4000, 2000, 400 };
+		WHEN( "nothing has been written" ) {
+			auto schedule = scheduler.plan( 0 );
+			THEN( "the buffer is filled from the start to the write-ahead limit" ) {
+				REQUIRE( schedule.count == 1 );
+				REQUIRE( schedule.regions[0].offset == 0 );
+				REQUIRE( schedule.regions[0].size == 2000 );
+			}
+		}
+		WHEN( "the write-ahead limit has been written" ) {
+			scheduler.commit( 2000 );
+			THEN( "the latency is the time it takes to play the written samples" ) {
+				REQUIRE( scheduler.latency() == std::chrono::milliseconds{500} );
+			}
+			THEN( "nothing more is scheduled until a period has been played" ) {
+				REQUIRE( scheduler.plan( 0 ).count == 0 );
+				REQUIRE( scheduler.refill_delay( 0 ) == std::chrono::milliseconds{100} );
+				REQUIRE( scheduler.refill_delay( 400 ) == std::chrono::nanoseconds::zero() );
+			}
+			AND_WHEN( "the read cursor has moved one period" ) {
+				auto schedule = scheduler.plan( 400 );
+				THEN( "the played period is refilled" ) {
+					REQUIRE( schedule.count == 1 );
+					REQUIRE( schedule.regions[0].offset == 2000 );
+					REQUIRE( schedule.regions[0].size == 400 );
+				}
+				THEN( "the latency is what is left ahead of the read cursor" ) {
+					REQUIRE( scheduler.latency() == std::chrono::milliseconds{400} );
+				}
+			}
+		}
+		WHEN( "the write-ahead region crosses the end of the buffer" ) {
+			scheduler.commit( 2000 );
+			scheduler.commit( 1600 );
+			auto schedule = scheduler.plan( 2400 );
+			THEN( "the write wraps around to the start of the buffer" ) {
+				REQUIRE( schedule.count == 2 );
+				REQUIRE( schedule.regions[0].offset == 3600 );
+				REQUIRE( schedule.regions[0].size == 400 );
+				REQUIRE( schedule.regions[1].offset == 0 );
+				REQUIRE( schedule.regions[1].size == 400 );
+				REQUIRE( schedule.size() == 800 );
+			}
+			AND_WHEN( "the regions have been written" ) {
+				scheduler.commit( 400 );
+				scheduler.commit( 400 );
+				THEN( "the write position has wrapped around" ) {
+					REQUIRE( scheduler.write_position() == 400 );
+					REQUIRE( scheduler.written_ahead( 2400 ) == 2000 );
+				}
+			}
+		}
+		WHEN( "the write position is inside the unsafe region of the device" ) {
+			scheduler.commit( 200 );
+			auto schedule = scheduler.plan( 0, 400 );
+			THEN( "writing continues from the write cursor of the device" ) {
+				REQUIRE( schedule.count == 1 );
+				REQUIRE( schedule.regions[0].offset == 400 );
+				REQUIRE( schedule.regions[0].size == 1600 );
+			}
+		}
+		WHEN( "the device plays past the write position" ) {
+			scheduler.commit( scheduler.plan( 0 ).size() );
+			auto schedule = scheduler.plan( 2400 );
+			THEN( "writing continues right ahead of the device instead of stalling" ) {
+				REQUIRE( schedule.count == 2 );
+				REQUIRE( schedule.regions[0].offset == 2400 );
+				REQUIRE( schedule.size() == 2000 );
+			}
+		}
+		WHEN( "the device plays past the write position with an underrun handler set" ) {
+			chirp::stream_statistics notified{ 0, 0, 0 };
+			scheduler.set_underrun_handler( [&]( chirp::stream_statistics const& statistics ) { notified = statistics; } );
+			scheduler.commit( scheduler.plan( 0 ).size() );
+			scheduler.plan( 2400 );
+			THEN( "the underrun and the frames that were played without samples are counted" ) {
+				auto statistics = scheduler.statistics();
+				REQUIRE( statistics.underruns == 1u );
+				REQUIRE( statistics.silence_frames == 100u );
+				REQUIRE( statistics.late_callbacks == 0u );
+			}
+			THEN( "the handler is notified with the updated counters" ) {
+				REQUIRE( notified.underruns == 1u );
+				REQUIRE( notified.silence_frames == 100u );
+			}
+		}
+		WHEN( "the device is serviced with less than half a period left" ) {
+			scheduler.commit( scheduler.plan( 0 ).size() );
+			scheduler.plan( 1900 );
+			THEN( "a late callback is counted, but no underrun" ) {
+				REQUIRE( scheduler.statistics().late_callbacks == 1u );
+				REQUIRE( scheduler.statistics().underruns == 0u );
+			}
+		}
+		WHEN( "the samples are consumed as soon as they are written" ) {
+			scheduler.commit( scheduler.plan_consumed().size() );
+			auto schedule = scheduler.plan_consumed();
+			THEN( "the write-ahead limit is scheduled from the write position" ) {
+				REQUIRE( schedule.count == 1 );
+				REQUIRE( schedule.regions[0].offset == 2000 );
+				REQUIRE( schedule.regions[0].size == 2000 );
+			}
+			THEN( "no underruns or late callbacks are counted" ) {
+				REQUIRE( scheduler.statistics().underruns == 0u );
+				REQUIRE( scheduler.statistics().late_callbacks == 0u );
+			}
+		}
+		WHEN( "the scheduler is reset" ) {
+			scheduler.commit( 1200 );
+			scheduler.reset();
+			THEN( "writing starts over from the start of the buffer" ) {
+				REQUIRE( scheduler.write_position() == 0 );
+			}
+		}
+	}
+	GIVEN( "sizes that aren't whole frames" ) {
+		chirp::audio_format format{ 22050, chirp::sixteen_bits_little_endian_stereo };
+		chirp::backend::ring_buffer_scheduler scheduler{ format, 4003, 5001, 1002 };
+		THEN( "all sizes are rounded down to whole frames" ) {
+			REQUIRE( scheduler.buffer_bytes() == 4000 );
+			REQUIRE( scheduler.write_ahead_bytes() == 3996 );
+			REQUIRE( scheduler.period_bytes() == 1000 );
+			REQUIRE( chirp::backend::ring_buffer_scheduler::bytes_for( format, std::chrono::milliseconds{10} ) == 880 );
+		}
+	}
+}
+
+SCENARIO( "ring buffer schedulers can adapt the write-ahead limit" ) {
+	GIVEN( "a scheduler with an adaptive write-ahead limit" ) {
+		// 1000 Hz, 4 bytes per frame, 4000 bytes per second
+		chirp::audio_format format{ 1000, chirp::sixteen_bits_little_endian_stereo };
+		auto options = chirp::stream_options{}
+			.with_buffer_duration( std::chrono::seconds{1} )
+			.with_period( std::chrono::milliseconds{100} )
+			.with_write_ahead( std::chrono::milliseconds{400} )
+			.with_adaptive_write_ahead();
+		chirp::backend::ring_buffer_scheduler scheduler{ format, options };
+		std::uint32_t read_cursor = 0;
+		auto service = [&]( std::uint32_t played ) {
+			read_cursor = (read_cursor + played) % scheduler.buffer_bytes();
+			scheduler.commit( scheduler.plan( read_cursor ).size() );
+		};
+		service( 0 );
+		REQUIRE( scheduler.adaptive() );
+		REQUIRE( scheduler.write_ahead_bytes() == 1600 );
+		WHEN( "the stream underruns" ) {
+			service( 2000 );
+			THEN( "the write-ahead limit is doubled" ) {
+				REQUIRE( scheduler.write_ahead_bytes() == 3200 );
+			}
+			AND_WHEN( "it underruns again" ) {
+				service( 3600 );
+				THEN( "the write-ahead limit leaves room for a period in the buffer" ) {
+					REQUIRE( scheduler.write_ahead_bytes() == 3600 );
+				}
+			}
+		}
+		WHEN( "the stream is serviced with less than half a period left" ) {
+			service( 1500 );
+			THEN( "the write-ahead limit grows by a period" ) {
+				REQUIRE( scheduler.write_ahead_bytes() == 2000 );
+			}
+		}
+		WHEN( "the stream has played without problems for a while" ) {
+			for( int i=0; i<39; ++i ) {
+				service( 400 );
+			}
+			REQUIRE( scheduler.write_ahead_bytes() == 1600 );
+			service( 400 );
+			THEN( "the write-ahead limit shrinks by a period" ) {
+				REQUIRE( scheduler.write_ahead_bytes() == 1200 );
+			}
+			AND_WHEN( "playback stays stable" ) {
+				for( int i=0; i<400; ++i ) {
+					service( 400 );
+				}
+				THEN( "the write-ahead limit doesn't go below two periods" ) {
+					REQUIRE( scheduler.write_ahead_bytes() == 800 );
+					REQUIRE( scheduler.configuration().write_ahead_frames == 200u );
+				}
+			}
+		}
+	}
+}
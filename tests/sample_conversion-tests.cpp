@@ -0,0 +1,250 @@
+#include <catch.hpp>
+#include <engine/planar_adapter.hpp>
+#include <engine/sample_conversion.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+SCENARIO( "planar float samples are converted to interleaved samples" ) {
+	GIVEN( "two channels of float samples, including samples out of range" ) {
+		std::array<float, 4> left{ {0.0f, 0.5f, 1.0f, 2.0f} };
+		std::array<float, 4> right{ {-0.5f, -1.0f, -2.0f, 0.25f} };
+		float const* channels[] = { left.data(), right.data() };
+		WHEN( "they are converted to 16 bit samples in the native byte order" ) {
+			std::array<std::int16_t, 8> target{};
+			chirp::backend::interleave( channels, 4, { 16, chirp::native_byte_order, 2 }, target.data() );
+			THEN( "the samples are scaled, clamped and interleaved" ) {
+				REQUIRE( (target == std::array<std::int16_t, 8>{ {0, -16383, 16383, -32767, 32767, -32767, 32767, 8191} }) );
+			}
+		}
+		WHEN( "they are converted to 8 bit samples" ) {
+			std::array<std::uint8_t, 8> target{};
+			chirp::backend::interleave( channels, 4, chirp::eight_bits_stereo, target.data() );
+			THEN( "the samples are unsigned" ) {
+				REQUIRE( (target == std::array<std::uint8_t, 8>{ {128, 64, 191, 1, 255, 1, 255, 159} }) );
+			}
+		}
+		WHEN( "they are converted to big endian 16 bit samples" ) {
+			std::array<std::uint8_t, 16> target{};
+			chirp::backend::interleave( channels, 4, chirp::sixteen_bits_big_endian_stereo, target.data() );
+			THEN( "the most significant byte comes first" ) {
+				REQUIRE( target[6] == 0x80 );
+				REQUIRE( target[7] == 0x01 );
+				REQUIRE( target[8] == 0x7f );
+				REQUIRE( target[9] == 0xff );
+			}
+		}
+		WHEN( "they are converted to packed little endian 24 bit samples" ) {
+			std::array<std::uint8_t, 24> target{};
+			chirp::backend::interleave( channels, 4, { 24, chirp::byte_order::little_endian, 2 }, target.data() );
+			THEN( "each sample takes three bytes" ) {
+				REQUIRE( target[12] == 0xff );
+				REQUIRE( target[13] == 0xff );
+				REQUIRE( target[14] == 0x7f );
+				REQUIRE( target[15] == 0x01 );
+				REQUIRE( target[16] == 0x00 );
+				REQUIRE( target[17] == 0x80 );
+			}
+		}
+		WHEN( "they are converted to 32 bit floating point samples" ) {
+			std::array<float, 8> target{};
+			chirp::backend::interleave( channels, 4, chirp::float32_stereo, target.data() );
+			THEN( "the samples are interleaved as they are, without clamping" ) {
+				REQUIRE( (target == std::array<float, 8>{ {0.0f, -0.5f, 0.5f, -1.0f, 1.0f, -2.0f, 2.0f, 0.25f} }) );
+			}
+		}
+		WHEN( "they are converted to 64 bit floating point samples" ) {
+			std::array<double, 8> target{};
+			chirp::backend::interleave( channels, 4, chirp::float64_stereo, target.data() );
+			THEN( "the samples are widened" ) {
+				REQUIRE( (target == std::array<double, 8>{ {0.0, -0.5, 0.5, -1.0, 1.0, -2.0, 2.0, 0.25} }) );
+			}
+		}
+		WHEN( "they are converted to 24 bit samples in 32 bit containers" ) {
+			std::array<std::int32_t, 8> target{};
+			chirp::backend::interleave( channels, 4, { chirp::sample_type::signed_integer, 24, 32, chirp::native_byte_order, 2 }, target.data() );
+			THEN( "the samples are scaled to 24 bits and sign extended" ) {
+				REQUIRE( (target == std::array<std::int32_t, 8>{ {0, -4194303, 4194303, -8388607, 8388607, -8388607, 8388607, 2097151} }) );
+			}
+		}
+		WHEN( "they are converted to unsigned 16 bit samples" ) {
+			std::array<std::uint16_t, 8> target{};
+			chirp::backend::interleave( channels, 4, { chirp::sample_type::unsigned_integer, 16, chirp::native_byte_order, 2 }, target.data() );
+			THEN( "the samples are offset to the middle of the range" ) {
+				REQUIRE( target[0] == 32768 );
+				REQUIRE( target[3] == 1 );
+				REQUIRE( target[4] == 65535 );
+			}
+		}
+		WHEN( "they are converted to unsigned 32 bit samples" ) {
+			std::array<std::uint32_t, 8> target{};
+			chirp::backend::interleave( channels, 4, { chirp::sample_type::unsigned_integer, 32, chirp::native_byte_order, 2 }, target.data() );
+			THEN( "the samples are offset to the middle of the range without overflowing" ) {
+				REQUIRE( target[0] == 0x80000000u );
+				REQUIRE( target[3] == 0x80000000u - 2147483520u );
+				REQUIRE( target[4] == 0x80000000u + 2147483520u );
+			}
+		}
+	}
+}
+
+SCENARIO( "planar adapters split sample requests into blocks of float samples" ) {
+	GIVEN( "a planar adapter for a 16 bit mono stream with a function that fills a ramp" ) {
+		chirp::audio_format format{ 8000, chirp::sixteen_bits_little_endian_mono };
+		chirp::backend::planar_adapter adapter{ format };
+		std::vector<std::size_t> sizes;
+		std::vector<float> play_times;
+		adapter.set_function(
+			[&]( chirp::duration_type const& play_time, chirp::planar_request const& request ) {
+				sizes.push_back( request.frames() );
+				play_times.push_back( play_time.count() );
+				for( std::size_t i=0; i<request.frames(); ++i ) {
+					REQUIRE( request.channel(0)[i] == 0.0f );
+					request.channel(0)[i] = 0.5f;
+				}
+			});
+		WHEN( "a request for 1000 frames is filled" ) {
+			std::vector<std::int16_t> buffer( 1000, 0 );
+			adapter.provide_samples( chirp::duration_type{ 1.0f }, chirp::sample_request{ buffer.data(), 2000, format } );
+			THEN( "the function is called with blocks that cover the request" ) {
+				std::size_t total = 0;
+				for( auto size : sizes ) {
+					total += size;
+				}
+				REQUIRE( sizes.size() > 1 );
+				REQUIRE( total == 1000 );
+				REQUIRE( play_times[0] == Approx( 1.0f ) );
+				REQUIRE( play_times[1] == Approx( 1.0f + sizes[0] / 8000.0f ) );
+			}
+			THEN( "all samples are converted" ) {
+				for( auto sample : buffer ) {
+					REQUIRE( sample == 16383 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "sample converters convert interleaved samples between sample formats" ) {
+	GIVEN( "16 bit stereo samples" ) {
+		std::array<std::int16_t, 6> source{ {0, 32767, -32767, 16384, -1, 1} };
+		WHEN( "they are converted to float samples and back" ) {
+			std::array<float, 6> floats{};
+			chirp::backend::sample_converter{ { 16, chirp::native_byte_order, 2 }, chirp::float32_stereo }.convert( source.data(), 3, floats.data() );
+			std::array<std::int16_t, 6> target{};
+			chirp::backend::sample_converter{ chirp::float32_stereo, { 16, chirp::native_byte_order, 2 } }.convert( floats.data(), 3, target.data() );
+			THEN( "full scale maps to 1.0" ) {
+				REQUIRE( floats[1] == 1.0f );
+				REQUIRE( floats[2] == -1.0f );
+				REQUIRE( floats[0] == 0.0f );
+			}
+			THEN( "the samples are restored within one step" ) {
+				for( std::size_t i=0; i<source.size(); ++i ) {
+					REQUIRE( std::abs( target[i] - source[i] ) <= 1 );
+				}
+			}
+		}
+		WHEN( "they are converted to big endian" ) {
+			std::array<std::uint8_t, 12> target{};
+			chirp::backend::sample_converter{ { 16, chirp::native_byte_order, 2 }, { 16, chirp::byte_order::big_endian, 2 } }.convert( source.data(), 3, target.data() );
+			THEN( "the bytes of each sample are swapped without loss" ) {
+				REQUIRE( target[2] == 0x7f );
+				REQUIRE( target[3] == 0xff );
+				REQUIRE( target[6] == 0x40 );
+				REQUIRE( target[7] == 0x00 );
+				REQUIRE( target[8] == 0xff );
+				REQUIRE( target[9] == 0xff );
+			}
+		}
+		WHEN( "they are converted to 24 bit samples in 32 bit containers" ) {
+			std::array<std::int32_t, 6> target{};
+			chirp::backend::sample_converter{ { 16, chirp::native_byte_order, 2 }, chirp::twenty_four_in_thirty_two_bits_little_endian_stereo }.convert( source.data(), 3, target.data() );
+			THEN( "the samples are scaled to 24 bits and sign extended" ) {
+				REQUIRE( target[1] == 8388607 );
+				REQUIRE( target[2] == -8388607 );
+				REQUIRE( target[4] < 0 );
+				REQUIRE( target[4] > -300 );
+			}
+		}
+	}
+	GIVEN( "8 bit unsigned samples" ) {
+		std::array<std::uint8_t, 4> source{ {128, 255, 1, 0} };
+		WHEN( "they are converted to signed 8 bit samples" ) {
+			std::array<std::int8_t, 4> target{};
+			chirp::backend::sample_converter{ chirp::eight_bits_mono, { chirp::sample_type::signed_integer, 8, chirp::byte_order::little_endian, 1 } }.convert( source.data(), 4, target.data() );
+			THEN( "the middle of the range becomes zero, and the lowest sample is clamped" ) {
+				REQUIRE( (target == std::array<std::int8_t, 4>{ {0, 127, -127, -127} }) );
+			}
+		}
+	}
+	GIVEN( "packed big endian 24 bit samples" ) {
+		std::array<std::uint8_t, 6> source{ {0x7f, 0xff, 0xff, 0xff, 0xff, 0xfe} };
+		WHEN( "they are converted to 24 bit samples in 32 bit containers" ) {
+			std::array<std::int32_t, 2> target{};
+			chirp::backend::sample_converter{ { 24, chirp::byte_order::big_endian, 1 }, chirp::twenty_four_in_thirty_two_bits_little_endian_mono }.convert( source.data(), 2, target.data() );
+			THEN( "the samples keep their value" ) {
+				REQUIRE( target[0] == 8388607 );
+				REQUIRE( target[1] == -2 );
+			}
+		}
+	}
+	GIVEN( "float samples beyond full scale" ) {
+		std::vector<float> source( 1000, 1.5f );
+		source[999] = -3.0f;
+		WHEN( "they are converted with the scalar kernels and with the detected level" ) {
+			std::vector<std::int32_t> scalar( 1000 );
+			std::vector<std::int32_t> vector( 1000 );
+			chirp::backend::sample_converter{ chirp::float32_mono, chirp::thirty_two_bits_little_endian_mono, chirp::backend::simd_level::scalar }.convert( source.data(), 1000, scalar.data() );
+			chirp::backend::sample_converter{ chirp::float32_mono, chirp::thirty_two_bits_little_endian_mono }.convert( source.data(), 1000, vector.data() );
+			THEN( "the samples are clamped the same way" ) {
+				REQUIRE( scalar == vector );
+				REQUIRE( scalar[0] == 2147483520 );
+				REQUIRE( scalar[999] == -2147483520 );
+			}
+		}
+	}
+	GIVEN( "big endian 16 bit samples" ) {
+		std::array<std::uint8_t, 8> source{ {0x7f, 0xff, 0x80, 0x01, 0x40, 0x00, 0x00, 0x00} };
+		chirp::backend::sample_converter to_native{ chirp::sixteen_bits_big_endian_mono, { 16, chirp::native_byte_order, 1 } };
+		WHEN( "they are converted to the native byte order in place" ) {
+			REQUIRE( to_native.converts_in_place() );
+			auto buffer = source;
+			to_native.convert_in_place( buffer.data(), 4 );
+			std::array<std::int16_t, 4> samples{};
+			std::memcpy( samples.data(), buffer.data(), buffer.size() );
+			THEN( "the samples keep their value" ) {
+				REQUIRE( (samples == std::array<std::int16_t, 4>{ {32767, -32767, 16384, 0} }) );
+			}
+		}
+		WHEN( "they are converted to float samples" ) {
+			std::array<float, 4> vector{};
+			chirp::backend::sample_converter{ chirp::sixteen_bits_big_endian_mono, chirp::float32_mono }.convert( source.data(), 4, vector.data() );
+			THEN( "they are swapped before they are decoded" ) {
+				REQUIRE( vector[0] == 1.0f );
+				REQUIRE( vector[1] == -1.0f );
+				REQUIRE( vector[3] == 0.0f );
+			}
+		}
+	}
+	GIVEN( "float samples and a big endian 32 bit format" ) {
+		std::array<float, 2> source{ {1.0f, -0.5f} };
+		chirp::sample_format big_endian{ 32, chirp::byte_order::big_endian, 1 };
+		WHEN( "they are converted" ) {
+			std::array<std::uint8_t, 8> target{};
+			chirp::backend::sample_converter converter{ chirp::float32_mono, big_endian };
+			converter.convert( source.data(), 2, target.data() );
+			THEN( "the samples are encoded and then swapped" ) {
+				REQUIRE( !converter.converts_in_place() );
+				REQUIRE( (target == std::array<std::uint8_t, 8>{ {0x7f, 0xff, 0xff, 0x80, 0xc0, 0x00, 0x00, 0x40} }) );
+			}
+		}
+	}
+	GIVEN( "formats with different channel counts" ) {
+		THEN( "there is no converter between them" ) {
+			REQUIRE_THROWS_AS( (chirp::backend::sample_converter{ chirp::float32_mono, chirp::float32_stereo }), chirp::sample_format_exception );
+		}
+	}
+}
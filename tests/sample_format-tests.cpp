@@ -123,6 +123,39 @@ SCENARIO( "sample formats have parameterized constructor" ) {
 		REQUIRE( format.endianness() == chirp::byte_order::little_endian );
 		REQUIRE( format.channels() == 2 );
 	}
+	SECTION( "Formats without a sample type are integers, unsigned up to 8 bits and signed above" ) {
+		REQUIRE( (chirp::sample_format{ 8, 1 }.type()) == chirp::sample_type::unsigned_integer );
+		REQUIRE( (chirp::sample_format{ 16, chirp::byte_order::little_endian, 1 }.type()) == chirp::sample_type::signed_integer );
+	}
+	SECTION( "Floating point formats have 32 or 64 bits" ) {
+		chirp::sample_format format{ chirp::sample_type::floating_point, 32, chirp::byte_order::little_endian, 2 };
+		REQUIRE( format.type() == chirp::sample_type::floating_point );
+		REQUIRE( format.bytes_per_sample() == 4 );
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::floating_point, 16, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::floating_point, 32, 64, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+	}
+	SECTION( "Integer formats have up to 32 bits, which fit in their container" ) {
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::signed_integer, 0, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::signed_integer, 40, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::signed_integer, 24, 16, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+		REQUIRE_THROWS_AS( (chirp::sample_format{ chirp::sample_type::signed_integer, 20, 30, chirp::byte_order::little_endian, 2 }), chirp::sample_format_exception );
+	}
+	SECTION( "The byte order of single byte samples is ignored" ) {
+		chirp::sample_format format{ chirp::sample_type::signed_integer, 8, chirp::byte_order::big_endian, 1 };
+		REQUIRE_THROWS_AS( format.endianness(), chirp::byte_order_exception );
+		REQUIRE( format == (chirp::sample_format{ chirp::sample_type::signed_integer, 8, chirp::byte_order::little_endian, 1 }) );
+	}
+}
+
+SCENARIO( "sample formats compare their sample types and containers" ) {
+	GIVEN( "32 bit signed integer samples" ) {
+		chirp::sample_format format{ 32, chirp::byte_order::little_endian, 2 };
+		THEN( "they differ from 32 bit unsigned, floating point and 24-in-32 bit samples" ) {
+			REQUIRE( format != (chirp::sample_format{ chirp::sample_type::unsigned_integer, 32, chirp::byte_order::little_endian, 2 }) );
+			REQUIRE( format != (chirp::sample_format{ chirp::sample_type::floating_point, 32, chirp::byte_order::little_endian, 2 }) );
+			REQUIRE( format != (chirp::sample_format{ chirp::sample_type::signed_integer, 24, 32, chirp::byte_order::little_endian, 2 }) );
+		}
+	}
 }
 
 SCENARIO( "Byte order is not valid for bit_count <=8 formats" ) {
@@ -134,6 +167,21 @@ SCENARIO( "Byte order is not valid for bit_count <=8 formats" ) {
 	}
 }
 
+SCENARIO( "sample formats can be changed to another byte order" ) {
+	GIVEN( "a big endian 24-in-32 bit stereo sample format" ) {
+		chirp::sample_format format{ chirp::sample_type::signed_integer, 24, 32, chirp::byte_order::big_endian, 2 };
+		THEN( "the little endian format has the same layout" ) {
+			REQUIRE( format.in_byte_order( chirp::byte_order::little_endian ) == chirp::twenty_four_in_thirty_two_bits_little_endian_stereo );
+			REQUIRE( format.in_byte_order( chirp::byte_order::big_endian ) == format );
+		}
+	}
+	GIVEN( "a 8 bit sample format" ) {
+		THEN( "it stays the same in any byte order" ) {
+			REQUIRE( chirp::eight_bits_mono.in_byte_order( chirp::byte_order::big_endian ) == chirp::eight_bits_mono );
+		}
+	}
+}
+
 SCENARIO( "sample_format can report it's frame size, in bytes." ) {
 	GIVEN( "a 8 bit mono sample format" ) {
 		chirp::sample_format format{ 8, 1 };
@@ -159,6 +207,27 @@ SCENARIO( "sample_format can report it's frame size, in bytes." ) {
 			REQUIRE( format.bytes_per_frame() == 4 );
 		}
 	}
+	GIVEN( "a packed 24 bit stereo sample format" ) {
+		chirp::sample_format format{ 24, chirp::byte_order::little_endian, 2 };
+		THEN( "the frame size is 6" ) {
+			REQUIRE( format.bytes_per_sample() == 3 );
+			REQUIRE( format.bytes_per_frame() == 6 );
+		}
+	}
+	GIVEN( "a 24-in-32 bit stereo sample format" ) {
+		chirp::sample_format format{ chirp::sample_type::signed_integer, 24, 32, chirp::byte_order::little_endian, 2 };
+		THEN( "the frame size includes the padding" ) {
+			REQUIRE( format.bits_per_sample() == 24 );
+			REQUIRE( format.bytes_per_sample() == 4 );
+			REQUIRE( format.bytes_per_frame() == 8 );
+		}
+	}
+	GIVEN( "a 64 bit floating point stereo sample format" ) {
+		chirp::sample_format format{ chirp::sample_type::floating_point, 64, chirp::byte_order::little_endian, 2 };
+		THEN( "the frame size is 16" ) {
+			REQUIRE( format.bytes_per_frame() == 16 );
+		}
+	}
 }
 
 SCENARIO( "Common formats is provided as constants" ) {
@@ -192,4 +261,26 @@ SCENARIO( "Common formats is provided as constants" ) {
 		REQUIRE( chirp::sixteen_bits_big_endian_stereo.endianness() == chirp::byte_order::big_endian );
 		REQUIRE( chirp::sixteen_bits_big_endian_stereo.channels() == 2 );
 	}
-}
\ No newline at end of file
+	SECTION( "24 bits, little endian" ) {
+		REQUIRE( chirp::twenty_four_bits_little_endian_stereo.bits_per_sample() == 24 );
+		REQUIRE( chirp::twenty_four_bits_little_endian_stereo.bytes_per_sample() == 3 );
+		REQUIRE( chirp::twenty_four_bits_little_endian_mono.channels() == 1 );
+	}
+	SECTION( "24 bits in 32, little endian" ) {
+		REQUIRE( chirp::twenty_four_in_thirty_two_bits_little_endian_stereo.bits_per_sample() == 24 );
+		REQUIRE( chirp::twenty_four_in_thirty_two_bits_little_endian_stereo.bytes_per_sample() == 4 );
+		REQUIRE( chirp::twenty_four_in_thirty_two_bits_little_endian_mono.channels() == 1 );
+	}
+	SECTION( "32 bits, little endian" ) {
+		REQUIRE( chirp::thirty_two_bits_little_endian_stereo.type() == chirp::sample_type::signed_integer );
+		REQUIRE( chirp::thirty_two_bits_little_endian_stereo.bytes_per_frame() == 8 );
+		REQUIRE( chirp::thirty_two_bits_little_endian_mono.channels() == 1 );
+	}
+	SECTION( "Floating point, native byte order" ) {
+		REQUIRE( chirp::float32_stereo.type() == chirp::sample_type::floating_point );
+		REQUIRE( chirp::float32_stereo.endianness() == chirp::native_byte_order );
+		REQUIRE( chirp::float32_mono.bytes_per_frame() == 4 );
+		REQUIRE( chirp::float64_stereo.bytes_per_frame() == 16 );
+		REQUIRE( chirp::float64_mono.bits_per_sample() == 64 );
+	}
+}
@@ -0,0 +1,70 @@
+#include <catch.hpp>
+#include <chirp/sample_generator.hpp>
+
+#if defined(CHIRP_WITH_COROUTINES)
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	/// Yield a ramp in blocks of three frames
+	chirp::sample_generator ramp( int blocks, int& resumes ) {
+		std::array<std::uint8_t, 3> block{};
+		std::uint8_t next = 1;
+		for( int i=0; i<blocks; ++i ) {
+			++resumes;
+			for( auto& sample : block ) {
+				sample = next++;
+			}
+			co_yield chirp::sample_block{ block.data(), block.size() };
+		}
+	}
+
+	/// Throw after the first block
+	chirp::sample_generator failing() {
+		std::array<std::uint8_t, 2> block{ {1, 2} };
+		co_yield chirp::frames<std::uint8_t, 1>{ block.data(), block.size() };
+		throw std::runtime_error{ "failed" };
+	}
+}
+
+SCENARIO( "sample generators play the blocks that a coroutine yields" ) {
+	GIVEN( "a generator that yields four blocks of three 8 bit mono frames" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		int resumes = 0;
+		auto generator = ramp( 4, resumes );
+		THEN( "the coroutine doesn't run until samples are requested" ) {
+			REQUIRE( resumes == 0 );
+			REQUIRE( generator.done() == false );
+		}
+		WHEN( "requests of five frames are filled" ) {
+			std::vector<std::uint8_t> buffer( 15, 0 );
+			generator.provide_samples( chirp::duration_type{ 0.0f }, chirp::sample_request{ buffer.data(), 5, format } );
+			THEN( "the coroutine is only resumed for the blocks that are needed" ) {
+				REQUIRE( resumes == 2 );
+			}
+			generator.provide_samples( chirp::duration_type{ 0.0f }, chirp::sample_request{ buffer.data() + 5, 5, format } );
+			generator.provide_samples( chirp::duration_type{ 0.0f }, chirp::sample_request{ buffer.data() + 10, 5, format } );
+			THEN( "the blocks are split over the requests, followed by silence once the coroutine returns" ) {
+				REQUIRE( (buffer == std::vector<std::uint8_t>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 0 }) );
+				REQUIRE( generator.done() );
+			}
+		}
+	}
+	GIVEN( "a generator that throws after the first block" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		auto generator = failing();
+		WHEN( "more frames are requested than the first block has" ) {
+			std::vector<std::uint8_t> buffer( 4, 0 );
+			THEN( "the exception is rethrown to the caller" ) {
+				REQUIRE_THROWS_AS( generator.provide_samples( chirp::duration_type{ 0.0f }, chirp::sample_request{ buffer.data(), 4, format } ), std::runtime_error );
+				REQUIRE( generator.done() );
+			}
+		}
+	}
+}
+
+#endif   // CHIRP_WITH_COROUTINES
@@ -0,0 +1,104 @@
+#include <catch.hpp>
+#include <chirp/sample_queue.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// Drain frames from a queue into a vector
+	std::vector<std::uint8_t> drain( chirp::sample_queue& queue, chirp::audio_format const& format, std::uint32_t frames ) {
+		std::vector<std::uint8_t> buffer( frames, 0 );
+		queue.provide_samples( chirp::duration_type{ 0.0f }, chirp::sample_request{ buffer.data(), frames, format } );
+		return buffer;
+	}
+}
+
+SCENARIO( "sample queues hold frames until they are played" ) {
+	GIVEN( "a queue of 8 bit mono frames with a capacity of 8 and a high-water mark of 6" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::sample_queue queue{ format, 8, 6 };
+		std::vector<std::uint8_t> frames( 10 );
+		std::iota( frames.begin(), frames.end(), std::uint8_t{1} );
+		THEN( "it is empty" ) {
+			REQUIRE( queue.queued_frames() == 0 );
+			REQUIRE( queue.capacity() == 8 );
+			REQUIRE( queue.high_water_mark() == 6 );
+		}
+		WHEN( "more frames than the high-water mark are written without waiting" ) {
+			auto written = queue.try_write( frames.data(), 10 );
+			THEN( "only frames up to the high-water mark are queued" ) {
+				REQUIRE( written == 6 );
+				REQUIRE( queue.queued_frames() == 6 );
+				REQUIRE( queue.try_write( frames.data(), 1 ) == 0 );
+			}
+			AND_WHEN( "more frames are played than are queued" ) {
+				auto played = drain( queue, format, 8 );
+				THEN( "the queued frames are played, followed by silence" ) {
+					REQUIRE( (played == std::vector<std::uint8_t>{ 1, 2, 3, 4, 5, 6, 0, 0 }) );
+					REQUIRE( queue.queued_frames() == 0 );
+				}
+				AND_WHEN( "frames that wrap around the ring buffer are written and played" ) {
+					REQUIRE( queue.try_write( frames.data() + 6, 4 ) == 4 );
+					auto wrapped = drain( queue, format, 4 );
+					THEN( "they are played in order" ) {
+						REQUIRE( (wrapped == std::vector<std::uint8_t>{ 7, 8, 9, 10 }) );
+					}
+				}
+			}
+		}
+		WHEN( "a blocking write is made with a thread that plays the queue" ) {
+			std::vector<std::uint8_t> played;
+			std::thread player{ [&]() {
+				while( played.size() < 10 ) {
+					for( auto sample : drain( queue, format, 2 ) ) {
+						if( sample != 0 ) {
+							played.push_back( sample );
+						}
+					}
+					std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+				}
+			}};
+			auto written = queue.write( frames.data(), 10 );
+			player.join();
+			THEN( "all frames are written and played in order" ) {
+				REQUIRE( written == 10 );
+				REQUIRE( played == frames );
+			}
+		}
+		WHEN( "a write waits for room and the queue is closed" ) {
+			std::size_t written = 0;
+			std::thread writer{ [&]() {
+				written = queue.write( frames.data(), 10 );
+			}};
+			while( queue.queued_frames() < 6 ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+			queue.close();
+			writer.join();
+			THEN( "the write returns the frames that were queued" ) {
+				REQUIRE( written == 6 );
+				REQUIRE( queue.closed() );
+				REQUIRE( queue.try_write( frames.data(), 1 ) == 0 );
+				REQUIRE( queue.write( frames.data(), 1 ) == 0 );
+			}
+		}
+		WHEN( "a write with a timeout waits for room that isn't made" ) {
+			auto written = queue.write( frames.data(), 10, std::chrono::milliseconds{5} );
+			THEN( "it returns the frames that were queued" ) {
+				REQUIRE( written == 6 );
+				REQUIRE_FALSE( queue.closed() );
+			}
+		}
+	}
+	GIVEN( "an audio format" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		THEN( "queues without capacity or with a high-water mark above it can't be created" ) {
+			REQUIRE_THROWS_AS( (chirp::sample_queue{ format, 0 }), chirp::push_mode_exception );
+			REQUIRE_THROWS_AS( (chirp::sample_queue{ format, 8, 9 }), chirp::push_mode_exception );
+		}
+	}
+}
@@ -49,6 +49,25 @@ SCENARIO( "sample_request can be created" ) {
 			THEN( "we can find out the duration of the request buffer" ) {
 				REQUIRE( request.duration() == std::chrono::seconds(2) );
 			}
+			THEN( "the request starts at frame zero of the stream" ) {
+				REQUIRE( request.frame_position() == 0u );
+			}
+			THEN( "the presentation time is unknown" ) {
+				REQUIRE( request.presentation_time() == chirp::sample_request::time_point{} );
+			}
+		}
+		WHEN( "we create a sample_request at a frame position" ) {
+			chirp::sample_request request{ buffer.get(), 176400, format, 0x100000000ull };
+			THEN( "we can retrieve the exact frame position" ) {
+				REQUIRE( request.frame_position() == 0x100000000ull );
+			}
+		}
+		WHEN( "we create a sample_request with a presentation time" ) {
+			auto presentation = std::chrono::steady_clock::now() + std::chrono::milliseconds{20};
+			chirp::sample_request request{ buffer.get(), 176400, format, 0, presentation };
+			THEN( "we can retrieve the presentation time" ) {
+				REQUIRE( request.presentation_time() == presentation );
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <catch.hpp>
+#include <chirp/sample_view.hpp>
+
+#include <array>
+#include <cstdint>
+
+SCENARIO( "frames can be viewed through sample requests" ) {
+	GIVEN( "a sample request for 16 bit stereo in the native byte order" ) {
+		chirp::sample_format sample_format{ 16, chirp::native_byte_order, 2 };
+		chirp::audio_format format{ 44100, sample_format };
+		alignas(16) std::array<std::int16_t, 8> buffer{ {0, 1, 2, 3, 4, 5, 6, 7} };
+		chirp::sample_request request{ buffer.data(), 16, format };
+		WHEN( "we create a stereo view of the request" ) {
+			chirp::frames<std::int16_t, 2> view{ request };
+			THEN( "it covers all frames of the request" ) {
+				REQUIRE( view.size() == 4 );
+				REQUIRE( view.channels() == 2 );
+				REQUIRE( view.samples() == 8 );
+				REQUIRE( view.data() == buffer.data() );
+			}
+			THEN( "samples are indexed by frame and channel" ) {
+				REQUIRE( view(0, 0) == 0 );
+				REQUIRE( view(0, 1) == 1 );
+				REQUIRE( view(3, 1) == 7 );
+				REQUIRE( view.frame(2)[0] == 4 );
+			}
+			THEN( "each channel can be accessed with a stride" ) {
+				auto right = view.channel( 1 );
+				REQUIRE( right.size() == 4 );
+				REQUIRE( right.stride() == 2 );
+				REQUIRE( right[0] == 1 );
+				REQUIRE( right[3] == 7 );
+			}
+			THEN( "samples can be written through the view" ) {
+				view.channel( 0 )[1] = -2;
+				REQUIRE( buffer[2] == -2 );
+			}
+			THEN( "the alignment of the buffer is known" ) {
+				REQUIRE( view.alignment() >= 16 );
+				REQUIRE( view.is_aligned( 16 ) );
+				chirp::frames<std::int16_t, 2> unaligned{ buffer.data() + 1, 1 };
+				REQUIRE( unaligned.alignment() == 2 );
+				REQUIRE( unaligned.is_aligned( 4 ) == false );
+			}
+		}
+		WHEN( "we create a view with a channel count known at run time" ) {
+			chirp::frames<std::int16_t const> view{ request };
+			THEN( "it has the channels of the format" ) {
+				REQUIRE( view.channels() == 2 );
+				REQUIRE( view(1, 0) == 2 );
+			}
+		}
+	}
+}
+
+SCENARIO( "frame views must match the sample format" ) {
+	GIVEN( "a sample request for 8 bit mono" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		std::array<std::uint8_t, 4> buffer{ {} };
+		chirp::sample_request request{ buffer.data(), 4, format };
+		THEN( "byte sized views can be created" ) {
+			REQUIRE( (chirp::frames<std::uint8_t, 1>{ request }.size()) == 4 );
+		}
+		THEN( "views with other sample types or channel counts are rejected" ) {
+			REQUIRE_THROWS_AS( (chirp::frames<std::int16_t, 1>{ request }), chirp::sample_view_exception );
+			REQUIRE_THROWS_AS( (chirp::frames<std::uint8_t, 2>{ request }), chirp::sample_view_exception );
+		}
+	}
+	GIVEN( "a 16 bit sample format in the foreign byte order" ) {
+		auto foreign = chirp::native_byte_order == chirp::byte_order::little_endian ? chirp::byte_order::big_endian : chirp::byte_order::little_endian;
+		chirp::sample_format format{ 16, foreign, 2 };
+		THEN( "it doesn't match any view" ) {
+			REQUIRE( (chirp::frames<std::int16_t, 2>::matches( format )) == false );
+			REQUIRE( (chirp::frames<std::int16_t>::matches( format )) == false );
+		}
+	}
+	GIVEN( "floating point and padded sample formats" ) {
+		THEN( "floating point views match floating point formats of the same width" ) {
+			REQUIRE( (chirp::frames<float, 2>::matches( chirp::float32_stereo )) == true );
+			REQUIRE( (chirp::frames<double, 2>::matches( chirp::float64_stereo )) == true );
+			REQUIRE( (chirp::frames<float, 2>::matches( chirp::float64_stereo )) == false );
+		}
+		THEN( "integer and floating point samples of the same width don't match each other" ) {
+			REQUIRE( (chirp::frames<std::int32_t, 2>::matches( chirp::float32_stereo )) == false );
+			REQUIRE( (chirp::frames<float, 2>::matches( { 32, chirp::native_byte_order, 2 } )) == false );
+		}
+		THEN( "padded samples match views as wide as their container" ) {
+			chirp::sample_format padded{ chirp::sample_type::signed_integer, 24, 32, chirp::native_byte_order, 2 };
+			REQUIRE( (chirp::frames<std::int32_t, 2>::matches( padded )) == true );
+		}
+	}
+}
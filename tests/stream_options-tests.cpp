@@ -0,0 +1,81 @@
+#include <catch.hpp>
+#include <chirp/stream_options.hpp>
+
+#include <chrono>
+
+SCENARIO( "stream options are created from latency profiles" ) {
+	GIVEN( "default constructed stream options" ) {
+		chirp::stream_options options;
+		THEN( "they use the balanced profile" ) {
+			REQUIRE( options.profile() == chirp::latency_profile::balanced );
+		}
+	}
+	GIVEN( "options for each latency profile" ) {
+		chirp::stream_options ultra_low{ chirp::latency_profile::ultra_low };
+		chirp::stream_options low{ chirp::latency_profile::low };
+		chirp::stream_options balanced{ chirp::latency_profile::balanced };
+		chirp::stream_options power_saving{ chirp::latency_profile::power_saving };
+		THEN( "lower latency profiles have shorter write-ahead limits and periods" ) {
+			REQUIRE( ultra_low.write_ahead() < low.write_ahead() );
+			REQUIRE( low.write_ahead() < balanced.write_ahead() );
+			REQUIRE( balanced.write_ahead() < power_saving.write_ahead() );
+			REQUIRE( ultra_low.period() < low.period() );
+			REQUIRE( low.period() < balanced.period() );
+			REQUIRE( balanced.period() < power_saving.period() );
+		}
+		THEN( "the low latency profiles are below 20 ms" ) {
+			REQUIRE( ultra_low.write_ahead() < std::chrono::milliseconds{20} );
+			REQUIRE( low.write_ahead() <= std::chrono::milliseconds{20} );
+		}
+		THEN( "the write-ahead limit fits in the buffer" ) {
+			for( auto const& options : { ultra_low, low, balanced, power_saving } ) {
+				REQUIRE( options.period() <= options.write_ahead() );
+				REQUIRE( options.write_ahead() < options.buffer_duration() );
+			}
+		}
+	}
+}
+
+SCENARIO( "stream options can override the sizes of a profile" ) {
+	GIVEN( "options for the power saving profile" ) {
+		chirp::stream_options options{ chirp::latency_profile::power_saving };
+		WHEN( "the period is changed" ) {
+			auto changed = options.with_period( std::chrono::milliseconds{50} );
+			THEN( "only the period differs from the original options" ) {
+				REQUIRE( changed.period() == std::chrono::milliseconds{50} );
+				REQUIRE( changed.buffer_duration() == options.buffer_duration() );
+				REQUIRE( changed.write_ahead() == options.write_ahead() );
+				REQUIRE( changed.profile() == options.profile() );
+			}
+		}
+		WHEN( "a size is set to zero" ) {
+			THEN( "an exception is thrown" ) {
+				REQUIRE_THROWS_AS( options.with_buffer_duration( std::chrono::nanoseconds::zero() ), chirp::invalid_stream_options_exception );
+				REQUIRE_THROWS_AS( options.with_period( std::chrono::nanoseconds::zero() ), chirp::invalid_stream_options_exception );
+				REQUIRE_THROWS_AS( options.with_write_ahead( std::chrono::milliseconds{-1} ), chirp::invalid_stream_options_exception );
+			}
+		}
+		WHEN( "a render quantum is set" ) {
+			THEN( "it is kept if it is a power of two" ) {
+				REQUIRE( options.render_quantum() == 0u );
+				REQUIRE( options.with_render_quantum( 128 ).render_quantum() == 128u );
+				REQUIRE( options.with_render_quantum( 128 ).with_render_quantum( 0 ).render_quantum() == 0u );
+			}
+			THEN( "other sizes are rejected" ) {
+				REQUIRE_THROWS_AS( options.with_render_quantum( 100 ), chirp::invalid_stream_options_exception );
+				REQUIRE_THROWS_AS( options.with_render_quantum( 16384 ), chirp::invalid_stream_options_exception );
+			}
+		}
+	}
+}
+
+SCENARIO( "stream configurations convert frame counts to durations" ) {
+	GIVEN( "a configuration at 48 kHz" ) {
+		chirp::stream_configuration configuration{ 48000, 24000, 480, 960 };
+		THEN( "the durations correspond to the frame counts" ) {
+			REQUIRE( configuration.buffer_duration() == std::chrono::milliseconds{500} );
+			REQUIRE( configuration.period() == std::chrono::milliseconds{10} );
+			REQUIRE( configuration.latency() == std::chrono::milliseconds{20} );
+		}
+	}
+}
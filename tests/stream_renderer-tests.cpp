@@ -0,0 +1,439 @@
+#include <catch.hpp>
+#include <engine/stream_renderer.hpp>
+
+#include <chirp/sample_format.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+SCENARIO( "stream renderers call the sample provider with cleared buffers" ) {
+	GIVEN( "a renderer for a 8000 Hz stream" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format };
+		std::vector<std::uint8_t> buffer( 80, 0xff );
+		std::vector<float> play_durations;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const& play_duration, chirp::sample_request const& request ) {
+				play_durations.push_back( play_duration.count() );
+				REQUIRE( static_cast<std::uint8_t*>(request.buffer_start())[0] == 0 );
+			});
+		renderer.set_sample_provider( provider );
+		WHEN( "two requests are rendered" ) {
+			renderer.render( buffer.data(), 80 );
+			renderer.render( buffer.data(), 40 );
+			THEN( "the play duration advances with the rendered samples" ) {
+				REQUIRE( play_durations.size() == 2 );
+				REQUIRE( play_durations[0] == Approx( 0.0f ) );
+				REQUIRE( play_durations[1] == Approx( 0.01f ) );
+				REQUIRE( renderer.play_duration().count() == Approx( 0.015f ) );
+			}
+			AND_WHEN( "the renderer is rewound" ) {
+				renderer.rewind();
+				THEN( "the play duration starts over" ) {
+					REQUIRE( renderer.play_duration().count() == Approx( 0.0f ) );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers time the sample provider against the budget of each request" ) {
+	GIVEN( "a renderer for a 8000 Hz stream with a provider that sleeps on every other request" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format };
+		std::vector<std::uint8_t> buffer( 8, 0 );
+		int requests = 0;
+		renderer.set_sample_provider( renderer.adopt(
+			[&]( chirp::duration_type const&, chirp::sample_request const& ) {
+				if( ++requests % 2 == 0 ) {
+					std::this_thread::sleep_for( std::chrono::milliseconds{5} );
+				}
+			}) );
+		WHEN( "nothing has been rendered" ) {
+			auto statistics = renderer.statistics();
+			THEN( "all figures are zero" ) {
+				REQUIRE( statistics.callbacks == 0u );
+				REQUIRE( statistics.load == 0.0f );
+				REQUIRE( statistics.over_budget == 0u );
+				for( auto count : statistics.histogram ) {
+					REQUIRE( count == 0u );
+				}
+			}
+		}
+		WHEN( "requests of 1 ms are rendered with a budget handler at half the budget" ) {
+			std::vector<chirp::budget_event> events;
+			renderer.set_budget_handler( 0.5f, [&]( chirp::budget_event const& event ) { events.push_back( event ); } );
+			for( int i=0; i<4; ++i ) {
+				renderer.render( buffer.data(), 8 );
+			}
+			auto statistics = renderer.statistics();
+			THEN( "the sleeping callbacks are counted as over budget" ) {
+				REQUIRE( statistics.callbacks == 4u );
+				REQUIRE( statistics.over_budget == 2u );
+				REQUIRE( statistics.peak_load >= 5.0f );
+				REQUIRE( statistics.load > 0.0f );
+			}
+			THEN( "the handler is called for the sleeping callbacks" ) {
+				REQUIRE( events.size() == 2 );
+				REQUIRE( events[0].budget == std::chrono::milliseconds{1} );
+				REQUIRE( events[0].duration >= std::chrono::milliseconds{5} );
+				REQUIRE( events[0].load() >= 5.0f );
+			}
+			THEN( "the callback durations end up in the histogram" ) {
+				chirp::callback_statistics::counter_type total = 0;
+				chirp::callback_statistics::counter_type slow = 0;
+				for( std::size_t i=0; i<chirp::callback_histogram_size; ++i ) {
+					total += statistics.histogram[i];
+					if( chirp::callback_statistics::histogram_bin_start( i ) >= std::chrono::microseconds{4096} ) {
+						slow += statistics.histogram[i];
+					}
+				}
+				REQUIRE( total == 4u );
+				REQUIRE( slow == 2u );
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers with a render quantum always request the same number of frames" ) {
+	GIVEN( "a renderer for a 8000 Hz stream with a quantum of 64 frames, and a provider that counts frames" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format, chirp::stream_options{}.with_render_quantum( 64 ) };
+		std::vector<std::uint32_t> sizes;
+		std::vector<float> play_durations;
+		std::uint8_t next = 0;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const& play_duration, chirp::sample_request const& request ) {
+				sizes.push_back( request.frames() );
+				play_durations.push_back( play_duration.count() );
+				auto* ptr = static_cast<std::uint8_t*>( request.buffer_start() );
+				for( std::uint32_t i=0; i<request.frames(); ++i ) {
+					ptr[i] = next++;
+				}
+			});
+		renderer.set_sample_provider( provider );
+		WHEN( "regions of varying sizes are rendered" ) {
+			std::vector<std::uint8_t> buffer( 200, 0 );
+			renderer.render( buffer.data(), 10 );
+			renderer.render( buffer.data() + 10, 100 );
+			renderer.render( buffer.data() + 110, 90 );
+			THEN( "the provider is only asked for whole quanta" ) {
+				REQUIRE( sizes.size() == 4 );
+				for( auto size : sizes ) {
+					REQUIRE( size == 64u );
+				}
+				REQUIRE( play_durations[1] == Approx( 0.008f ) );
+			}
+			THEN( "the quanta are split over the regions without gaps" ) {
+				for( std::size_t i=0; i<buffer.size(); ++i ) {
+					REQUIRE( buffer[i] == static_cast<std::uint8_t>( i ) );
+				}
+			}
+			THEN( "the play duration follows the rendered regions" ) {
+				REQUIRE( renderer.play_duration().count() == Approx( 0.025f ) );
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers split sample requests at scheduled frames" ) {
+	GIVEN( "a renderer for a 8000 Hz stream with a provider that fills ones" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		std::vector<std::uint32_t> sizes;
+		std::vector<std::uint64_t> positions;
+		std::vector<std::uint64_t> events;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				sizes.push_back( request.frames() );
+				positions.push_back( request.frame_position() );
+				std::memset( request.buffer_start(), 1, request.buffer_size() );
+			});
+		WHEN( "the provider is scheduled from frame 10 to 30 with an event at frame 20, and 40 frames are rendered" ) {
+			chirp::backend::stream_renderer renderer{ format };
+			renderer.set_sample_provider( provider );
+			renderer.timeline().schedule_start( 10 );
+			renderer.timeline().schedule_stop( 30 );
+			renderer.timeline().schedule_event( 20, [&]( std::uint64_t frame ) {
+				events.push_back( frame );
+				REQUIRE( sizes.size() == 1 );
+			});
+			std::vector<std::uint8_t> buffer( 40, 0xff );
+			renderer.render( buffer.data(), 40 );
+			THEN( "the provider is asked for the frames before and after the event" ) {
+				REQUIRE( (sizes == std::vector<std::uint32_t>{ 10, 10 }) );
+				REQUIRE( (positions == std::vector<std::uint64_t>{ 10, 20 }) );
+				REQUIRE( (events == std::vector<std::uint64_t>{ 20 }) );
+				REQUIRE( renderer.timeline().position() == 40u );
+			}
+			THEN( "the frames outside of the schedule are silent" ) {
+				for( std::size_t i=0; i<buffer.size(); ++i ) {
+					REQUIRE( buffer[i] == (i >= 10 && i < 30 ? 1 : 0) );
+				}
+			}
+		}
+		WHEN( "the same schedule is rendered with a render quantum of 16 frames" ) {
+			chirp::backend::stream_renderer renderer{ format, chirp::stream_options{}.with_render_quantum( 16 ) };
+			renderer.set_sample_provider( provider );
+			renderer.timeline().schedule_start( 10 );
+			renderer.timeline().schedule_stop( 30 );
+			renderer.timeline().schedule_event( 20, [&]( std::uint64_t frame ) { events.push_back( frame ); } );
+			std::vector<std::uint8_t> buffer( 40, 0xff );
+			renderer.render( buffer.data(), 40 );
+			THEN( "the requests are not split, but the frames outside of the schedule are still silent" ) {
+				REQUIRE( (sizes == std::vector<std::uint32_t>{ 16, 16 }) );
+				REQUIRE( (events == std::vector<std::uint64_t>{ 20 }) );
+				for( std::size_t i=0; i<buffer.size(); ++i ) {
+					REQUIRE( buffer[i] == (i >= 10 && i < 30 ? 1 : 0) );
+				}
+			}
+		}
+		WHEN( "the provider starts at frame 5 of a render quantum of 16 frames, with an event at frame 3" ) {
+			chirp::backend::stream_renderer renderer{ format, chirp::stream_options{}.with_render_quantum( 16 ) };
+			renderer.set_sample_provider( provider );
+			renderer.timeline().schedule_start( 5 );
+			renderer.timeline().schedule_event( 3, [&]( std::uint64_t frame ) {
+				events.push_back( frame );
+				REQUIRE( sizes.empty() );
+			});
+			std::vector<std::uint8_t> buffer( 32, 0xff );
+			renderer.render( buffer.data(), 32 );
+			THEN( "the event fires before the quantum, which is rendered whole and silenced before the start" ) {
+				REQUIRE( (sizes == std::vector<std::uint32_t>{ 16, 16 }) );
+				REQUIRE( (positions == std::vector<std::uint64_t>{ 0, 16 }) );
+				REQUIRE( (events == std::vector<std::uint64_t>{ 3 }) );
+				for( std::size_t i=0; i<buffer.size(); ++i ) {
+					REQUIRE( buffer[i] == (i >= 5 ? 1 : 0) );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers only clear the frames that the sample provider didn't write" ) {
+	GIVEN( "a renderer for a 8000 Hz stream with a provider that reports how much it wrote" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format };
+		int calls = 0;
+		bool end_of_stream = false;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				++calls;
+				std::memset( request.buffer_start(), 1, request.frames() / 2 );
+				return chirp::fill_result{ request.frames() / 2, end_of_stream };
+			});
+		renderer.set_sample_provider( provider );
+		std::vector<std::uint8_t> buffer( 20, 0xff );
+		WHEN( "a request is filled in part" ) {
+			renderer.render( buffer.data(), 20 );
+			THEN( "the written frames are kept and the rest is silent" ) {
+				for( std::size_t i=0; i<buffer.size(); ++i ) {
+					REQUIRE( buffer[i] == (i < 10 ? 1 : 0) );
+				}
+				REQUIRE( renderer.timeline().end_frame() == chirp::stream_timeline::never );
+			}
+		}
+		WHEN( "the provider reports the end of the stream" ) {
+			end_of_stream = true;
+			renderer.render( buffer.data(), 20 );
+			std::fill( buffer.begin(), buffer.end(), 0xff );
+			renderer.render( buffer.data(), 20 );
+			THEN( "the provider isn't called anymore, and the stream is silent" ) {
+				REQUIRE( calls == 1 );
+				REQUIRE( renderer.timeline().end_frame() == 10u );
+				for( auto sample : buffer ) {
+					REQUIRE( sample == 0 );
+				}
+			}
+			AND_WHEN( "the renderer is rewound" ) {
+				renderer.rewind();
+				THEN( "the stream has no end anymore" ) {
+					REQUIRE( renderer.timeline().end_frame() == chirp::stream_timeline::never );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers pass the presentation time of each sample request" ) {
+	GIVEN( "a renderer for a 8000 Hz stream with a provider that records presentation times" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format };
+		std::vector<chirp::sample_request::time_point> times;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				times.push_back( request.presentation_time() );
+			});
+		renderer.set_sample_provider( provider );
+		std::vector<std::uint8_t> buffer( 40, 0 );
+		auto now = std::chrono::steady_clock::now();
+		WHEN( "a request is split by an event at frame 10" ) {
+			renderer.timeline().schedule_event( 10, nullptr );
+			renderer.render( buffer.data(), 40, now );
+			THEN( "each part is presented when its first frame is played" ) {
+				REQUIRE( times.size() == 2 );
+				REQUIRE( times[0] == now );
+				REQUIRE( times[1] == now + std::chrono::microseconds{1250} );
+			}
+		}
+		WHEN( "the presentation time isn't known" ) {
+			renderer.timeline().schedule_event( 10, nullptr );
+			renderer.render( buffer.data(), 40 );
+			THEN( "it stays unknown for every part" ) {
+				REQUIRE( times.size() == 2 );
+				REQUIRE( times[0] == chirp::sample_request::time_point{} );
+				REQUIRE( times[1] == chirp::sample_request::time_point{} );
+			}
+		}
+	}
+	GIVEN( "the same renderer with a render quantum of 16 frames" ) {
+		chirp::audio_format format{ 8000, chirp::eight_bits_mono };
+		chirp::backend::stream_renderer renderer{ format, chirp::stream_options{}.with_render_quantum( 16 ) };
+		std::vector<chirp::sample_request::time_point> times;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				times.push_back( request.presentation_time() );
+			});
+		renderer.set_sample_provider( provider );
+		std::vector<std::uint8_t> buffer( 40, 0 );
+		auto now = std::chrono::steady_clock::now();
+		WHEN( "a region that isn't a whole number of quanta is rendered" ) {
+			renderer.render( buffer.data(), 40, now );
+			THEN( "each quantum is presented when its first frame is played" ) {
+				REQUIRE( times.size() == 3 );
+				REQUIRE( times[0] == now );
+				REQUIRE( times[1] == now + std::chrono::milliseconds{2} );
+				REQUIRE( times[2] == now + std::chrono::milliseconds{4} );
+			}
+		}
+	}
+}
+
+SCENARIO( "stream renderers convert samples to the format of the device" ) {
+	GIVEN( "a renderer for a float stream on a device that plays 16 bit samples" ) {
+		chirp::audio_format format{ 8000, chirp::float32_stereo };
+		chirp::backend::stream_renderer renderer{ format };
+		renderer.set_device_format( { 8000, { 16, chirp::native_byte_order, 2 } } );
+		std::vector<std::size_t> sizes;
+		std::vector<chirp::sample_request::time_point> times;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				sizes.push_back( request.frames() );
+				times.push_back( request.presentation_time() );
+				auto* samples = static_cast<float*>( request.buffer_start() );
+				for( std::size_t i=0; i<request.frames(); ++i ) {
+					samples[2 * i] = 0.5f;
+					samples[2 * i + 1] = -2.0f;
+				}
+			});
+		renderer.set_sample_provider( provider );
+		WHEN( "more frames are rendered than are converted at a time" ) {
+			std::vector<std::int16_t> buffer( 2 * 3000, 0 );
+			auto now = std::chrono::steady_clock::now();
+			renderer.render( buffer.data(), 4 * 3000, now );
+			THEN( "the provider fills blocks of float samples that cover the buffer" ) {
+				std::size_t total = 0;
+				for( auto size : sizes ) {
+					total += size;
+				}
+				REQUIRE( sizes.size() > 1 );
+				REQUIRE( total == 3000 );
+				REQUIRE( renderer.rendered_frames() == 3000 );
+				REQUIRE( times[0] == now );
+				REQUIRE( times[1] == now + format.duration_of( sizes[0] ) );
+			}
+			THEN( "the device buffer holds 16 bit samples" ) {
+				for( std::size_t i=0; i<3000; ++i ) {
+					REQUIRE( buffer[2 * i] == 16383 );
+					REQUIRE( buffer[2 * i + 1] == -32767 );
+				}
+			}
+		}
+	}
+	GIVEN( "a renderer for a big endian stream on a device that plays the native byte order" ) {
+		chirp::audio_format format{ 8000, chirp::sixteen_bits_big_endian_mono };
+		chirp::backend::stream_renderer renderer{ format };
+		renderer.set_device_format( { 8000, { 16, chirp::native_byte_order, 1 } } );
+		std::vector<void*> buffers;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				buffers.push_back( request.buffer_start() );
+				auto* bytes = static_cast<std::uint8_t*>( request.buffer_start() );
+				for( std::size_t i=0; i<request.frames(); ++i ) {
+					bytes[2 * i] = 0x12;
+					bytes[2 * i + 1] = 0x34;
+				}
+			});
+		renderer.set_sample_provider( provider );
+		WHEN( "frames are rendered" ) {
+			std::vector<std::int16_t> buffer( 3000, 0 );
+			renderer.render( buffer.data(), 6000 );
+			THEN( "the provider writes directly into the device buffer" ) {
+				REQUIRE( buffers.size() == 1 );
+				REQUIRE( buffers[0] == buffer.data() );
+			}
+			THEN( "the samples are swapped in place" ) {
+				REQUIRE( buffer[0] == 0x1234 );
+				REQUIRE( buffer[2999] == 0x1234 );
+			}
+		}
+	}
+	GIVEN( "a renderer for a stereo stream" ) {
+		chirp::backend::stream_renderer renderer{ { 8000, chirp::float32_stereo } };
+		THEN( "it can't convert to a mono device" ) {
+			REQUIRE_THROWS_AS( renderer.set_device_format( { 8000, chirp::float32_mono } ), chirp::sample_format_exception );
+			REQUIRE_THROWS_AS( renderer.set_device_format( { 16000, chirp::float32_mono } ), chirp::sample_format_exception );
+		}
+	}
+}
+
+SCENARIO( "stream renderers resample to the frequency of the device" ) {
+	GIVEN( "a renderer for a 8000 Hz 16 bit stream on a 16000 Hz float device" ) {
+		chirp::audio_format format{ 8000, { 16, chirp::native_byte_order, 1 } };
+		chirp::backend::stream_renderer renderer{ format };
+		renderer.set_device_format( { 16000, chirp::float32_mono } );
+		std::vector<std::size_t> sizes;
+		std::vector<chirp::sample_request::time_point> times;
+		auto provider = chirp::make_sample_provider(
+			[&]( chirp::duration_type const&, chirp::sample_request const& request ) {
+				sizes.push_back( request.frames() );
+				times.push_back( request.presentation_time() );
+				auto* samples = static_cast<std::int16_t*>( request.buffer_start() );
+				for( std::size_t i=0; i<request.frames(); ++i ) {
+					samples[i] = 16384;
+				}
+			});
+		renderer.set_sample_provider( provider );
+		WHEN( "more frames are rendered than the stream renders at a time" ) {
+			std::vector<float> buffer( 4000, 0.0f );
+			auto now = std::chrono::steady_clock::now();
+			renderer.render( buffer.data(), 4 * 4000, now );
+			THEN( "the stream renders half as many frames, and a little ahead" ) {
+				REQUIRE( renderer.rendered_frames() >= 2000 );
+				REQUIRE( renderer.rendered_frames() < 2000 + 2 * 1024 );
+			}
+			THEN( "each block of the stream is presented when its first frame is played" ) {
+				REQUIRE( times.size() >= 2 );
+				REQUIRE( times[0] == now );
+				auto offset = times[1] - (now + format.duration_of( sizes[0] ));
+				REQUIRE( std::abs( std::chrono::duration_cast<std::chrono::nanoseconds>( offset ).count() ) <= 1000 );
+			}
+			THEN( "the device buffer holds the resampled level once the filter has filled" ) {
+				for( std::size_t i=100; i<4000; ++i ) {
+					REQUIRE( buffer[i] == Approx( 16384.0f / 32767.0f ).margin( 0.001f ) );
+				}
+			}
+			AND_WHEN( "the renderer is rewound and renders again" ) {
+				auto first = buffer;
+				renderer.rewind();
+				renderer.render( buffer.data(), 4 * 4000, now );
+				THEN( "the resampler starts over, and the samples repeat" ) {
+					REQUIRE( buffer == first );
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#include <catch.hpp>
+#include <chirp/stream_timeline.hpp>
+
+#include <vector>
+
+SCENARIO( "stream timelines keep track of scheduled frames" ) {
+	GIVEN( "an empty timeline" ) {
+		chirp::stream_timeline timeline;
+		THEN( "the sample provider plays all frames, and nothing else is scheduled" ) {
+			REQUIRE( timeline.position() == 0u );
+			REQUIRE( timeline.is_active( 0 ) );
+			REQUIRE( timeline.next_boundary( 0 ) == chirp::stream_timeline::never );
+		}
+		WHEN( "a start frame, a stop frame and events are scheduled" ) {
+			std::vector<std::uint64_t> fired;
+			timeline.schedule_start( 100 );
+			timeline.schedule_stop( 300 );
+			timeline.schedule_event( 250, [&]( std::uint64_t frame ) { fired.push_back( frame ); } );
+			timeline.schedule_event( 50, [&]( std::uint64_t frame ) { fired.push_back( frame ); } );
+			timeline.fire_events( 0 );
+			THEN( "the sample provider only plays between the start and stop frames" ) {
+				REQUIRE( timeline.is_active( 99 ) == false );
+				REQUIRE( timeline.is_active( 100 ) );
+				REQUIRE( timeline.is_active( 299 ) );
+				REQUIRE( timeline.is_active( 300 ) == false );
+			}
+			THEN( "the boundaries are the scheduled frames in order" ) {
+				REQUIRE( timeline.next_boundary( 0 ) == 50u );
+				timeline.fire_events( 50 );
+				REQUIRE( timeline.next_boundary( 50 ) == 100u );
+				REQUIRE( timeline.next_boundary( 100 ) == 250u );
+				timeline.fire_events( 250 );
+				REQUIRE( timeline.next_boundary( 250 ) == 300u );
+				REQUIRE( timeline.next_boundary( 300 ) == chirp::stream_timeline::never );
+			}
+			THEN( "events are fired in frame order once their frame is reached" ) {
+				timeline.fire_events( 49 );
+				REQUIRE( fired.empty() );
+				timeline.fire_events( 1000 );
+				REQUIRE( (fired == std::vector<std::uint64_t>{ 50, 250 }) );
+			}
+		}
+		WHEN( "too many events are scheduled before the play thread takes them" ) {
+			for( std::size_t i=0; i<chirp::stream_timeline::max_events; ++i ) {
+				timeline.schedule_event( i, []( std::uint64_t ) {} );
+			}
+			THEN( "an exception is thrown" ) {
+				REQUIRE_THROWS_AS( timeline.schedule_event( 0, []( std::uint64_t ) {} ), chirp::stream_timeline_exception );
+			}
+		}
+		WHEN( "the timeline advances and is rewound" ) {
+			timeline.advance( 128 );
+			REQUIRE( timeline.position() == 128u );
+			timeline.rewind();
+			THEN( "the position starts over" ) {
+				REQUIRE( timeline.position() == 0u );
+			}
+		}
+	}
+}
@@ -13,10 +13,14 @@ namespace test
 			return _name;
 		}
 
-		std::unique_ptr<chirp::backend::audio_stream> create_audio_stream( chirp::audio_format const& ) override {
+		std::unique_ptr<chirp::backend::audio_stream> create_audio_stream( chirp::audio_format const&, chirp::stream_options const& ) override {
 			throw std::exception{};
 		}
 
+		bool supports( chirp::audio_format const& ) const override {
+			return false;
+		}
+
 		bool operator==(chirp::backend::output_device const& other) const override {
 			return dynamic_cast<output_device const*>(&other) != nullptr &&
 			       _name == other.name();
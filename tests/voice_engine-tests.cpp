@@ -0,0 +1,293 @@
+#include <catch.hpp>
+#include <chirp/voice_engine.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// Render a number of frames
+	std::vector<float> render( chirp::voice_engine& engine, std::size_t frames ) {
+		std::vector<float> samples( frames * engine.format().channels(), 1234.0f );
+		chirp::sample_request request{ samples.data(), static_cast<chirp::sample_request::byte_count>( samples.size() * sizeof(float) ), engine.format(), 0, {} };
+		engine.provide_samples( chirp::duration_type{ 0.0f }, request );
+		return samples;
+	}
+}   // anonymous namespace
+
+SCENARIO( "voice engines play sounds that end by themselves" ) {
+	GIVEN( "a mono voice engine with four voices, and a ramp of 600 samples" ) {
+		chirp::voice_engine engine{ { 8000, chirp::float32_mono }, 4 };
+		std::vector<float> ramp( 600 );
+		for( std::size_t i=0; i<ramp.size(); ++i ) {
+			ramp[i] = static_cast<float>( i ) / 1000.0f;
+		}
+		WHEN( "nothing plays" ) {
+			auto samples = render( engine, 100 );
+			THEN( "the output is silent" ) {
+				REQUIRE( engine.playing_voices() == 0 );
+				for( auto sample : samples ) {
+					REQUIRE( sample == 0.0f );
+				}
+			}
+		}
+		WHEN( "the ramp is played at half gain" ) {
+			chirp::voice_parameters parameters;
+			parameters.gain = 0.5f;
+			auto voice = engine.play( ramp.data(), ramp.size(), parameters );
+			auto samples = render( engine, 1000 );
+			THEN( "the output is the ramp, followed by silence" ) {
+				for( std::size_t i=0; i<ramp.size(); ++i ) {
+					REQUIRE( samples[i] == Approx( ramp[i] * 0.5f ) );
+				}
+				for( std::size_t i=ramp.size(); i<samples.size(); ++i ) {
+					REQUIRE( samples[i] == 0.0f );
+				}
+			}
+			THEN( "the voice has ended and its handle is stale" ) {
+				REQUIRE( voice );
+				REQUIRE_FALSE( engine.is_playing( voice ) );
+				REQUIRE( engine.playing_voices() == 0 );
+				REQUIRE( engine.statistics().played == 1 );
+			}
+		}
+		WHEN( "the ramp is played at twice the pitch" ) {
+			chirp::voice_parameters parameters;
+			parameters.pitch = 2.0f;
+			engine.play( ramp.data(), ramp.size(), parameters );
+			auto samples = render( engine, 400 );
+			THEN( "every other sample is played" ) {
+				for( std::size_t i=0; i<300; ++i ) {
+					REQUIRE( samples[i] == Approx( ramp[2 * i] ) );
+				}
+				for( std::size_t i=300; i<samples.size(); ++i ) {
+					REQUIRE( samples[i] == 0.0f );
+				}
+			}
+		}
+		WHEN( "the ramp is played at half the pitch" ) {
+			chirp::voice_parameters parameters;
+			parameters.pitch = 0.5f;
+			engine.play( ramp.data(), ramp.size(), parameters );
+			auto samples = render( engine, 1300 );
+			THEN( "the samples in between are interpolated" ) {
+				for( std::size_t i=0; i<1198; ++i ) {
+					REQUIRE( samples[i] == Approx( static_cast<float>( i ) / 2000.0f ).margin( 1e-6f ) );
+				}
+				REQUIRE( samples[1199] == Approx( ramp.back() / 2.0f ) );
+				REQUIRE( samples[1200] == 0.0f );
+			}
+		}
+		WHEN( "a voice is stopped" ) {
+			auto voice = engine.play( ramp.data(), ramp.size() );
+			render( engine, 100 );
+			REQUIRE( engine.is_playing( voice ) );
+			engine.stop( voice );
+			REQUIRE( engine.is_playing( voice ) );
+			auto samples = render( engine, 100 );
+			THEN( "it is silent from the next block on" ) {
+				REQUIRE_FALSE( engine.is_playing( voice ) );
+				for( auto sample : samples ) {
+					REQUIRE( sample == 0.0f );
+				}
+			}
+		}
+		WHEN( "voices with invalid parameters are played" ) {
+			chirp::voice_parameters parameters;
+			THEN( "they are rejected" ) {
+				parameters.pitch = 0.0f;
+				REQUIRE_THROWS_AS( engine.play( ramp.data(), ramp.size(), parameters ), chirp::voice_exception );
+				parameters.pitch = 17.0f;
+				REQUIRE_THROWS_AS( engine.play( ramp.data(), ramp.size(), parameters ), chirp::voice_exception );
+				REQUIRE_THROWS_AS( engine.play( ramp.data(), 0 ), chirp::voice_exception );
+			}
+		}
+	}
+	GIVEN( "an engine format that isn't float, or has too many channels" ) {
+		THEN( "the engine can't be created" ) {
+			REQUIRE_THROWS_AS( chirp::voice_engine( { 8000, chirp::sixteen_bits_little_endian_mono }, 4 ), chirp::sample_format_exception );
+			REQUIRE_THROWS_AS( chirp::voice_engine( { 8000, { chirp::sample_type::floating_point, 32, chirp::native_byte_order, 6 } }, 4 ), chirp::sample_format_exception );
+			REQUIRE_THROWS_AS( chirp::voice_engine( { 8000, chirp::float32_mono }, 0 ), chirp::voice_exception );
+		}
+	}
+}
+
+SCENARIO( "voice engines pan voices with constant power" ) {
+	GIVEN( "a stereo voice engine and a constant sound" ) {
+		chirp::voice_engine engine{ { 48000, chirp::float32_stereo }, 8 };
+		std::vector<float> sound( 1000, 0.5f );
+		WHEN( "voices are played left, centered and right" ) {
+			chirp::voice_parameters parameters;
+			parameters.pan = -1.0f;
+			auto voice = engine.play( sound.data(), sound.size(), parameters );
+			auto left = render( engine, 10 );
+			engine.stop( voice );
+			render( engine, 1 );
+			parameters.pan = 0.0f;
+			voice = engine.play( sound.data(), sound.size(), parameters );
+			auto centered = render( engine, 10 );
+			engine.stop( voice );
+			render( engine, 1 );
+			parameters.pan = 1.0f;
+			engine.play( sound.data(), sound.size(), parameters );
+			auto right = render( engine, 10 );
+			THEN( "their power is the same in every position" ) {
+				REQUIRE( left[0] == Approx( 0.5f ) );
+				REQUIRE( left[1] == Approx( 0.0f ).margin( 1e-6f ) );
+				REQUIRE( centered[0] == Approx( 0.5f * std::sqrt( 0.5f ) ) );
+				REQUIRE( centered[1] == Approx( 0.5f * std::sqrt( 0.5f ) ) );
+				REQUIRE( right[1] == Approx( 0.5f ) );
+			}
+		}
+		WHEN( "the pan and gain of a voice are changed while it plays" ) {
+			auto voice = engine.play( sound.data(), sound.size() );
+			render( engine, 10 );
+			engine.set_pan( voice, 1.0f );
+			engine.set_gain( voice, 2.0f );
+			auto samples = render( engine, 10 );
+			THEN( "the voice is louder and on the right" ) {
+				REQUIRE( samples[0] == Approx( 0.0f ).margin( 1e-6f ) );
+				REQUIRE( samples[1] == Approx( 1.0f ) );
+			}
+		}
+	}
+}
+
+SCENARIO( "voice engines take over voices by priority when all voices play" ) {
+	GIVEN( "a mono voice engine with two voices and a long sound" ) {
+		chirp::voice_engine engine{ { 8000, chirp::float32_mono }, 2 };
+		std::vector<float> sound( 8000, 0.25f );
+		chirp::voice_parameters low;
+		chirp::voice_parameters high;
+		high.priority = 1;
+		WHEN( "a third voice of the same priority is played" ) {
+			auto first = engine.play( sound.data(), sound.size(), low );
+			auto second = engine.play( sound.data(), sound.size(), low );
+			auto third = engine.play( sound.data(), sound.size(), low );
+			REQUIRE( engine.is_playing( first ) );
+			REQUIRE( engine.statistics().played == 0 );
+			render( engine, 1 );
+			THEN( "it takes over the oldest voice from the next block on" ) {
+				REQUIRE_FALSE( engine.is_playing( first ) );
+				REQUIRE( engine.is_playing( second ) );
+				REQUIRE( engine.is_playing( third ) );
+				REQUIRE( engine.playing_voices() == 2 );
+				REQUIRE( engine.statistics().stolen == 1 );
+			}
+		}
+		WHEN( "a voice of a higher priority is played" ) {
+			auto important = engine.play( sound.data(), sound.size(), high );
+			auto first = engine.play( sound.data(), sound.size(), low );
+			auto second = engine.play( sound.data(), sound.size(), high );
+			render( engine, 1 );
+			THEN( "it takes over the voice of the lower priority" ) {
+				REQUIRE( engine.is_playing( important ) );
+				REQUIRE_FALSE( engine.is_playing( first ) );
+				REQUIRE( engine.is_playing( second ) );
+			}
+			AND_WHEN( "a voice of a lower priority is played" ) {
+				auto rejected = engine.play( sound.data(), sound.size(), low );
+				render( engine, 1 );
+				THEN( "it is rejected" ) {
+					REQUIRE_FALSE( engine.is_playing( rejected ) );
+					REQUIRE( engine.playing_voices() == 2 );
+					REQUIRE( engine.statistics().rejected == 1 );
+				}
+			}
+		}
+		WHEN( "a voice was stopped" ) {
+			auto stopped = engine.play( sound.data(), sound.size(), high );
+			engine.play( sound.data(), sound.size(), high );
+			engine.stop( stopped );
+			auto voice = engine.play( sound.data(), sound.size(), low );
+			render( engine, 1 );
+			THEN( "its slot is used before any voice is taken over" ) {
+				REQUIRE( engine.is_playing( voice ) );
+				REQUIRE( engine.playing_voices() == 2 );
+				REQUIRE( engine.statistics().stolen == 0 );
+			}
+		}
+	}
+}
+
+SCENARIO( "voice engines play thousands of voices" ) {
+	GIVEN( "a stereo voice engine with 4096 voices" ) {
+		chirp::voice_engine engine{ { 48000, chirp::float32_stereo }, 4096 };
+		std::vector<float> short_sound( 100, 0.0001f );
+		std::vector<float> long_sound( 5000, 0.0001f );
+		WHEN( "thousands of sounds of various pitches are fired" ) {
+			std::vector<chirp::voice_handle> voices;
+			for( int i=0; i<4096; ++i ) {
+				chirp::voice_parameters parameters;
+				parameters.pitch = 0.5f + static_cast<float>( i % 13 ) * 0.125f;
+				parameters.pan = static_cast<float>( i % 3 ) - 1.0f;
+				auto& sound = i % 2 == 0 ? short_sound : long_sound;
+				voices.push_back( engine.play( sound.data(), sound.size(), parameters ) );
+			}
+			auto first = render( engine, 48 );
+			THEN( "all of them play" ) {
+				REQUIRE( engine.playing_voices() == 4096 );
+				auto power = first[0] * first[0] + first[1] * first[1];
+				REQUIRE( power > 0.0f );
+				REQUIRE( first[0] < 1.0f );
+			}
+			AND_WHEN( "the short sounds have ended" ) {
+				render( engine, 1000 );
+				THEN( "their voices are free again" ) {
+					REQUIRE( engine.playing_voices() == 2048 );
+					REQUIRE_FALSE( engine.is_playing( voices[0] ) );
+					REQUIRE( engine.is_playing( voices[1] ) );
+					auto voice = engine.play( short_sound.data(), short_sound.size() );
+					render( engine, 1 );
+					REQUIRE( engine.is_playing( voice ) );
+					REQUIRE( engine.statistics().stolen == 0 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "voice engines take requests from other threads while they play" ) {
+	GIVEN( "a mono voice engine with 32 voices, and a short sound" ) {
+		chirp::voice_engine engine{ { 8000, chirp::float32_mono }, 32 };
+		std::vector<float> sound( 100, 0.001f );
+		WHEN( "more sounds are played than the request ring holds before a block is played" ) {
+			std::vector<chirp::voice_handle> voices;
+			for( int i=0; i<100; ++i ) {
+				voices.push_back( engine.play( sound.data(), sound.size() ) );
+			}
+			THEN( "the sounds that don't fit are rejected" ) {
+				REQUIRE( voices[63] );
+				REQUIRE_FALSE( voices[64] );
+				REQUIRE_FALSE( engine.is_playing( voices[64] ) );
+				REQUIRE( engine.statistics().rejected == 36 );
+			}
+		}
+		WHEN( "a thread plays and stops sounds while another thread plays the engine" ) {
+			std::atomic<bool> done{ false };
+			std::thread player{ [&]() {
+				while( !done ) {
+					render( engine, 64 );
+				}
+			}};
+			for( int i=0; i<1000; ++i ) {
+				chirp::voice_parameters parameters;
+				parameters.pitch = 0.5f + static_cast<float>( i % 4 ) * 0.5f;
+				auto voice = engine.play( sound.data(), sound.size(), parameters );
+				if( i % 3 == 0 ) {
+					engine.stop( voice );
+				}
+			}
+			done = true;
+			player.join();
+			render( engine, 1000 );
+			THEN( "every sound is played or rejected, and all voices end" ) {
+				auto statistics = engine.statistics();
+				REQUIRE( statistics.played + statistics.rejected == 1000 );
+				REQUIRE( engine.playing_voices() == 0 );
+			}
+		}
+	}
+}